@@ -0,0 +1,95 @@
+/******************************************************************************
+
+ frameTimer.cpp
+
+ Times the frames drawn in a window.  OpenGL draws in the background while
+ the program carries on, so a frame is only done once glFinish returns.
+ Waiting for it before the buffers are swapped times the whole frame
+ without also timing the wait for the screen to refresh, but it keeps the
+ program from preparing the next frame while OpenGL draws this one, so it
+ is only done while the times are shown.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+#ifdef __APPLE__
+    #include <OpenGL/gl.h>
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glew.h>
+    #include <GL/glut.h>
+#endif
+
+#include "frameTimer.h"
+
+using namespace std;
+
+/*
+ frameTimer::startFrame
+
+ Notes when a frame starts being drawn.
+
+ Arguments: None.
+
+ Returns:   Nothing.
+*/
+void frameTimer::startFrame()
+{
+    start = chrono::steady_clock::now();
+}
+
+/*
+ frameTimer::endFrame
+
+ If frame times are shown, waits for OpenGL to finish the frame started at
+ start and shows how long it took in the window's title, along with the
+ average of the last few frames.  Call it before swapping buffers.
+
+ Arguments: None.
+
+ Returns:   Nothing.
+*/
+void frameTimer::endFrame()
+{
+    if (!shown)
+        return;
+
+    glFinish();
+    chrono::duration<double, milli> elapsed =
+        chrono::steady_clock::now() - start;
+    times[count % FRAME_TIMER_HISTORY] = elapsed.count();
+    ++count;
+
+    int nTimes = min(count, FRAME_TIMER_HISTORY);
+    double total = 0;
+    for (int i = 0; i < nTimes; ++i)
+        total += times[i];
+
+    ostringstream out;
+    out << fixed << setprecision(2) << title << " - " << elapsed.count()
+        << " ms/frame, " << total / nTimes << " ms average";
+    glutSetWindowTitle(out.str().c_str());
+}
+
+/*
+ frameTimer::toggle
+
+ Turns showing frame times on or off.  The average starts over each time
+ they are turned on, and the window's title is put back when they are
+ turned off.
+
+ Arguments: None.
+
+ Returns:   Nothing.
+*/
+void frameTimer::toggle()
+{
+    shown = !shown;
+    count = 0;
+    if (!shown)
+        glutSetWindowTitle(title);
+}
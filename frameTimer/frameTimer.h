@@ -0,0 +1,46 @@
+/******************************************************************************
+
+ frameTimer.h
+
+ Contains the frameTimer struct from frameTimer.cpp, which times the frames
+ the OpenGL assignments draw in a window and shows the times in the
+ window's title.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef FRAMETIMER
+#define FRAMETIMER
+
+#include <chrono>
+
+#define FRAME_TIMER_HISTORY 32      // Frames the average is taken over
+
+// Structs
+/*
+ frameTimer
+
+ Times frames from startFrame to endFrame, and shows in the window's title
+ how long the last frame took and the average of the last
+ FRAME_TIMER_HISTORY.  Timing is off until toggled on, since it waits for
+ OpenGL to finish every frame.  While it is off, the window's title is
+ title.  times holds the times of the last few frames in milliseconds, and
+ count how many frames have been timed since timing was turned on.
+*/
+typedef struct _frameTimer {
+    const char                              *title;
+    bool                                    shown;
+    int                                     count;
+    double                                  times[FRAME_TIMER_HISTORY];
+    std::chrono::steady_clock::time_point   start;
+
+    _frameTimer(const char *title) : title (title), shown (false),
+        count (0), start () {}
+    ~_frameTimer() {}
+
+    void startFrame ();
+    void endFrame ();
+    void toggle ();
+} frameTimer;
+
+#endif // ifndef FRAMETIMER
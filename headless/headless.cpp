@@ -0,0 +1,391 @@
+/******************************************************************************
+
+ headless.cpp
+
+ Renders an assignment's frames without a window.  An OpenGL context is made
+ with EGL on no surface at all (Mesa's surfaceless platform, which falls
+ back to its software rasterizer when there is no graphics card), and
+ frames are drawn into a framebuffer object instead of a window.  Each
+ frame is read back into one of two pixel buffer objects, so OpenGL copies
+ it out while the next frame is drawn, and written to a PPM file once the
+ next frame has been started.  How long each frame took is printed as it
+ finishes.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <assert.h>
+
+#ifdef __APPLE__
+    #include <OpenGL/gl.h>
+#else
+    #include <GL/glew.h>
+    #define EGL_NO_X11
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
+#include "headless.h"
+
+using namespace std;
+
+#define HEADLESS_PBOS   2       // Frames being read back at once
+
+#ifndef __APPLE__
+// The context and where it draws, made by initHeadless
+static EGLDisplay   eglDisplay = EGL_NO_DISPLAY;
+static EGLContext   eglContext = EGL_NO_CONTEXT;
+static GLuint       framebuffer = 0;
+static GLuint       renderbuffers[2] = { 0, 0 };
+#endif
+static int          width = 0;
+static int          height = 0;
+
+/*
+ parseHeadlessOptions
+
+ Looks for -headless <frames> <prefix> among the command line arguments,
+ and removes it so the rest can be read as if it was never given.
+
+ Arguments: int *argc - The number of arguments, less 3 if -headless was
+                given
+            char **argv - The arguments, without -headless and its values
+                if it was given
+            headlessOptions *opts - Filled with the values given with
+                -headless
+
+ Returns:   (bool) - True if -headless was given, false otherwise
+*/
+bool parseHeadlessOptions
+(
+    int                 *argc,
+    char                **argv,
+    headlessOptions     *opts
+)
+{
+    assert(argc);
+    assert(argv);
+    assert(opts);
+
+    for (int i = 1; i + 2 < *argc; ++i) {
+        if (strcmp(argv[i], "-headless") != 0)
+            continue;
+
+        opts->frames = max(atoi(argv[i + 1]), 1);
+        opts->prefix = argv[i + 2];
+        for (int j = i; j + 3 <= *argc; ++j)
+            argv[j] = argv[j + 3];
+        *argc -= 3;
+        return true;
+    }
+    return false;
+}
+
+/*
+ initHeadless
+
+ Makes an OpenGL context without a window and makes it current, along with
+ a framebuffer object of the argued size for it to draw into.  Everything
+ an assignment would do once it has a window, such as setting up its lights
+ and viewport, should be done after this.
+
+ Arguments: int xres - X resolution of the frames in pixels
+            int yres - Y resolution of the frames in pixels
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int initHeadless
+(
+    int                 xres,
+    int                 yres
+)
+{
+#ifdef __APPLE__
+    cout << "headless rendering needs EGL, which macOS does not have" << endl;
+    return 1;
+#else
+    width = xres;
+    height = yres;
+
+    // Mesa can make contexts with no display server and no graphics card.
+    // Other drivers may make them from their default display instead.
+    const char *clientExts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (clientExts && strstr(clientExts, "EGL_MESA_platform_surfaceless") &&
+        getPlatformDisplay)
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+            EGL_DEFAULT_DISPLAY, NULL);
+    if (eglDisplay == EGL_NO_DISPLAY)
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (eglDisplay == EGL_NO_DISPLAY ||
+        !eglInitialize(eglDisplay, &major, &minor)) {
+        cout << "unable to initialize EGL" << endl;
+        return 1;
+    }
+
+    // The assignments use the fixed-function pipeline, so ask for desktop
+    // OpenGL, whose default context keeps it.  Configs ask for windows by
+    // default, which there are none of, so ask for pbuffers instead.
+    EGLint configAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                               EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                               EGL_NONE };
+    EGLConfig config;
+    EGLint numConfigs;
+    if (!eglBindAPI(EGL_OPENGL_API) ||
+        !eglChooseConfig(eglDisplay, configAttribs, &config, 1,
+                         &numConfigs) || numConfigs == 0) {
+        cout << "no EGL config supports OpenGL" << endl;
+        closeHeadless();
+        return 1;
+    }
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, NULL);
+    if (eglContext == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                        eglContext)) {
+        cout << "unable to make an OpenGL context without a surface" << endl;
+        closeHeadless();
+        return 1;
+    }
+
+    // GLEW looks for a GLX display once it has loaded the context's
+    // functions, and there is none here
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)
+        glewStatus = GLEW_OK;
+#endif
+    if (glewStatus != GLEW_OK || !GLEW_VERSION_2_1 ||
+        !(GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object)) {
+        cout << "headless rendering needs OpenGL 2.1 and framebuffer "
+             << "objects" << endl;
+        closeHeadless();
+        return 1;
+    }
+
+    // Draw into color and depth renderbuffers instead of a window
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(2, renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+        GL_RENDERBUFFER, renderbuffers[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width,
+        height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+        GL_RENDERBUFFER, renderbuffers[1]);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) !=
+        GL_FRAMEBUFFER_COMPLETE) {
+        cout << "unable to make a " << width << "x" << height
+             << " framebuffer" << endl;
+        closeHeadless();
+        return 1;
+    }
+    glViewport(0, 0, width, height);
+
+    cout << "rendering headless with EGL " << major << "." << minor << " on "
+         << glGetString(GL_RENDERER) << endl;
+    return 0;
+#endif
+}
+
+#ifndef __APPLE__
+/*
+ writeFrame
+
+ Writes a frame read back from the framebuffer to a binary PPM file.  The
+ frame's rows are bottom to top, as OpenGL reads them, and its pixels RGBA.
+
+ Arguments: const char *filename - The name of the file to write
+            const unsigned char *pixels - The frame's pixels
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+static int writeFrame
+(
+    const char          *filename,
+    const unsigned char *pixels
+)
+{
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        cout << "unable to open " << filename << endl;
+        return 1;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    unsigned char *row = (unsigned char *) malloc(3 * width);
+    for (int y = height - 1; y >= 0; --y) {
+        const unsigned char *pixel = pixels + 4 * width * y;
+        for (int x = 0; x < width; ++x, pixel += 4) {
+            row[3 * x] = pixel[0];
+            row[3 * x + 1] = pixel[1];
+            row[3 * x + 2] = pixel[2];
+        }
+        fwrite(row, 1, 3 * width, file);
+    }
+    free(row);
+
+    return fclose(file) != 0;
+}
+
+/*
+ finishFrame
+
+ Waits for a frame to be read back into a pixel buffer object, then writes
+ it to its file.
+
+ Arguments: const headlessOptions &opts - Names the frame's file
+            int frame - The frame's number
+            GLuint pbo - The pixel buffer object the frame was read into
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+static int finishFrame
+(
+    const headlessOptions   &opts,
+    int                     frame,
+    GLuint                  pbo
+)
+{
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    const unsigned char *pixels = (const unsigned char *)
+        glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (!pixels) {
+        cout << "unable to read back frame " << frame << endl;
+        return 1;
+    }
+
+    int status = 0;
+    if (strcmp(opts.prefix, "-") != 0) {
+        char filename[1024];
+        snprintf(filename, sizeof(filename), "%s%04d.ppm", opts.prefix,
+            frame);
+        status = writeFrame(filename, pixels);
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return status;
+}
+#endif
+
+/*
+ runHeadless
+
+ Draws the argued number of frames and writes each to its file.  While one
+ frame is being drawn, the last is copied out of the framebuffer by OpenGL,
+ and it is only waited for and written once the next has been started.  The
+ time each frame took, from starting to draw it to starting the next, is
+ printed as it goes, then the average, fastest and slowest.
+
+ Arguments: const headlessOptions &opts - How many frames to draw, and where
+                to write them
+            void (*drawFrame)(int, int) - Draws a frame, given its number
+                and the number of frames, without swapping buffers
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int runHeadless
+(
+    const headlessOptions   &opts,
+    void                    (*drawFrame)(int, int)
+)
+{
+    assert(drawFrame);
+#ifdef __APPLE__
+    return 1;
+#else
+    assert(eglContext != EGL_NO_CONTEXT);
+
+    GLuint pbos[HEADLESS_PBOS];
+    glGenBuffers(HEADLESS_PBOS, pbos);
+    for (int i = 0; i < HEADLESS_PBOS; ++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4 * width * height, NULL,
+            GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    typedef chrono::steady_clock clock;
+    clock::time_point frameStart = clock::now();
+    double total = 0, fastest = 0, slowest = 0;
+    int status = 0;
+    for (int frame = 0; frame < opts.frames && status == 0; ++frame) {
+        // Read into a pixel buffer object, which returns at once
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        drawFrame(frame, opts.frames);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[frame % HEADLESS_PBOS]);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        // The last frame has had the time this one took to draw to be read
+        // back, and nothing is left to wait on after the last frame
+        if (frame > 0)
+            status = finishFrame(opts, frame - 1,
+                pbos[(frame - 1) % HEADLESS_PBOS]);
+        if (frame == opts.frames - 1 && status == 0)
+            status = finishFrame(opts, frame, pbos[frame % HEADLESS_PBOS]);
+
+        clock::time_point now = clock::now();
+        double ms = chrono::duration<double, milli>(now - frameStart).count();
+        frameStart = now;
+
+        total += ms;
+        fastest = (frame == 0) ? ms : min(fastest, ms);
+        slowest = max(slowest, ms);
+        printf("frame %d: %.2f ms\n", frame, ms);
+    }
+    glDeleteBuffers(HEADLESS_PBOS, pbos);
+
+    if (status == 0)
+        printf("%d frames at %dx%d: %.2f ms average, %.2f ms fastest, "
+               "%.2f ms slowest, %.1f frames per second\n", opts.frames,
+               width, height, total / opts.frames, fastest, slowest,
+               1000 * opts.frames / total);
+    return status;
+#endif
+}
+
+/*
+ closeHeadless
+
+ Destroys the context made by initHeadless and everything in it.
+
+ Arguments: None.
+
+ Returns:   Nothing.
+*/
+void closeHeadless()
+{
+#ifndef __APPLE__
+    if (framebuffer != 0) {
+        glDeleteRenderbuffers(2, renderbuffers);
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (eglContext != EGL_NO_CONTEXT) {
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, eglContext);
+        eglContext = EGL_NO_CONTEXT;
+    }
+    if (eglDisplay != EGL_NO_DISPLAY) {
+        eglTerminate(eglDisplay);
+        eglDisplay = EGL_NO_DISPLAY;
+    }
+#endif
+}
@@ -0,0 +1,40 @@
+/******************************************************************************
+
+ headless.h
+
+ Contains the headlessOptions struct and public functions from headless.cpp,
+ which let the OpenGL assignments render without a window, so they can be
+ run and timed on machines without a display or a graphics card.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef HEADLESS
+#define HEADLESS
+
+
+// Structs
+/*
+ headlessOptions
+
+ What to render when running without a window, as given on the command line
+ by -headless <frames> <prefix>.  Each frame is written to prefix followed
+ by the frame number, as in prefix0000.ppm, or not written at all if prefix
+ is "-".
+*/
+typedef struct _headlessOptions {
+    int         frames;
+    const char  *prefix;
+
+    _headlessOptions() : frames (0), prefix (NULL) {}
+    ~_headlessOptions() {}
+} headlessOptions;
+
+
+// Externally public functions
+bool parseHeadlessOptions (int*, char**, headlessOptions*);
+int initHeadless (int, int);
+int runHeadless (const headlessOptions&, void (*)(int, int));
+void closeHeadless ();
+
+#endif // ifndef HEADLESS
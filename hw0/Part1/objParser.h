@@ -8,6 +8,8 @@
 #include <vector>
 #include <assert.h>
 
+#include "meshCache.h"
+
 
 #define FEXT_LEN        4         // Number of characters in OBJ file extension
 
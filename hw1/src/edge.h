@@ -0,0 +1,19 @@
+#ifndef EDGE
+#define EDGE
+
+/*
+ edge
+
+ An edge shared by one or more facets, given by the indices of its two
+ vertices with the smaller first.
+*/
+typedef struct _edge {
+    int v0;
+    int v1;
+
+    _edge() : v0 (0), v1 (0) {}
+    _edge(int v0, int v1) : v0 (v0), v1 (v1) {}
+    ~_edge() {}
+} edge;
+
+#endif // ifndef EDGE
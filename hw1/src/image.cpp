@@ -53,7 +53,8 @@ void NDCToScreen
 /*
  image::drawLine
 
- This uses Bresenham's algorithm to draw a line on an image.
+ Clips a line to the image and draws what is left with Bresenham's
+ algorithm, in integers only.
 
  Arguments: point2D p0 - One endpoint of the line
             point2D p1 - Other endpoint of the line
@@ -68,108 +69,48 @@ void image::drawLine
     uint32_t            color
 )
 {
-    // Always putting point with larger x into point 0 allows us to only worry
-    // about 4 octants
-    float e = 0;
-    float x0 = (p0.x > p1.x ? p1.x : p0.x);
-    float x1 = (p0.x > p1.x ? p0.x : p1.x);
-    float y0 = (p0.x > p1.x ? p1.y : p0.y);
-    float y1 = (p0.x > p1.x ? p0.y : p1.y);
-    float dx = x1 - x0; // Note: always positive
-    float dy = y1 - y0;
-    float m = dy / dx;  // Slope of the line
-
-    // Use this so we don't make the same comparison a bunch of times
-    bool dxGreater = fabs(dx) >= fabs(dy);
-
-    // x takes on the lesser of x0 and x1 iff. slope < -1
-    // y takes on greater of y0 and y1 iff. -1 <= slope <= 0
-    // Note that y1 > y0 iff. the slope is positive, leaving us with same
-    // condition as for x
-    int x = (int) (m < -1 ? x1 : x0);
-    int y = (int) (m < -1 ? y1 : y0);
-
-    // We iterate over the dimension with the longer delta
-    int *i = dxGreater ? &x : &y;
-    float iBnd = dxGreater ? x1 : max(y0, y1);
-
-    // The lagging dimension is that which is not being iterated over, or the
-    // one with the shorter of dx and dy
-    int *lag = dxGreater ? &y : &x;
-
-    // The error accumulated is always in the dimension corresponding to the
-    // shorter of dx and dy, as we "walk" in that direction until we stray
-    // too far.  The compensation is thus in the perpendicular direction.
-    // We must negate one of these whenever they have the same sign so that
-    // one actually compensates for the other.
-    float errGain = dxGreater ? dy : dx;
-    float errComp = (dxGreater ? dx : dy) * (m > 0 ? -1 : 1);
-
-    // We always increment the iteration variable, so we turn to the lag
-    // variable, which increments when the slope is positive and decrements
-    // otherwise.
-    int step = m > 0 ? 1 : -1;
-
-    // 0 <= m <= 1
-    for (; *i < iBnd; ++(*i)) {
-        // Fill in this pixel
-        (*this)[y][x] = color;
-        // Adding dy to our error no matter what
-        e += errGain;
-        // Check if our error is getting too far from the line of interest such
-        // that we need to move in both directions, because the line is closer
-        // to the center of the pixel after moving two directions
-        if (fabs(2 * e) >= fabs(errComp)) {
-            // If so, move to get closer to the line.
-            e += errComp;
-            *lag += step;
-        }
-    }
+    screenLine line;
+    if (clipLine(this->xres, this->yres, p0, p1, &line))
+        drawLineRows(this->colors, line, 0, this->yres, color);
 }
 
 /*
  image::generateWireframe
 
- Takes a shape whose vertices all have a zeroed z coordinate because they are
- already projected onto a screen, and connects the vertices according to the
- instructions contained in the facet vector.
+ Takes a shape whose vertices are already projected onto a screen and draws
+ every edge of its facets once, clipped to the image.  The edges are found
+ from the facets if the shape does not have them already.
 
- Arguments: shape3D shape - The shape to create a wireframe out of
-            image *im - The image that the shape will appear on
+ Arguments: const shape3D &shape - The shape to create a wireframe out of
             uint32_t color - The color of the wires in the wireframe
 
  Returns:   Nothing.
 */
 void image::generateWireframe
 (
-    shape3D             shape,
+    const shape3D       &shape,
     uint32_t            color
 )
 {
-    // Draw a triangle for every facet
-    vector<facet>::iterator f = shape.facets->begin();
-    for (; f != shape.facets->end(); ++f) {
-        // Get all of the vertices to make things quicker and neater
-        vertex v1 = shape.vertices->at(f->v1);
-        vertex v2 = shape.vertices->at(f->v2);
-        vertex v3 = shape.vertices->at(f->v3);
-
-        // Draw each of the three sides of the triangle
-        this->drawLine(point2D(v1.x, v1.y), point2D(v2.x, v2.y), color);
-        this->drawLine(point2D(v2.x, v2.y), point2D(v3.x, v3.y), color);
-        this->drawLine(point2D(v3.x, v3.y), point2D(v1.x, v1.y), color);
+    vector<edge> found;
+    const vector<edge> *edges = shape.edges;
+    if (!edges) {
+        uniqueEdges(*shape.facets, shape.vertices->size(), &found);
+        edges = &found;
     }
+    drawEdges(this->colors, this->xres, this->yres, *shape.vertices, *edges,
+        color, 0);
 }
 
 void image::generateWireframes
 (
-    vector<shape3D>     shapes,
-    uint32_t            color
+    const vector<shape3D>   &shapes,
+    uint32_t                color
 )
 {
     // Iterate through all the facets in the object, and use the indices to
     // connect points from the pts array (which have been transformed)
-    vector<shape3D>::iterator s = shapes.begin();
+    vector<shape3D>::const_iterator s = shapes.begin();
     for (; s != shapes.end(); ++s) {
         this->generateWireframe(*s, color);
     }
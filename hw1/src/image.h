@@ -6,6 +6,7 @@
 
 #include "projection.h"
 #include "geom.h"
+#include "wireframe.h"
 
 // Structs
 
@@ -42,8 +43,8 @@ typedef struct _image {
 
     void outputPPM();
     void drawLine (point2D, point2D, uint32_t);
-    void generateWireframes(std::vector<shape3D>, uint32_t);
-    void generateWireframe(shape3D, uint32_t);
+    void generateWireframes(const std::vector<shape3D>&, uint32_t);
+    void generateWireframe(const shape3D&, uint32_t);
 
 } image;
 
@@ -10,6 +10,7 @@
 
 #include "geom.h"
 #include "shape3d.h"
+#include "meshCache.h"
 
 
 #define FEXT_LEN        4         // Number of characters in OBJ file extension
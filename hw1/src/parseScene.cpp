@@ -68,6 +68,9 @@ void getOriginalShapes
         // Parse the obj file we obtained from this description
         parseObjFile(OBJ_DIR + vals[1], orig);
         orig->name = vals[0];
+        // Every copy of the shape has the same edges, so find them once
+        orig->edges = new vector<edge>;
+        uniqueEdges(*orig->facets, orig->vertices->size(), orig->edges);
         // Save the object
         order->push_back(vals[0]);
         (*originals)[vals[0]] = orig;
@@ -7,6 +7,7 @@
 #include "objParser.h"
 #include "transform.h"
 #include "camera.h"
+#include "wireframe.h"
 
 #define OBJ_DIR "data/"
 
@@ -45,6 +45,7 @@ void shape3D::transformShape
     for (; face != this->facets->end(); ++face) {
         transformed->facets->push_back(*face);
     }
+    transformed->edges = this->edges;
 }
 
 /*
@@ -81,6 +82,7 @@ void shape3D::NDCToScreen
     for (; f != this->facets->end(); ++f) {
         outShape->facets->push_back(*f);
     }
+    outShape->edges = this->edges;
 }
 
 /*
@@ -141,6 +143,7 @@ void shape3D::worldToCartNDC
     for (; f != this->facets->end(); ++f) {
         proj->facets->push_back(*f);
     }
+    proj->edges = this->edges;
 }
 
 void shape3D::print()
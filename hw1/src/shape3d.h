@@ -13,6 +13,7 @@
 #include "geom.h"
 #include "vertex.h"
 #include "facet.h"
+#include "edge.h"
 #include "camera.h"
 
 
@@ -21,16 +22,19 @@
  shape3D
 
  Contains a vector of vertices in 3 dimensions and a vector of facets which
- are described by indices in the vertex vector.
+ are described by indices in the vertex vector.  edges, if not NULL, holds
+ every edge of the facets once, and is shared by every copy of a shape since
+ transforming a shape never changes its edges.
 */
 typedef struct _shape3D {
     std::string         name;
     std::vector<vertex> *vertices;
     std::vector<facet>  *facets;
+    std::vector<edge>   *edges;
 
-    _shape3D() : name (""), vertices (NULL), facets (NULL) {}
+    _shape3D() : name (""), vertices (NULL), facets (NULL), edges (NULL) {}
     _shape3D(std::string name, std::vector<vertex> *v, std::vector<facet> *f) :
-                name (name), vertices (v), facets (f) {}
+                name (name), vertices (v), facets (f), edges (NULL) {}
     ~_shape3D() {}
 
     void clear() {
@@ -47,6 +47,8 @@ void vertex::worldToCartNDC
  vertex::NDCToImage
 
  Projects a vertex in NDC onto the 2D screen from which we are viewing.
+ Vertices off of the screen are projected too, so the lines to them can be
+ clipped at the edge of the screen.
 
  Arguments: int xres - X resolution of the image in pixels
             int yres - Y resolution of the image in pixels
@@ -63,14 +65,9 @@ void vertex::NDCToImage
     vertex              *out
 )
 {
-    // Only want to add this point if it is within (-1, -1, -1) and (1, 1, 1)
-    float x = this->x, y = this->y, z = this->z;
-    if (x > 1 || y > 1 || x < -1 || y < -1)
-        return;
-
-    // Point is in view, scale NDC (-1, 1) to (0, xres) and (0, yres) and add
-    // it to the image
-    int winX = (1 + x) * (xres / 2);
-    int winY = ((1 + y) * (yres / 2));
+    // Scale NDC (-1, 1) to (0, xres) and (0, yres).  The pixel a vertex is
+    // in is found by rounding down once lines to it are clipped.
+    float winX = (1 + this->x) * (xres / 2);
+    float winY = (1 + this->y) * (yres / 2);
     *out = vertex(winX, winY, 0);
 }
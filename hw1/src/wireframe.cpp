@@ -0,0 +1,311 @@
+/******************************************************************************
+
+ wireframe.cpp
+
+ Draws the edges of shapes projected onto a screen.  Every edge shared by
+ several facets is found once, clipped to the image with the Liang-Barsky
+ algorithm and drawn with an integer-only Bresenham's algorithm.  The edges
+ of large shapes are drawn by several threads at once, each of which draws
+ the part of every edge within its own band of rows of the image, so no two
+ threads ever write the same pixel.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+#include <assert.h>
+
+#include "wireframe.h"
+#include "meshEdges.h"
+
+using namespace std;
+
+#define MIN_WIREFRAME_CHUNK (1 << 14)   // Fewest edges worth a thread
+
+/*
+ clipLine
+
+ Clips a line to an image with the Liang-Barsky algorithm, which finds the
+ part of the line within the image by where along it it crosses each edge
+ of the image.  The ends of what is left are then rounded down to pixels.
+
+ Arguments: int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            point2D p0 - One endpoint of the line
+            point2D p1 - Other endpoint of the line
+            screenLine *line - Filled with the clipped line, if any of it is
+                on the image
+
+ Returns:   (bool) - True if any of the line is on the image, false otherwise
+*/
+bool clipLine
+(
+    int                 xres,
+    int                 yres,
+    point2D             p0,
+    point2D             p1,
+    screenLine          *line
+)
+{
+    assert(line);
+
+    // Most lines of most wireframes are on the image already
+    float xmax = xres - 1, ymax = yres - 1;
+    if (p0.x >= 0 && p0.x <= xmax && p0.y >= 0 && p0.y <= ymax &&
+        p1.x >= 0 && p1.x <= xmax && p1.y >= 0 && p1.y <= ymax) {
+        *line = screenLine(p0.x, p0.y, p1.x, p1.y);
+        return true;
+    }
+
+    // Projecting a vertex in the plane of the eye divides by 0
+    if (!isfinite(p0.x) || !isfinite(p0.y) || !isfinite(p1.x) ||
+        !isfinite(p1.y))
+        return false;
+
+    // The line is p0 + t * (p1 - p0) for t in [0, 1].  Each edge of the
+    // image is crossed at t = q / p, going out of the image if p < 0 and
+    // into it otherwise.  Doubles keep the crossings exact enough for ends
+    // far off of the image.
+    double dx = (double) p1.x - p0.x;
+    double dy = (double) p1.y - p0.y;
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { p0.x, xres - 1 - (double) p0.x, p0.y,
+                    yres - 1 - (double) p0.y };
+    double t0 = 0, t1 = 1;
+    for (int k = 0; k < 4; ++k) {
+        if (p[k] == 0) {
+            // Parallel to this edge, and all on the wrong side of it
+            if (q[k] < 0)
+                return false;
+            continue;
+        }
+        double t = q[k] / p[k];
+        if (p[k] < 0)
+            t0 = max(t0, t);
+        else
+            t1 = min(t1, t);
+        if (t0 > t1)
+            return false;
+    }
+
+    // Rounding can leave a clipped end just off of the image
+    line->x0 = min(max((int) floor(p0.x + t0 * dx), 0), xres - 1);
+    line->y0 = min(max((int) floor(p0.y + t0 * dy), 0), yres - 1);
+    line->x1 = min(max((int) floor(p0.x + t1 * dx), 0), xres - 1);
+    line->y1 = min(max((int) floor(p0.y + t1 * dy), 0), yres - 1);
+    return true;
+}
+
+/*
+ uniqueEdges
+
+ Finds every edge of a set of facets once, however many facets share it.
+
+ Arguments: const vector<facet> &facets - The facets to find the edges of
+            int nVertices - The number of vertices the facets index
+            vector<edge> *edges - Filled with the edges, ordered by their
+                smaller vertex
+
+ Returns:   Nothing.
+*/
+void uniqueEdges
+(
+    const vector<facet> &facets,
+    int                 nVertices,
+    vector<edge>        *edges
+)
+{
+    assert(edges);
+    edges->clear();
+
+    findUniqueEdges(facets.size(), nVertices,
+        [&facets](size_t t, int j) {
+            const facet &f = facets[t];
+            return (unsigned int) (j == 0 ? f.v1 : j == 1 ? f.v2 : f.v3);
+        },
+        [edges](unsigned int a, unsigned int b) {
+            edges->push_back(edge(a, b));
+        });
+}
+
+/*
+ drawLineRows
+
+ Draws the part of a line within a band of rows of an image with Bresenham's
+ algorithm.  Stepping along the longer of the line's x and y extents, the
+ other coordinate at step i is the nearest pixel to the line, or
+ floor((2 * i * shorter + longer) / (2 * longer)).  The first step in the
+ band is found from that directly, and the division is then carried forward
+ a step at a time in integers, so every band draws exactly the pixels that
+ drawing the whole line would.
+
+ Arguments: uint32_t **colors - The rows of the image
+            const screenLine &line - The line, which must be on the image
+            int rowBegin - The first row of the band
+            int rowEnd - One past the last row of the band
+            uint32_t color - The RGBA color to draw the line in
+
+ Returns:   Nothing.
+*/
+void drawLineRows
+(
+    uint32_t            **colors,
+    const screenLine    &line,
+    int                 rowBegin,
+    int                 rowEnd,
+    uint32_t            color
+)
+{
+    assert(colors);
+
+    int dx = abs(line.x1 - line.x0);
+    int dy = abs(line.y1 - line.y0);
+    int sx = line.x1 >= line.x0 ? 1 : -1;
+    int sy = line.y1 >= line.y0 ? 1 : -1;
+
+    // The steps in y from y0 that land in the band
+    int kFirst, kLast;
+    if (sy > 0) {
+        kFirst = rowBegin - line.y0;
+        kLast = rowEnd - 1 - line.y0;
+    } else {
+        kFirst = line.y0 - (rowEnd - 1);
+        kLast = line.y0 - rowBegin;
+    }
+    kFirst = max(kFirst, 0);
+    kLast = min(kLast, dy);
+    if (kFirst > kLast)
+        return;
+
+    if (dx == 0 && dy == 0) {
+        colors[line.y0][line.x0] = color;
+    } else if (dx >= dy) {
+        // Step along x.  The first step in the band is the first whose y
+        // step, as above, is at least kFirst.
+        int i = 0;
+        if (kFirst > 0)
+            i = (int) ((2LL * kFirst * dx - dx + 2 * dy - 1) / (2LL * dy));
+        long long num = 2LL * i * dy + dx;
+        int k = num / (2 * dx);
+        int rem = num % (2 * dx);
+        for (; i <= dx && k <= kLast; ++i) {
+            colors[line.y0 + sy * k][line.x0 + sx * i] = color;
+            rem += 2 * dy;
+            if (rem >= 2 * dx) {
+                rem -= 2 * dx;
+                k++;
+            }
+        }
+    } else {
+        // Step along y, which the band bounds directly
+        long long num = 2LL * kFirst * dx + dy;
+        int j = num / (2 * dy);
+        int rem = num % (2 * dy);
+        for (int k = kFirst; k <= kLast; ++k) {
+            colors[line.y0 + sy * k][line.x0 + sx * j] = color;
+            rem += 2 * dx;
+            if (rem >= 2 * dy) {
+                rem -= 2 * dy;
+                j++;
+            }
+        }
+    }
+}
+
+/*
+ drawBand
+
+ Draws the parts of a shape's edges within a band of rows of an image.
+ Edges whose ends are both above or both below the band are passed over
+ before they are clipped.
+
+ Arguments: uint32_t **colors - The rows of the image
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            const vector<vertex> *vertices - The shape's vertices, in pixels
+            const vector<edge> *edges - The shape's edges
+            int rowBegin - The first row of the band
+            int rowEnd - One past the last row of the band
+            uint32_t color - The RGBA color to draw the edges in
+
+ Returns:   Nothing.
+*/
+static void drawBand
+(
+    uint32_t                **colors,
+    int                     xres,
+    int                     yres,
+    const vector<vertex>    *vertices,
+    const vector<edge>      *edges,
+    int                     rowBegin,
+    int                     rowEnd,
+    uint32_t                color
+)
+{
+    vector<edge>::const_iterator e = edges->begin();
+    for (; e != edges->end(); ++e) {
+        const vertex &v0 = (*vertices)[e->v0];
+        const vertex &v1 = (*vertices)[e->v1];
+        if (max(v0.y, v1.y) < rowBegin || min(v0.y, v1.y) >= rowEnd)
+            continue;
+
+        screenLine line;
+        if (clipLine(xres, yres, point2D(v0.x, v0.y), point2D(v1.x, v1.y),
+                     &line))
+            drawLineRows(colors, line, rowBegin, rowEnd, color);
+    }
+}
+
+/*
+ drawEdges
+
+ Draws the edges of a shape projected onto an image, splitting the image
+ into one band of rows per thread.
+
+ Arguments: uint32_t **colors - The rows of the image
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            const vector<vertex> &vertices - The shape's vertices, in pixels
+            const vector<edge> &edges - The shape's edges, as found by
+                uniqueEdges
+            uint32_t color - The RGBA color to draw the edges in
+            int nThreads - Number of threads to draw with, or 0 to use one
+                per core.  Shapes with few edges are drawn with fewer.
+
+ Returns:   Nothing.
+*/
+void drawEdges
+(
+    uint32_t                **colors,
+    int                     xres,
+    int                     yres,
+    const vector<vertex>    &vertices,
+    const vector<edge>      &edges,
+    uint32_t                color,
+    int                     nThreads
+)
+{
+    assert(colors);
+
+    if (nThreads <= 0)
+        nThreads = max((int) thread::hardware_concurrency(), 1);
+    nThreads = min(nThreads, (int) (edges.size() / MIN_WIREFRAME_CHUNK));
+    nThreads = max(min(nThreads, yres), 1);
+
+    // The calling thread takes the first band itself
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; ++t) {
+        int rowBegin = (long) yres * t / nThreads;
+        int rowEnd = (long) yres * (t + 1) / nThreads;
+        workers.push_back(thread(drawBand, colors, xres, yres, &vertices,
+            &edges, rowBegin, rowEnd, color));
+    }
+    drawBand(colors, xres, yres, &vertices, &edges, 0, yres / nThreads,
+        color);
+    vector<thread>::iterator w = workers.begin();
+    for (; w != workers.end(); ++w)
+        w->join();
+}
@@ -0,0 +1,38 @@
+#ifndef WIREFRAME
+#define WIREFRAME
+
+#include <stdint.h>
+#include <vector>
+
+#include "geom.h"
+#include "vertex.h"
+#include "facet.h"
+#include "edge.h"
+
+// Structs
+
+/*
+ screenLine
+
+ A line between two pixels of an image, both of which are on the image.
+*/
+typedef struct _screenLine {
+    int         x0;
+    int         y0;
+    int         x1;
+    int         y1;
+
+    _screenLine() : x0 (0), y0 (0), x1 (0), y1 (0) {}
+    _screenLine(int x0, int y0, int x1, int y1)
+        : x0 (x0), y0 (y0), x1 (x1), y1 (y1) {}
+    ~_screenLine() {}
+} screenLine;
+
+// Externally public functions
+bool clipLine (int, int, point2D, point2D, screenLine*);
+void uniqueEdges (const std::vector<facet>&, int, std::vector<edge>*);
+void drawLineRows (uint32_t**, const screenLine&, int, int, uint32_t);
+void drawEdges (uint32_t**, int, int, const std::vector<vertex>&,
+    const std::vector<edge>&, uint32_t, int);
+
+#endif // ifndef WIREFRAME
@@ -0,0 +1,342 @@
+/******************************************************************************
+
+ batch.cpp
+
+ Contains the batch renderer, which renders many frames of one scene in a
+ single process.  The scene's meshes are parsed once and shared, read only,
+ by every frame.  Each worker thread keeps its own framebuffer and vertex
+ cache for as long as it runs, and renders whole frames one after another,
+ so nothing is reparsed or reallocated between frames.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#include "batch.h"
+
+using namespace std;
+using namespace Eigen;
+
+/*
+ batchJob
+
+ Everything the workers of one batch share.  Frames are claimed by
+ incrementing next, and status is nonzero if any frame failed to write.
+*/
+typedef struct _batchJob {
+    instanceList        *instances;
+    camera              cam;
+    vector<light>       lights;
+    shading             alg;
+    vector<frameSpec>   *frames;
+    int                 xres;
+    int                 yres;
+    int                 intensity;
+    uint32_t            background;
+    simdLevel           simd;
+    ppmFormat           format;
+    const char          *prefix;
+    atomic<int>         next;
+    atomic<int>         status;
+} batchJob;
+
+/*
+ addObjectTransform
+
+ Combines the transformations listed for one object in a frame and adds the
+ result to the frame.
+
+ Arguments: int object - Index of the object the transformations are for
+            matrixList *factors - The transformations, in the order they
+                were listed
+            frameSpec *frame - The frame to add the transformation to
+
+ Returns:   Nothing.
+*/
+static void addObjectTransform
+(
+    int                 object,
+    matrixList          *factors,
+    frameSpec           *frame
+)
+{
+    if (object < 0)
+        return;
+
+    Matrix4f m = Matrix4f::Identity();
+    transformMatrix(&m, factors);
+    frame->objects.push_back(object);
+    frame->transforms.push_back(m);
+    factors->clear();
+}
+
+/*
+ parseFrames
+
+ Reads a list of frames from a file.  Each frame starts with a line reading
+ "frame" and ends with an empty line or the end of the file, and looks like:
+    frame
+    position <float x> <float y> <float z>
+    orientation <float x> <float y> <float z> <float angle>
+    light <xyz point> , <rgb color> , <attenuation>
+    ... // Some number of light sources
+    object <int index>
+    <transformation 1>
+    ... // Some number of transformations
+    <transformation M>
+    ... // Repeat for some number of objects
+ where every line but "frame" is optional, and transformations are given
+ the same way as in a scene file.
+
+ Arguments: char *filename - The name of the file to parse
+            vector<frameSpec> *frames - Filled with the frames in the file
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int parseFrames
+(
+    char                *filename,
+    vector<frameSpec>   *frames
+)
+{
+    assert(filename);
+    assert(frames);
+
+    ifstream inFile(filename);
+    if (!inFile.is_open()) {
+        cout << "unable to open " << filename << endl;
+        return 1;
+    }
+
+    // The object whose transformations are being read, and them so far
+    int object = -1;
+    matrixList factors;
+
+    string line;
+    while (getline(inFile, line)) {
+        vector<string> vals = getSpaceDelimitedWords(line);
+
+        // A blank line ends the frame
+        if (vals.size() == 0) {
+            if (!frames->empty())
+                addObjectTransform(object, &factors, &frames->back());
+            object = -1;
+            continue;
+        }
+
+        if (vals[0] == "frame") {
+            frames->push_back(frameSpec());
+            continue;
+        }
+        if (frames->empty()) {
+            cout << "unable to parse " << filename << endl;
+            return 1;
+        }
+        frameSpec *frame = &frames->back();
+
+        if (vals[0] == "position") {
+            frame->hasPosition = true;
+            frame->position = point3D(stof(vals[1]), stof(vals[2]),
+                stof(vals[3]));
+        } else if (vals[0] == "orientation") {
+            frame->hasOrientation = true;
+            frame->orient = orientation(stof(vals[1]), stof(vals[2]),
+                stof(vals[3]), stof(vals[4]));
+        } else if (vals[0] == "light") {
+            point3D source(stof(vals[1]), stof(vals[2]), stof(vals[3]));
+            rgb color(stof(vals[5]), stof(vals[6]), stof(vals[7]));
+            frame->lights.push_back(light(source, color, stof(vals[9])));
+        } else if (vals[0] == "object") {
+            addObjectTransform(object, &factors, frame);
+            object = stoi(vals[1]);
+        } else {
+            Matrix4f m;
+            if (object < 0 || generateTransform(line, &m) < 0) {
+                cout << "unable to parse " << filename << endl;
+                return 1;
+            }
+            factors.push_back(m);
+        }
+    }
+    if (!frames->empty())
+        addObjectTransform(object, &factors, &frames->back());
+
+    return 0;
+}
+
+/*
+ renderFrames
+
+ Repeatedly claims the next unrendered frame of a batch, renders it and
+ writes it to a numbered file.  The framebuffer and vertex cache are created
+ once and reused for every frame this worker renders.  Each instance is
+ rastered as soon as its vertices are cached, so one cache serves every
+ instance in turn, as in image::rasterInstances.
+
+ Arguments: batchJob *job - The batch being rendered
+
+ Returns:   Nothing.
+*/
+static void renderFrames
+(
+    batchJob            *job
+)
+{
+    instanceList *instances = job->instances;
+    int nFrames = job->frames->size();
+
+    image im(job->xres, job->yres, job->intensity, job->background);
+    im.simd = job->simd;
+    vertexCache cache;
+
+    int f;
+    while ((f = job->next++) < nFrames) {
+        frameSpec *frame = &(*job->frames)[f];
+
+        // Apply the frame's changes to the scene
+        camera cam = job->cam;
+        if (frame->hasPosition)
+            cam.pos = frame->position;
+        if (frame->hasOrientation)
+            cam.orient = frame->orient;
+        vector<light> lights = frame->lights.empty() ?
+            job->lights : frame->lights;
+
+        im.clear(job->background);
+        for (unsigned int i = 0; i < instances->size(); ++i) {
+            instance *inst = &(*instances)[i];
+            Matrix4f toWorld = inst->ptTransform;
+            for (unsigned int k = 0; k < frame->objects.size(); ++k) {
+                if (frame->objects[k] == (int) i)
+                    toWorld = frame->transforms[k] * toWorld;
+            }
+            if (!im.inView(inst, toWorld, cam))
+                continue;
+
+            cache.build(inst, toWorld, cam, lights, job->alg == Gouraud,
+                job->xres, job->yres, 1, job->simd);
+            im.rasterCached(inst, &cache, job->alg);
+        }
+
+        // Frames are already rendered concurrently, so each is lit by the
+        // worker rendering it
+        if (job->alg == DeferredPhong)
+            im.shadeDeferred(1);
+
+        // Frames are numbered from 0 in the order they were listed
+        char filename[1024];
+        snprintf(filename, sizeof(filename), "%s%04d.ppm", job->prefix, f);
+        ppmWriter out;
+        if (out.open(filename, job->format, job->xres, job->yres,
+                job->intensity)) {
+            job->status = 1;
+            continue;
+        }
+        im.outputPPM(&out);
+        if (out.close())
+            job->status = 1;
+    }
+}
+
+/*
+ renderBatch
+
+ Renders every frame in a list, each a variation on one scene, and writes
+ each to its own file named by the prefix followed by the frame number.
+ Frames are rendered concurrently by worker threads, each holding its own
+ framebuffer and vertex cache.  There are no more workers than there are
+ frames, and no more than fit in BATCH_MEMORY.
+
+ Arguments: instanceList *instances - The instances in the scene
+            camera cam - The camera the scene is viewed from
+            vector<light> lights - Lights in the scene
+            shading alg - The shading algorithm to use
+            vector<frameSpec> *frames - How each frame differs from the scene
+            int xres - X resolution of each frame in pixels
+            int yres - Y resolution of each frame in pixels
+            int intensity - Max intensity of any one pixel color
+            uint32_t background - The color behind every object
+            simdLevel simd - The widest vector instruction set to use
+            int nThreads - Number of worker threads, or 0 to use one per core
+            ppmFormat format - Whether to write P3 or P6
+            const char *prefix - Start of the name of every output file
+
+ Returns:   (int) - 0 if every frame was written, nonzero otherwise
+*/
+int renderBatch
+(
+    instanceList        *instances,
+    camera              cam,
+    vector<light>       lights,
+    shading             alg,
+    vector<frameSpec>   *frames,
+    int                 xres,
+    int                 yres,
+    int                 intensity,
+    uint32_t            background,
+    simdLevel           simd,
+    int                 nThreads,
+    ppmFormat           format,
+    const char          *prefix
+)
+{
+    assert(instances);
+    assert(frames);
+    assert(prefix);
+
+    batchJob job;
+    job.instances = instances;
+    job.cam = cam;
+    job.lights = lights;
+    job.alg = alg;
+    job.frames = frames;
+    job.xres = xres;
+    job.yres = yres;
+    job.intensity = intensity;
+    job.background = background;
+    job.simd = simd;
+    job.format = format;
+    job.prefix = prefix;
+    job.next = 0;
+    job.status = 0;
+
+    // Estimate what each worker keeps resident.  Its framebuffer holds a
+    // color and a depth per pixel, and under deferred shading a G-buffer
+    // position, normal and material.  Its cache grows to fit the largest
+    // mesh, at 9 floats per vertex, 3 per normal and, for Gouraud shading,
+    // a color and a vertex and normal pairing per facet corner.
+    long perPixel = 2 * sizeof(uint32_t);
+    if (alg == DeferredPhong)
+        perPixel += 6 * sizeof(float) + sizeof(int);
+    long perCache = 0;
+    instanceList::iterator i = instances->begin();
+    for (; i != instances->end(); ++i) {
+        const shape3D *s = i->mesh;
+        long size = s->vertices.size() * 9 * sizeof(float) +
+            s->normals.size() * 3 * sizeof(float);
+        if (alg == Gouraud)
+            size += s->facets.size() * 3 * (sizeof(rgb) + 3 * sizeof(int));
+        perCache = max(perCache, size);
+    }
+    long perWorker = perPixel * xres * yres + perCache;
+
+    if (nThreads <= 0)
+        nThreads = max((int) thread::hardware_concurrency(), 1);
+    nThreads = min(nThreads, (int) frames->size());
+    nThreads = min((long) nThreads, max(BATCH_MEMORY / perWorker, 1L));
+
+    // The calling thread is one of the workers
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; ++t)
+        workers.push_back(thread(renderFrames, &job));
+    renderFrames(&job);
+    vector<thread>::iterator w = workers.begin();
+    for (; w != workers.end(); ++w)
+        w->join();
+
+    return job.status;
+}
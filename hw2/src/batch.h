@@ -0,0 +1,54 @@
+/******************************************************************************
+
+ batch.h
+
+ Contains the frameSpec struct and declares public functions in batch.cpp.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef BATCH
+#define BATCH
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "image.h"
+#include "transform.h"
+
+// Most memory, in bytes, that the framebuffers and vertex caches of all of
+// the frames being rendered at once may take up
+#define BATCH_MEMORY    (1L << 30)
+
+// Structs
+/*
+ frameSpec
+
+ Describes how one frame of a batch differs from the scene it is rendered
+ from.  The camera position and orientation are replaced if given, and the
+ lights are replaced if any are listed.  Every object listed in objects,
+ numbered in the order the scene transforms them from 0, has the matrix at
+ the same index of transforms applied after its own transformation.
+*/
+typedef struct _frameSpec {
+    bool                hasPosition;
+    point3D             position;
+    bool                hasOrientation;
+    orientation         orient;
+    std::vector<light>  lights;
+    std::vector<int>    objects;
+    matrixList          transforms;
+
+    _frameSpec() : hasPosition (false), position (), hasOrientation (false),
+        orient (), lights (), objects (), transforms () {}
+    ~_frameSpec() {}
+} frameSpec;
+
+// Externally public functions
+int parseFrames (char*, std::vector<frameSpec>*);
+int renderBatch (instanceList*, camera, std::vector<light>, shading,
+    std::vector<frameSpec>*, int, int, int, uint32_t, simdLevel, int,
+    ppmFormat, const char*);
+
+#endif // ifndef BATCH
@@ -0,0 +1,263 @@
+/******************************************************************************
+
+ bench.cpp
+
+ Contains a micro-benchmark that transforms and rasters the same scene with
+ the scalar and each of the vector transforms and rasterizers and compares
+ their speeds and outputs.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <chrono>
+#include <cstring>
+
+#include "bench.h"
+
+using namespace std;
+
+/*
+ sameImage
+
+ Compares the color and depth buffers of two images of the same resolution.
+
+ Arguments: image *a - The first image
+            image *b - The second image
+
+ Returns:   (bool) - True if every pixel and depth is identical
+*/
+static bool sameImage
+(
+    image       *a,
+    image       *b
+)
+{
+    pixelView colorsA = a->colorView(0, 0, a->xres, a->yres);
+    pixelView colorsB = b->colorView(0, 0, b->xres, b->yres);
+    pixelView depthsA = a->depthView(0, 0, a->xres, a->yres);
+    pixelView depthsB = b->depthView(0, 0, b->xres, b->yres);
+    size_t rowSize = a->xres * sizeof(uint32_t);
+    for (int r = 0; r < a->yres; ++r) {
+        if (memcmp(colorsA.row(r), colorsB.row(r), rowSize) ||
+            memcmp(depthsA.row(r), depthsB.row(r), rowSize))
+            return false;
+    }
+    return true;
+}
+
+/*
+ sameCache
+
+ Compares the transformed vertices of two caches of the same instance.
+
+ Arguments: vertexCache *a - The first cache
+            vertexCache *b - The second cache
+
+ Returns:   (bool) - True if every transformed coordinate is identical
+*/
+static bool sameCache
+(
+    vertexCache *a,
+    vertexCache *b
+)
+{
+    size_t size = a->world.x.size() * sizeof(float);
+    return !memcmp(&a->world.x[0], &b->world.x[0], size) &&
+        !memcmp(&a->world.y[0], &b->world.y[0], size) &&
+        !memcmp(&a->world.z[0], &b->world.z[0], size) &&
+        !memcmp(&a->ndc.x[0], &b->ndc.x[0], size) &&
+        !memcmp(&a->ndc.y[0], &b->ndc.y[0], size) &&
+        !memcmp(&a->ndc.z[0], &b->ndc.z[0], size) &&
+        !memcmp(&a->clipW[0], &b->clipW[0], size) &&
+        !memcmp(&a->screenX[0], &b->screenX[0], size) &&
+        !memcmp(&a->screenY[0], &b->screenY[0], size);
+}
+
+/*
+ benchTransform
+
+ Transforms the vertices of the argued instances to world space, NDC and
+ screen space several times with every vertex transform supported by the
+ CPU, from scalar up, on a single thread.  The average time per frame of each
+ is printed to standard output along with the rate at which it streams
+ vertex data and whether its output matched the scalar output.
+
+ Arguments: instanceList *instances - The instances to transform
+            camera &cam - The camera the scene is viewed from
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            int frames - Number of times to transform the scene per level
+
+ Returns:   (int) - 0 if every transform matched the scalar output, nonzero
+                otherwise
+*/
+static int benchTransform
+(
+    instanceList        *instances,
+    camera              &cam,
+    int                 xres,
+    int                 yres,
+    int                 frames
+)
+{
+    const char *names[] = { "scalar", "sse2", "avx2" };
+    simdLevel best = detectSIMD();
+    int status = 0;
+
+    // Each vertex reads 3 floats and writes 3 world, 1 clip, 3 NDC and 2
+    // screen
+    long nVertices = 0;
+    instanceList::iterator inst = instances->begin();
+    for (; inst != instances->end(); ++inst)
+        nVertices += inst->mesh->soa.numVertices();
+    double bytes = nVertices * 12.0 * sizeof(float);
+    cout << nVertices << " vertices" << endl;
+
+    Eigen::Matrix4f worldToClip;
+    cam.worldToClipMatrix(&worldToClip);
+
+    vertexCacheList reference(instances->size());
+    for (int level = SIMDNone; level <= best; ++level) {
+        vertexCacheList caches(instances->size());
+        for (unsigned int i = 0; i < instances->size(); ++i) {
+            int n = (*instances)[i].mesh->soa.numVertices();
+            caches[i].world.resize(n, 0);
+            caches[i].ndc.resize(n, 0);
+            caches[i].clipW.resize(n);
+            caches[i].screenX.resize(n);
+            caches[i].screenY.resize(n);
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            for (unsigned int i = 0; i < instances->size(); ++i) {
+                instance *in = &(*instances)[i];
+                const meshSoA *soa = &in->mesh->soa;
+                Eigen::Matrix4f toClip = worldToClip * in->ptTransform;
+                transformMeshSoA((simdLevel) level, in->ptTransform, toClip,
+                    xres, yres, soa, 0, soa->numVertices(), &caches[i]);
+            }
+        }
+        chrono::duration<double, milli> elapsed =
+            chrono::steady_clock::now() - start;
+        double ms = elapsed.count() / frames;
+
+        // Every transform's output is compared to the scalar output
+        if (level == SIMDNone)
+            reference = caches;
+        bool same = true;
+        for (unsigned int i = 0; i < instances->size(); ++i)
+            same = same && sameCache(&reference[i], &caches[i]);
+        status |= !same;
+
+        cout << names[level] << " transform: " << ms << " ms/frame, "
+             << bytes / ms / 1e6 << " GB/s"
+             << (same ? "" : " (output differs from scalar)") << endl;
+    }
+
+    return status;
+}
+
+/*
+ benchRaster
+
+ Benchmarks the vertex transform with benchTransform.  Then, sets up every
+ facet of the argued instances once and rasters them several times with
+ every rasterizer supported by the CPU, from scalar up.  Only the rastering,
+ and the lighting pass under deferred Phong shading, is timed, so the front
+ end does not hide the difference between the rasterizers.  The average
+ time per frame of each is printed to standard output along with whether its
+ output matched the scalar output.
+
+ Arguments: instanceList *instances - The instances to raster
+            camera cam - The camera the scene is viewed from
+            vector<light> lights - Lights in the system
+            shading alg - The shading algorithm to use
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            int intensity - Max intensity of any one pixel color
+            int frames - Number of times to raster the scene per rasterizer
+
+ Returns:   (int) - 0 if every transform and rasterizer matched the scalar
+                output, nonzero otherwise
+*/
+int benchRaster
+(
+    instanceList        *instances,
+    camera              cam,
+    vector<light>       lights,
+    shading             alg,
+    int                 xres,
+    int                 yres,
+    int                 intensity,
+    int                 frames
+)
+{
+    assert(instances);
+
+    const char *names[] = { "scalar", "sse2", "avx2" };
+    simdLevel best = detectSIMD();
+    int status = benchTransform(instances, cam, xres, yres, frames);
+
+    // Set up the facets only once
+    image reference(xres, yres, intensity, 0);
+    image im(xres, yres, intensity, 0);
+    vector<rasterFacet> facets;
+    rasterFacet rf[MAX_CLIP_FACETS];
+    vertexCacheList caches(instances->size());
+    for (unsigned int i = 0; i < instances->size(); ++i) {
+        instance *in = &(*instances)[i];
+        if (!im.inView(in, in->ptTransform, cam))
+            continue;
+        caches[i].build(in, in->ptTransform, cam, lights, alg == Gouraud,
+            xres, yres, 1, best);
+        if (alg == DeferredPhong)
+            im.addMaterial(&caches[i]);
+        for (unsigned int f = 0; f < in->mesh->facets.size(); ++f) {
+            int n = reference.setupTriangle(f, in, &caches[i], alg, rf);
+            facets.insert(facets.end(), rf, rf + n);
+        }
+    }
+    cout << facets.size() << " facets at " << xres << "x" << yres << endl;
+
+    for (int level = SIMDNone; level <= best; ++level) {
+        double total = 0;
+        im.simd = (simdLevel) level;
+        for (int f = 0; f < frames; ++f) {
+            // Clearing forgets the materials, which get the same IDs back
+            // when those that were added are added again in the same order
+            im.clear(0);
+            for (unsigned int i = 0; i < caches.size(); ++i) {
+                if (caches[i].materialID >= 0)
+                    im.addMaterial(&caches[i]);
+            }
+
+            // Only time the rastering and lighting, not clearing the image
+            chrono::steady_clock::time_point start =
+                chrono::steady_clock::now();
+            vector<rasterFacet>::iterator r = facets.begin();
+            for (; r != facets.end(); ++r) {
+                im.rasterRegion(&(*r), 0, 0, xres, yres, intensity, alg);
+            }
+            if (alg == DeferredPhong)
+                im.shadeDeferred(1);
+            chrono::duration<double, milli> elapsed =
+                chrono::steady_clock::now() - start;
+            total += elapsed.count();
+        }
+
+        // Every rasterizer's output is compared to the scalar output
+        if (level == SIMDNone) {
+            size_t size = (size_t) im.pitch * yres * sizeof(uint32_t);
+            memcpy(reference.colorBuffer, im.colorBuffer, size);
+            memcpy(reference.depthBuffer, im.depthBuffer, size);
+        }
+        bool same = sameImage(&reference, &im);
+        status |= !same;
+
+        cout << names[level] << ": " << total / frames << " ms/frame"
+             << (same ? "" : " (output differs from scalar)") << endl;
+    }
+
+    return status;
+}
@@ -0,0 +1,20 @@
+/******************************************************************************
+
+ bench.h
+
+ Contains public function declarations from bench.cpp.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef BENCH
+#define BENCH
+
+#include <vector>
+
+#include "image.h"
+
+// Externally public functions
+int benchRaster (instanceList*, camera, std::vector<light>, shading, int, int, int, int);
+
+#endif // ifndef BENCH
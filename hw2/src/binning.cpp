@@ -0,0 +1,290 @@
+/******************************************************************************
+
+ binning.cpp
+
+ Contains a tile-binned, multithreaded rasterizer.  Facets are set up once,
+ sorted into bins by which screen tiles they overlap, and then a pool of
+ workers rasters whole tiles independently.  No two workers ever write to the
+ same pixel, so there is no locking on the color or depth buffers.  Tiles
+ are claimed a row of tiles at a time from the top of the image down, so
+ that finished rows can be written out while the rest are still rastering.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+
+#include "image.h"
+
+using namespace std;
+
+/*
+ facetBins
+
+ The output of one setup worker.  It holds the facets that the worker set up,
+ in the order they were submitted, and for every tile on the screen a list of
+ indices into that facet vector for the facets that overlap the tile.
+*/
+typedef struct _facetBins {
+    vector<rasterFacet>         facets;
+    vector<vector<uint32_t> >   tiles;
+} facetBins;
+
+/*
+ facetRef
+
+ Locates a single facet in a list of instances, along with the processed
+ vertices of its instance.
+*/
+typedef struct _facetRef {
+    const instance  *inst;
+    vertexCache     *cache;
+    int             facet;
+
+    _facetRef() : inst (NULL), cache (NULL), facet (0) {}
+    _facetRef(const instance *i, vertexCache *c, int f)
+        : inst (i), cache (c), facet (f) {}
+    ~_facetRef() {}
+} facetRef;
+
+/*
+ bandProgress
+
+ Counts, for every row of tiles (a band) from the top of the image down, how
+ many of its tiles have not been rastered yet.  Workers signal done when
+ they finish the last tile of a band.
+*/
+typedef struct _bandProgress {
+    mutex               lock;
+    condition_variable  done;
+    vector<int>         tilesLeft;
+} bandProgress;
+
+/*
+ binFacets
+
+ Sets up a contiguous range of facets and drops each facet that survives
+ culling and clipping into the bin of every tile its bounding box touches.
+
+ Arguments: image *im - The image the facets will be rastered onto
+            vector<facetRef> *refs - Every facet in the scene, in order
+            int first - Index in refs of the first facet to set up
+            int last - One past the index in refs of the last facet
+            shading alg - The shading algorithm to use
+            int xTiles - Number of tile columns on the image
+            facetBins *bins - Filled with the set up facets and tile lists
+
+ Returns:   Nothing.
+*/
+static void binFacets
+(
+    image               *im,
+    vector<facetRef>    *refs,
+    int                 first,
+    int                 last,
+    shading             alg,
+    int                 xTiles,
+    facetBins           *bins
+)
+{
+    rasterFacet rf[MAX_CLIP_FACETS];
+    for (int i = first; i < last; ++i) {
+        facetRef ref = (*refs)[i];
+        int n = im->setupTriangle(ref.facet, ref.inst, ref.cache, alg, rf);
+        for (int j = 0; j < n; ++j) {
+            rasterFacet *r = &rf[j];
+            uint32_t idx = bins->facets.size();
+            bins->facets.push_back(*r);
+
+            // Add the facet to every tile its bounding box overlaps
+            int tx0 = r->xMin / TILE_SIZE, tx1 = (r->xMax - 1) / TILE_SIZE;
+            int ty0 = r->yMin / TILE_SIZE, ty1 = (r->yMax - 1) / TILE_SIZE;
+            for (int ty = ty0; ty <= ty1; ++ty)
+                for (int tx = tx0; tx <= tx1; ++tx)
+                    bins->tiles[ty * xTiles + tx].push_back(idx);
+        }
+    }
+}
+
+/*
+ rasterTiles
+
+ Repeatedly claims the next unrastered tile and rasters every facet binned to
+ it, clipped to the tile.  Bins are visited in the order the setup workers
+ were assigned facets, so each pixel sees facets in the same order as it
+ would in the serial rasterizer.  Tiles are claimed one band at a time
+ starting with the top band, and the band's count is updated when each tile
+ is done.  Under deferred Phong shading, every facet in a tile has been drawn
+ once the tile is rastered, so the tile is lit right away.
+
+ Arguments: image *im - The image to raster onto
+            vector<facetBins> *bins - Output of every setup worker
+            atomic<int> *next - The next tile to be claimed
+            int xTiles - Number of tile columns on the image
+            int yTiles - Number of tile rows on the image
+            shading alg - The shading algorithm to use
+            bandProgress *bands - Counts unrastered tiles in each band
+
+ Returns:   Nothing.
+*/
+static void rasterTiles
+(
+    image               *im,
+    vector<facetBins>   *bins,
+    atomic<int>         *next,
+    int                 xTiles,
+    int                 yTiles,
+    shading             alg,
+    bandProgress        *bands
+)
+{
+    int tile;
+    while ((tile = (*next)++) < xTiles * yTiles) {
+        // Rows are numbered from the bottom, and bands from the top
+        int band = tile / xTiles;
+        int tx = tile % xTiles, ty = yTiles - 1 - band;
+        int x0 = tx * TILE_SIZE;
+        int y0 = ty * TILE_SIZE;
+        int x1 = min(x0 + TILE_SIZE, im->xres);
+        int y1 = min(y0 + TILE_SIZE, im->yres);
+
+        vector<facetBins>::iterator b = bins->begin();
+        for (; b != bins->end(); ++b) {
+            vector<uint32_t> *tileBin = &b->tiles[ty * xTiles + tx];
+            vector<uint32_t>::iterator i = tileBin->begin();
+            for (; i != tileBin->end(); ++i) {
+                im->rasterRegion(&b->facets[*i], x0, y0, x1, y1,
+                    im->intensity, alg);
+            }
+        }
+        if (alg == DeferredPhong)
+            im->shadeDeferredRect(x0, y0, x1, y1);
+
+        lock_guard<mutex> guard(bands->lock);
+        if (--bands->tilesLeft[band] == 0)
+            bands->done.notify_all();
+    }
+}
+
+/*
+ image::rasterInstancesBinned
+
+ Rasters a list of instances the same way rasterInstances does, but splits
+ the work across threads.  First, instances out of view are culled, and the
+ vertices of each other instance are divided evenly among the threads, which
+ transform and light them.  Next, the facets are divided evenly among the
+ threads, which cull and bin them.  Then the threads raster the screen one
+ tile at a time.  The output is identical to that of rasterInstances.  If a
+ writer is argued, each band of rows is written to it as soon as all of its
+ tiles are done, while later bands are still rastering.
+
+ Arguments: instanceList *instances - The list of instances to raster
+            camera cam - Information about the view of the instances
+            vector<light> lights - List of light sources in the system
+            shading alg - The shading algorithm to use
+            int nThreads - Number of worker threads, or 0 to use one per core
+            ppmWriter *stream - The writer to stream finished rows to, which
+                has been opened for an image of this size, or NULL
+
+ Returns:   Nothing.
+*/
+void image::rasterInstancesBinned
+(
+    instanceList        *instances,
+    camera              cam,
+    vector<light>       lights,
+    shading             alg,
+    int                 nThreads,
+    ppmWriter           *stream
+)
+{
+    assert(instances);
+
+    if (nThreads <= 0)
+        nThreads = max((int) thread::hardware_concurrency(), 1);
+
+    // Process the vertices of every instance.  Every instance of a mesh
+    // after the first starts from the first's cache, so the mesh's vertex
+    // and normal pairings are only found once.
+    vertexCacheList caches(instances->size());
+    map<const shape3D*, int> firstCache;
+    vector<bool> visible(instances->size());
+    for (unsigned int i = 0; i < instances->size(); ++i) {
+        instance *inst = &(*instances)[i];
+        visible[i] = this->inView(inst, inst->ptTransform, cam);
+        if (!visible[i])
+            continue;
+
+        map<const shape3D*, int>::iterator first =
+            firstCache.find(inst->mesh);
+        if (first == firstCache.end()) {
+            firstCache[inst->mesh] = i;
+        } else if (alg == Gouraud) {
+            caches[i].mesh = inst->mesh;
+            caches[i].pairs = caches[first->second].pairs;
+            caches[i].corners = caches[first->second].corners;
+        }
+        caches[i].build(inst, inst->ptTransform, cam, lights,
+            alg == Gouraud, this->xres, this->yres, nThreads, this->simd);
+        if (alg == DeferredPhong)
+            this->addMaterial(&caches[i]);
+    }
+
+    // Flatten the facets of every visible instance so they can be split
+    // evenly
+    vector<facetRef> refs;
+    for (unsigned int i = 0; i < instances->size(); ++i) {
+        if (!visible[i])
+            continue;
+        instance *inst = &(*instances)[i];
+        for (unsigned int f = 0; f < inst->mesh->facets.size(); ++f)
+            refs.push_back(facetRef(inst, &caches[i], f));
+    }
+
+    int xTiles = (this->xres + TILE_SIZE - 1) / TILE_SIZE;
+    int yTiles = (this->yres + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Setup pass, each thread bins a contiguous range of facets
+    vector<facetBins> bins(nThreads);
+    vector<thread> workers;
+    int nFacets = refs.size();
+    for (int t = 0; t < nThreads; ++t) {
+        bins[t].tiles.resize(xTiles * yTiles);
+        int first = (long) nFacets * t / nThreads;
+        int last = (long) nFacets * (t + 1) / nThreads;
+        workers.push_back(thread(binFacets, this, &refs, first, last, alg,
+            xTiles, &bins[t]));
+    }
+    for (int t = 0; t < nThreads; ++t)
+        workers[t].join();
+    workers.clear();
+
+    // Raster pass, each thread claims tiles until there are none left
+    atomic<int> next(0);
+    bandProgress bands;
+    bands.tilesLeft.assign(yTiles, xTiles);
+    for (int t = 0; t < nThreads; ++t) {
+        workers.push_back(thread(rasterTiles, this, &bins, &next, xTiles,
+            yTiles, alg, &bands));
+    }
+
+    // Write out each band, from the top down, as soon as it is done
+    for (int band = 0; stream && band < yTiles; ++band) {
+        unique_lock<mutex> guard(bands.lock);
+        while (bands.tilesLeft[band] > 0)
+            bands.done.wait(guard);
+        guard.unlock();
+
+        int y0 = (yTiles - 1 - band) * TILE_SIZE;
+        int y1 = min(y0 + TILE_SIZE, this->yres);
+        for (int y = y1 - 1; y >= y0; --y)
+            stream->writeRow(this->colors[y]);
+    }
+
+    for (int t = 0; t < nThreads; ++t)
+        workers[t].join();
+}
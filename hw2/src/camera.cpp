@@ -2,7 +2,8 @@
 
  camera.cpp
 
- Contains methods for creating matrices based on the camera
+ Contains methods for creating matrices based on the camera and for testing
+ what the camera can see
 
  Author: Tim Menninger
 
@@ -18,38 +19,26 @@ using namespace std;
  Creates a transformation matrix for projecting points in world space onto
  camera space.
 
- Arguments: MatrixXd *transform - The output matrix that will contain the
+ Arguments: Matrix4f *transform - The output matrix that will contain the
                 transformation matrix.
 
  Returns:   Nothing.
 */
 void camera::worldToCameraMatrix
 (
-    MatrixXd            *transform
+    Matrix4f            *transform
 )
 {
     assert(transform);
 
     // Make translation matrix for all objects using camera position as vector
-    ostringstream os;
-    os << "t "
-       << this->pos.x << " "
-       << this->pos.y << " "
-       << this->pos.z;
-    string vec = os.str();
-    MatrixXd Tc(4, 4);
-    generateTransform(vec, &Tc);
+    Matrix4f Tc;
+    translationMatrix(this->pos.x, this->pos.y, this->pos.z, &Tc);
 
     // Make rotation matrix for all objects using camera orientation
-    os.clear();
-    os << "r "
-       << this->orient.vec.x << " "
-       << this->orient.vec.y << " "
-       << this->orient.vec.z << " "
-       << this->orient.theta;
-    vec = os.str();
-    MatrixXd Rc(4, 4);
-    generateTransform(vec, &Rc);
+    Matrix4f Rc;
+    rotationMatrix(this->orient.vec.x, this->orient.vec.y,
+        this->orient.vec.z, this->orient.theta, &Rc);
 
     // World to camera matrix is simply the product of the translation matrix
     // and the rotation matrix
@@ -71,14 +60,14 @@ void camera::worldToCameraMatrix
  where n, f, r, l, t, and b are the near, far, right, left, top and bottom
  attributes of the camera struct, respectively.
 
- Arguments: MatrixXd *transform - The matrix that will be populated by this
+ Arguments: Matrix4f *transform - The matrix that will be populated by this
                 function.
 
  Returns:   Nothing.
 */
 void camera::perspectiveProjectionMatrix
 (
-    MatrixXd            *transform
+    Matrix4f            *transform
 )
 {
     assert(transform);
@@ -96,3 +85,76 @@ void camera::perspectiveProjectionMatrix
                           0,         0, -(f+n)/(f-n), -2*f*n/(f-n),
                           0,         0,           -1,            0;
 }
+
+/*
+ camera::worldToClipMatrix
+
+ Creates the product of the perspective projection matrix and the world to
+ camera matrix, which takes points in world space to homogeneous NDC.
+
+ Arguments: Matrix4f *transform - The matrix that will be populated by this
+                function.
+
+ Returns:   Nothing.
+*/
+void camera::worldToClipMatrix
+(
+    Matrix4f            *transform
+)
+{
+    assert(transform);
+
+    Matrix4f toCam, perspective;
+    this->worldToCameraMatrix(&toCam);
+    this->perspectiveProjectionMatrix(&perspective);
+    *transform = perspective * toCam;
+}
+
+/*
+ camera::canSee
+
+ Decides whether any part of a sphere could be inside of the camera's view
+ frustum.  The frustum's planes are taken from the rows of the world to clip
+ matrix, and the sphere can only be seen if its center is no further than
+ its radius outside of each of them.  The sides of the frustum are moved out
+ by a margin, in NDC, so that objects just off the edge of the image that
+ could still touch its outermost pixels are kept.
+
+ Arguments: const boundingSphere &b - The sphere to test, in world space
+            float xMargin - How far past -1 and 1 NDC x is still seen
+            float yMargin - How far past -1 and 1 NDC y is still seen
+
+ Returns:   (bool) - False if the sphere is certainly out of view
+*/
+bool camera::canSee
+(
+    const boundingSphere    &b,
+    float                   xMargin,
+    float                   yMargin
+)
+{
+    Matrix4f toClip;
+    this->worldToClipMatrix(&toClip);
+
+    // Each plane is a*x + b*y + c*z + d >= 0 inside of the frustum.  The
+    // clip space point (x, y, z, w) is inside of a side when, for example,
+    // x >= -(1 + xMargin) * w.
+    Vector4f x = toClip.row(0), y = toClip.row(1), z = toClip.row(2);
+    Vector4f w = toClip.row(3);
+    Vector4f planes[6] = {
+        w * (1 + xMargin) + x, w * (1 + xMargin) - x,
+        w * (1 + yMargin) + y, w * (1 + yMargin) - y,
+        w + z, w - z
+    };
+
+    // Leave some slack for rounding error
+    float radius = b.radius * 1.001f;
+    for (int i = 0; i < 6; ++i) {
+        float norm = planes[i].head<3>().norm();
+        float dist = planes[i](0) * b.center.x + planes[i](1) * b.center.y +
+            planes[i](2) * b.center.z + planes[i](3);
+        if (dist < -radius * norm)
+            return false;
+    }
+    return true;
+}
@@ -71,8 +71,10 @@ typedef struct _camera {
         {}
     ~_camera() {}
 
-    void worldToCameraMatrix (Eigen::MatrixXd*);
-    void perspectiveProjectionMatrix (Eigen::MatrixXd*);
+    void worldToCameraMatrix (Eigen::Matrix4f*);
+    void perspectiveProjectionMatrix (Eigen::Matrix4f*);
+    void worldToClipMatrix (Eigen::Matrix4f*);
+    bool canSee (const boundingSphere&, float, float);
 } camera;
 
 #endif // ifndef CAMERA
@@ -0,0 +1,138 @@
+/******************************************************************************
+
+ deferred.cpp
+
+ Contains the lighting pass of deferred Phong shading.  Rastering under
+ deferred shading only records, for every pixel, the position, normal and
+ material of the frontmost fragment in the image's G-buffer.  Each pixel
+ that ends up covered is then lit exactly once here, instead of once for
+ every fragment that was drawn over it.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <thread>
+#include <atomic>
+
+#include "image.h"
+
+using namespace std;
+
+/*
+ image::addMaterial
+
+ Gives the material a vertex cache was built for an ID in the G-buffer,
+ allocating the G-buffer the first time.  The lights prepared in the cache
+ are copied, so the cache may be rebuilt before the pixels are lit.
+
+ Arguments: vertexCache *cache - The cache to give a material ID to
+
+ Returns:   Nothing.
+*/
+void image::addMaterial
+(
+    vertexCache         *cache
+)
+{
+    assert(cache);
+
+    if (this->gbuffer.empty())
+        this->gbuffer.resize(this->pitch, this->yres);
+
+    cache->materialID = this->gbuffer.materials.size();
+    this->gbuffer.materials.push_back(cache->lighting);
+}
+
+/*
+ image::shadeDeferredRect
+
+ Lights every pixel inside of a rectangle that has a fragment in the
+ G-buffer, the same way shadePixel lights a Phong fragment.  Pixels with no
+ fragment keep their color.
+
+ Arguments: int x0 - Leftmost column of the rectangle
+            int y0 - Bottommost row of the rectangle
+            int x1 - One past the rightmost column of the rectangle
+            int y1 - One past the topmost row of the rectangle
+
+ Returns:   Nothing.
+*/
+void image::shadeDeferredRect
+(
+    int                 x0,
+    int                 y0,
+    int                 x1,
+    int                 y1
+)
+{
+    const gBuffer *g = &this->gbuffer;
+    if (g->empty())
+        return;
+
+    for (int y = y0; y < y1; ++y) {
+        uint32_t *colorRow = this->colors[y];
+        for (int x = x0; x < x1; ++x) {
+            size_t i = g->at(x, y);
+            int id = g->material[i];
+            if (id < 0)
+                continue;
+
+            point3D nPt(g->nx[i], g->ny[i], g->nz[i]);
+            nPt.normalize();
+            vertex v(g->x[i], g->y[i], g->z[i]);
+            v.computeLight(normal(nPt.x, nPt.y, nPt.z), g->materials[id]);
+            colorRow[x] = v.c.toUInt32(this->intensity);
+        }
+    }
+}
+
+/*
+ shadeRows
+
+ Repeatedly claims the next unlit row of an image and lights it.
+
+ Arguments: image *im - The image to light
+            atomic<int> *next - The next row to be claimed
+
+ Returns:   Nothing.
+*/
+static void shadeRows
+(
+    image               *im,
+    atomic<int>         *next
+)
+{
+    int y;
+    while ((y = (*next)++) < im->yres)
+        im->shadeDeferredRect(0, y, im->xres, y + 1);
+}
+
+/*
+ image::shadeDeferred
+
+ Lights every pixel of the image that has a fragment in the G-buffer.  Rows
+ are handed out one at a time to the argued number of threads, so rows with
+ few covered pixels do not leave threads idle.
+
+ Arguments: int nThreads - Number of threads, or 0 to use one per core
+
+ Returns:   Nothing.
+*/
+void image::shadeDeferred
+(
+    int                 nThreads
+)
+{
+    if (nThreads <= 0)
+        nThreads = max((int) thread::hardware_concurrency(), 1);
+
+    // The calling thread is one of the workers
+    atomic<int> next(0);
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; ++t)
+        workers.push_back(thread(shadeRows, this, &next));
+    shadeRows(this, &next);
+    vector<thread>::iterator w = workers.begin();
+    for (; w != workers.end(); ++w)
+        w->join();
+}
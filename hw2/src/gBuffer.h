@@ -0,0 +1,67 @@
+/******************************************************************************
+
+ gBuffer.h
+
+ Contains gBuffer struct
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef GBUFFER
+#define GBUFFER
+
+#include <vector>
+#include <algorithm>
+
+#include "light.h"
+
+// Structs
+/*
+ gBuffer
+
+ The geometry buffer used by deferred shading.  For every pixel of an image,
+ it holds the interpolated world space position and normal of the frontmost
+ fragment drawn there and the ID of that fragment's material, each as its
+ own array laid out the same way as the image's color buffer.  A material ID
+ is an index into materials, which holds the lights prepared for each
+ material, and is -1 where nothing has been drawn.  The normals are not
+ normalized until the pixel is lit.
+*/
+typedef struct _gBuffer {
+    int                             pitch;
+    std::vector<float>              x;
+    std::vector<float>              y;
+    std::vector<float>              z;
+    std::vector<float>              nx;
+    std::vector<float>              ny;
+    std::vector<float>              nz;
+    std::vector<int>                material;
+    std::vector<lightingContext>    materials;
+
+    _gBuffer() : pitch (0), x (), y (), z (), nx (), ny (), nz (),
+        material (), materials () {}
+    ~_gBuffer() {}
+
+    void resize(int p, int yres) {
+        size_t size = (size_t) p * yres;
+        pitch = p;
+        x.resize(size);
+        y.resize(size);
+        z.resize(size);
+        nx.resize(size);
+        ny.resize(size);
+        nz.resize(size);
+        material.assign(size, -1);
+    }
+    bool empty() const { return material.empty(); }
+
+    // Forget every fragment and material, keeping the arrays
+    void clear() {
+        std::fill(material.begin(), material.end(), -1);
+        materials.clear();
+    }
+
+    size_t at(int px, int py) const { return (size_t) py * pitch + px; }
+} gBuffer;
+
+#endif // ifndef GBUFFER
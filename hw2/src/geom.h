@@ -60,4 +60,18 @@ typedef struct _point3D {
 
 } point3D;
 
+/*
+ boundingSphere
+
+ A sphere that contains every point of some object.
+*/
+typedef struct _boundingSphere {
+    point3D     center;
+    float       radius;
+
+    _boundingSphere() : center (point3D()), radius (0) {}
+    _boundingSphere(point3D c, float r) : center (c), radius (r) {}
+    ~_boundingSphere() {}
+} boundingSphere;
+
 #endif // ifndef GEOM
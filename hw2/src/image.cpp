@@ -44,6 +44,58 @@ bool facingCamera
     return (v3mv2.x * v1mv2.y - v3mv2.y * v1mv2.x) > 0;
 }
 
+/*
+ makeEdge
+
+ Creates the edge function for the directed edge from a to b.  The function
+ is zero on the line through a and b, and is positive on the left of it when
+ looking from a to b.  The bias implements the fill rule: for two facets that
+ share an edge, the edge functions are negatives of one another, so exactly
+ one of them has the edge marked as a top or left edge and draws it.
+
+ Arguments: vertex a - The tail of the edge, in screen coordinates
+            vertex b - The head of the edge, in screen coordinates
+
+ Returns:   (edgeFunction) - The edge function
+*/
+static edgeFunction makeEdge
+(
+    vertex          a,
+    vertex          b
+)
+{
+    edgeFunction e;
+    int64_t ax = (int64_t) a.x, ay = (int64_t) a.y;
+    int64_t bx = (int64_t) b.x, by = (int64_t) b.y;
+
+    e.a = ay - by;
+    e.b = bx - ax;
+    e.c = ax * by - ay * bx;
+    e.bias = (e.a > 0 || (e.a == 0 && e.b > 0)) ? 0 : 1;
+    return e;
+}
+
+/*
+ negateEdge
+
+ Flips which side of an edge function is considered the interior, updating
+ the fill rule bias to match.
+
+ Arguments: edgeFunction *e - The edge function to flip
+
+ Returns:   Nothing.
+*/
+static void negateEdge
+(
+    edgeFunction    *e
+)
+{
+    e->a = -e->a;
+    e->b = -e->b;
+    e->c = -e->c;
+    e->bias = (e->a > 0 || (e->a == 0 && e->b > 0)) ? 0 : 1;
+}
+
 /*
  NDCToScreen
 
@@ -52,9 +104,9 @@ bool facingCamera
 
  Arguments: int xres - X resolution of the image in pixels
             int yres - Y resolution of the image in pixels
-            vector<shape3D> *NDCShapes - Vector of shapes whose vertices are
+            shapeList *NDCShapes - Vector of shapes whose vertices are
                 in NDC
-            vector<shape3D> *screenShapes - Where to store the screen
+            shapeList *screenShapes - Where to store the screen
                 projected shapes
 
  Returns:   Nothing.
@@ -63,14 +115,14 @@ void NDCToScreen
 (
     int                 xres,
     int                 yres,
-    vector<shape3D>     *NDCShapes,
-    vector<shape3D>     *screenShapes
+    shapeList           *NDCShapes,
+    shapeList           *screenShapes
 )
 {
     screenShapes->clear();
 
     // Project every shape onto the screen in 2D
-    vector<shape3D>::iterator shape = NDCShapes->begin();
+    shapeList::iterator shape = NDCShapes->begin();
     for (; shape != NDCShapes->end(); ++shape) {
         shape3D scrShape;
         shape->NDCToScreen(xres, yres, &scrShape);
@@ -197,29 +249,61 @@ void image::generateWireframe
  already projected onto a screen, and connects the vertices according to the
  instructions contained in the facet vectors.
 
- Arguments: vector<shape3D> *shape - The shapes to create wireframes out of
+ Arguments: shapeList *shape - The shapes to create wireframes out of
             uint32_t color - The color of the wires in the wireframe
 
  Returns:   Nothing.
 */
 void image::generateWireframes
 (
-    vector<shape3D>     *shapes,
+    shapeList           *shapes,
     uint32_t            color
 )
 {
     // Iterate through all the facets in the object, and use the indices to
     // connect points from the pts array (which have been transformed)
-    vector<shape3D>::iterator s = shapes->begin();
+    shapeList::iterator s = shapes->begin();
     for (; s != shapes->end(); ++s) {
         this->generateWireframe(&(*s), color);
     }
 }
 
+/*
+ image::clear
+
+ Fills every pixel with a color and every depth with the far plane, and
+ resets the hierarchical depth buffer and any G-buffer, so the image can be
+ rastered again without reallocating it.
+
+ Arguments: uint32_t rgba - The color to fill the image with
+
+ Returns:   Nothing.
+*/
+void image::clear
+(
+    uint32_t            rgba
+)
+{
+    // Padding at the ends of rows is filled too, so each buffer is filled
+    // in one pass
+    size_t size = (size_t) this->pitch * this->yres;
+    fillPixels(this->simd, this->colorBuffer, size, rgba);
+    fillPixels(this->simd, this->depthBuffer, size, -1);
+
+    for (int t = 0; t < this->hizCols * this->hizRows; ++t) {
+        this->hizMin[t] = -1;
+        this->hizMax[t] = -1;
+        this->hizDirty[t] = 0;
+    }
+
+    if (!this->gbuffer.empty())
+        this->gbuffer.clear();
+}
+
 /*
  image::outputPPM
 
- Outputs the argued image according to PPM specifications.
+ Outputs the argued image to standard output in P3 PPM format.
 
  Arguments: None.
 
@@ -229,23 +313,724 @@ void image::outputPPM
 (
 )
 {
-    // Required PPM header
-    cout << "P3" << endl;
-    // x and y resolutions of the image
-    cout << this->xres << " " << this->yres << endl;
-    // Maximum intensity of the image
-    cout << this->intensity << endl;
-
-    // Print all of the pixel RGB values
-    for (int y = this->yres-1; y >= 0; --y) {
-        for (int x = 0; x < this->xres; ++x) {
-            uint32_t color = (*this)[y][x];
-            for (int i = 3; i > 0; --i) {
-                uint32_t rgb = color & (255 << (i * 8));
-                rgb >>= (i * 8);
-                cout << rgb << (i == 1 ? "" : " ");
+    ppmWriter out;
+    out.open(NULL, PPMAscii, this->xres, this->yres, this->intensity);
+    this->outputPPM(&out);
+}
+
+/*
+ image::outputPPM
+
+ Writes every row of the image, from the top down, with a writer that has
+ already been opened for an image of this size.
+
+ Arguments: ppmWriter *out - The writer to write the image with
+
+ Returns:   Nothing.
+ */
+void image::outputPPM
+(
+    ppmWriter           *out
+)
+{
+    assert(out);
+
+    for (int y = this->yres-1; y >= 0; --y)
+        out->writeRow(this->colors[y]);
+}
+
+/*
+ clipVertex
+
+ One corner of a facet being clipped against the near plane.  The position
+ is in clip space, before division by w, and the rest are the attributes
+ that are interpolated across the facet: the world space position and normal
+ under Phong shading, or the color under Gouraud shading.  src is the index
+ of the mesh vertex the corner is, or -1 if it was made by clipping.
+*/
+typedef struct _clipVertex {
+    int         src;
+    float       x;
+    float       y;
+    float       z;
+    float       w;
+    point3D     p;
+    normal      n;
+    rgb         c;
+} clipVertex;
+
+/*
+ lerpClip
+
+ Finds the point a fraction of the way from one clip vertex to another,
+ interpolating every attribute along with the position.  Clip space is an
+ affine function of world space, so this is exact for world positions.
+
+ Arguments: const clipVertex &a - The vertex at t = 0
+            const clipVertex &b - The vertex at t = 1
+            float t - How far from a to b the point is
+
+ Returns:   (clipVertex) - The interpolated vertex
+*/
+static clipVertex lerpClip
+(
+    const clipVertex    &a,
+    const clipVertex    &b,
+    float               t
+)
+{
+    clipVertex out;
+    out.src = -1;
+    out.x = a.x + t * (b.x - a.x);
+    out.y = a.y + t * (b.y - a.y);
+    out.z = a.z + t * (b.z - a.z);
+    out.w = a.w + t * (b.w - a.w);
+    out.p = point3D(a.p.x + t * (b.p.x - a.p.x),
+        a.p.y + t * (b.p.y - a.p.y), a.p.z + t * (b.p.z - a.p.z));
+    out.n = normal(a.n.x + t * (b.n.x - a.n.x),
+        a.n.y + t * (b.n.y - a.n.y), a.n.z + t * (b.n.z - a.n.z));
+    out.c = rgb(a.c.r + t * (b.c.r - a.c.r), a.c.g + t * (b.c.g - a.c.g),
+        a.c.b + t * (b.c.b - a.c.b));
+    return out;
+}
+
+/*
+ cullNDC
+
+ Decides from its NDC vertices whether a facet can be seen, and if so finds
+ the least depth of any pixel on it.  Facets facing away from the camera and
+ facets entirely in front of the near plane or behind the far plane are
+ culled.
+
+ Arguments: rasterFacet *rf - The facet, whose NDC vertices are set
+
+ Returns:   (bool) - True if the facet may be seen, false if culled
+*/
+static bool cullNDC
+(
+    rasterFacet         *rf
+)
+{
+    // If the vertex is not facing the camera, we do not want to see it.
+    if (!facingCamera(rf->v1NDC, rf->v2NDC, rf->v3NDC))
+        return false;
+
+    // Nor do we want to see it if it is entirely in front of the near plane
+    // or behind the far plane
+    float zMin = min(rf->v1NDC.z, min(rf->v2NDC.z, rf->v3NDC.z));
+    float zMax = max(rf->v1NDC.z, max(rf->v2NDC.z, rf->v3NDC.z));
+    if (zMin > 1 || zMax < -1)
+        return false;
+
+    // Depths are interpolated from the vertices, so no pixel can be nearer
+    // than the nearest vertex.  Leave some slack for rounding error.
+    rf->depthMin = (uint32_t) ((max(zMin, -1.0f) * 0.5f + 0.5f) * DEPTH_MAX);
+    rf->depthMin = rf->depthMin > 2 ? rf->depthMin - 2 : 0;
+    return true;
+}
+
+/*
+ setupEdges
+
+ Finds the screen bounding box and the edge functions of a facet whose
+ screen vertices are set.
+
+ Arguments: rasterFacet *rf - The facet to set up
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+
+ Returns:   (bool) - False if the facet covers no part of the image
+*/
+static bool setupEdges
+(
+    rasterFacet         *rf,
+    int                 xres,
+    int                 yres
+)
+{
+    // Define our iteration bounds based on the bounds of the facet.  The
+    // vertices land on whole pixels, which may be drawn, so the maximum is
+    // made exclusive by adding one.
+    vertex *v1 = &rf->v1, *v2 = &rf->v2, *v3 = &rf->v3;
+    rf->xMin = max((int) min(v1->x, min(v2->x, v3->x)), 0);
+    rf->yMin = max((int) min(v1->y, min(v2->y, v3->y)), 0);
+    rf->xMax = min((int) max(v1->x, max(v2->x, v3->x)) + 1, xres);
+    rf->yMax = min((int) max(v1->y, max(v2->y, v3->y)) + 1, yres);
+
+    // Nothing to draw if the facet is entirely off of the image
+    if (rf->xMin >= rf->xMax || rf->yMin >= rf->yMax)
+        return false;
+
+    // Edge functions opposite each vertex.  Going around the facet in order
+    // means all three have the same sign at the vertex they are opposite.
+    rf->e1 = makeEdge(*v2, *v3);
+    rf->e2 = makeEdge(*v3, *v1);
+    rf->e3 = makeEdge(*v1, *v2);
+    int64_t area = rf->e1.at(v1->x, v1->y);
+
+    // Facets that collapse to a line on the screen cover no pixels
+    if (area == 0)
+        return false;
+
+    // Make every edge function positive on the interior of the facet
+    if (area < 0) {
+        negateEdge(&rf->e1);
+        negateEdge(&rf->e2);
+        negateEdge(&rf->e3);
+        area = -area;
+    }
+    rf->invArea = 1.0f / area;
+
+    // The vector rasterizer can only handle facets near the image
+    rf->simdSafe = true;
+    for (int i = 0; i < 3; ++i) {
+        vertex *v = i == 0 ? v1 : (i == 1 ? v2 : v3);
+        if (fabs(v->x) > SIMD_GUARD || fabs(v->y) > SIMD_GUARD)
+            rf->simdSafe = false;
+    }
+
+    return true;
+}
+
+/*
+ image::setupTriangle
+
+ This takes one facet of an instance whose vertices have already been
+ processed and prepares it for rastering.  The facet's transformed vertices
+ and, under Gouraud shading, their colors are gathered from the instance's
+ vertex cache.  If the facet is not facing the camera or does not cover any
+ part of the image, it is culled and nothing is prepared.  If any of its
+ vertices is nearer than the near plane, or behind the camera, it is handed
+ to clipTriangle instead, which may prepare two facets.
+
+ Arguments: int idx - Index of the facet to prepare in the mesh's facets
+            const instance *inst - Its mesh contains the facet, and it has
+                the material
+            vertexCache *cache - The instance's transformed and lit vertices
+            shading alg - Defines which algorithm to use when shading
+            rasterFacet *out - Room for MAX_CLIP_FACETS facets, filled with
+                the prepared facets
+
+ Returns:   (int) - The number of facets prepared, 0 if the facet is culled
+*/
+int image::setupTriangle
+(
+    int                 idx,
+    const instance      *inst,
+    vertexCache         *cache,
+    shading             alg,
+    rasterFacet         *out
+)
+{
+    assert(inst);
+    assert(cache);
+    assert(out);
+
+    const facet *f = &inst->mesh->facets[idx];
+
+    // A vertex is on the visible side of the near plane iff. it has a
+    // positive w and an NDC z of at least -1
+    int vs[3] = { f->v1, f->v2, f->v3 };
+    for (int i = 0; i < 3; ++i) {
+        if (!(cache->clipW[vs[i]] > 0 && cache->ndc.z[vs[i]] >= -1))
+            return this->clipTriangle(idx, inst, cache, alg, out);
+    }
+
+    // Vertices in Cartesian NDC
+    out->v1NDC = cache->ndc.vertexAt(f->v1);
+    out->v2NDC = cache->ndc.vertexAt(f->v2);
+    out->v3NDC = cache->ndc.vertexAt(f->v3);
+    if (!cullNDC(out))
+        return 0;
+
+    out->inst = inst;
+    out->lighting = &cache->lighting;
+    out->materialID = cache->materialID;
+
+    if (alg == Gouraud) {
+        // Colors were computed for each corner of the facet
+        out->v1NDC.c = cache->colors[cache->corners[3*idx]];
+        out->v2NDC.c = cache->colors[cache->corners[3*idx + 1]];
+        out->v3NDC.c = cache->colors[cache->corners[3*idx + 2]];
+    } else {
+        // World space positions and normals for computing light
+        out->p1 = cache->world.pointAt(f->v1);
+        out->p2 = cache->world.pointAt(f->v2);
+        out->p3 = cache->world.pointAt(f->v3);
+        out->n1 = cache->world.normalAt(f->n1);
+        out->n2 = cache->world.normalAt(f->n2);
+        out->n3 = cache->world.normalAt(f->n3);
+    }
+
+    // Vertices in screen coordinates
+    out->v1 = cache->screenAt(f->v1);
+    out->v2 = cache->screenAt(f->v2);
+    out->v3 = cache->screenAt(f->v3);
+
+    return setupEdges(out, this->xres, this->yres) ? 1 : 0;
+}
+
+/*
+ image::clipTriangle
+
+ Prepares a facet that crosses the near plane for rastering.  The facet is
+ clipped in clip space to the part of it on the visible side of the near
+ plane, before any division by w, so vertices behind the camera do not flip
+ across the screen.  What is left is a triangle or a quadrilateral, which is
+ split into at most two facets, and each is culled and prepared the same way
+ as in setupTriangle.
+
+ Arguments: See setupTriangle.
+
+ Returns:   (int) - The number of facets prepared
+*/
+int image::clipTriangle
+(
+    int                 idx,
+    const instance      *inst,
+    vertexCache         *cache,
+    shading             alg,
+    rasterFacet         *out
+)
+{
+    const facet *f = &inst->mesh->facets[idx];
+    int vs[3] = { f->v1, f->v2, f->v3 };
+    int ns[3] = { f->n1, f->n2, f->n3 };
+
+    // Gather the corners in clip space.  NDC cannot be taken back to clip
+    // space where w is zero, so they are transformed again from world space.
+    clipVertex in[3];
+    for (int i = 0; i < 3; ++i) {
+        in[i].src = vs[i];
+        in[i].p = cache->world.pointAt(vs[i]);
+        Vector4f clip = cache->worldToClip *
+            Vector4f(in[i].p.x, in[i].p.y, in[i].p.z, 1);
+        in[i].x = clip(0);
+        in[i].y = clip(1);
+        in[i].z = clip(2);
+        in[i].w = clip(3);
+        if (alg == Gouraud)
+            in[i].c = cache->colors[cache->corners[3*idx + i]];
+        else
+            in[i].n = cache->world.normalAt(ns[i]);
+    }
+
+    // Keep the part where z >= -w, adding a vertex wherever an edge crosses
+    // the plane.  The new vertex is always found from the kept end of the
+    // edge, so the facet on the other side of the edge finds the same one
+    // and no crack opens between them.
+    clipVertex poly[4];
+    int nPoly = 0;
+    for (int i = 0; i < 3; ++i) {
+        const clipVertex &a = in[i], &b = in[(i + 1) % 3];
+        float da = a.z + a.w, db = b.z + b.w;
+        if (da >= 0)
+            poly[nPoly++] = a;
+        if (da >= 0 && db < 0)
+            poly[nPoly++] = lerpClip(a, b, da / (da - db));
+        else if (da < 0 && db >= 0)
+            poly[nPoly++] = lerpClip(b, a, db / (db - da));
+    }
+
+    // Resolutions are halved as integers, as in vertex::NDCToImage
+    float halfX = this->xres / 2, halfY = this->yres / 2;
+
+    // Fan out from the first vertex
+    int count = 0;
+    for (int t = 1; t + 1 < nPoly; ++t) {
+        rasterFacet *rf = &out[count];
+        clipVertex *c[3] = { &poly[0], &poly[t], &poly[t + 1] };
+        vertex *ndc[3] = { &rf->v1NDC, &rf->v2NDC, &rf->v3NDC };
+        vertex *screen[3] = { &rf->v1, &rf->v2, &rf->v3 };
+        point3D *p[3] = { &rf->p1, &rf->p2, &rf->p3 };
+        normal *n[3] = { &rf->n1, &rf->n2, &rf->n3 };
+        for (int i = 0; i < 3; ++i) {
+            // Corners that were not clipped land exactly where they do on
+            // the facets around them that needed no clipping
+            if (c[i]->src >= 0) {
+                *ndc[i] = cache->ndc.vertexAt(c[i]->src);
+                ndc[i]->c = c[i]->c;
+                *screen[i] = cache->screenAt(c[i]->src);
+            } else {
+                *ndc[i] = vertex(c[i]->x / c[i]->w, c[i]->y / c[i]->w,
+                    c[i]->z / c[i]->w, c[i]->c);
+                *screen[i] = vertex((int) ((1 + ndc[i]->x) * halfX),
+                    (int) ((1 + ndc[i]->y) * halfY), 0);
+            }
+            *p[i] = c[i]->p;
+            *n[i] = c[i]->n;
+        }
+        if (!cullNDC(rf))
+            continue;
+
+        rf->inst = inst;
+        rf->lighting = &cache->lighting;
+        rf->materialID = cache->materialID;
+        if (setupEdges(rf, this->xres, this->yres))
+            count++;
+    }
+
+    return count;
+}
+
+/*
+ image::shadePixel
+
+ Computes the color of one pixel of a facet from its barycentric coordinates,
+ using either Gouraud or Phong shading.  Phong shading lights the pixel with
+ the lights the facet was prepared with.
+
+ Arguments: rasterFacet *rf - The prepared facet the pixel is on
+            float alpha - Barycentric coordinate of the facet's first vertex
+            float beta - Barycentric coordinate of the facet's second vertex
+            float gamma - Barycentric coordinate of the facet's third vertex
+            int maxIntensity - The rgb values will be scaled from 0 to
+                this number.  This cannot exceed 255.
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   (uint32_t) - The RGBA color of the pixel
+*/
+uint32_t image::shadePixel
+(
+    rasterFacet         *rf,
+    float               alpha,
+    float               beta,
+    float               gamma,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    vertex *v1NDC = &rf->v1NDC, *v2NDC = &rf->v2NDC, *v3NDC = &rf->v3NDC;
+
+    // PHONG
+    if (alg == Phong) {
+        point3D *p1 = &rf->p1, *p2 = &rf->p2, *p3 = &rf->p3;
+        normal *n1 = &rf->n1, *n2 = &rf->n2, *n3 = &rf->n3;
+
+        // Find the weighted world space position and normal values
+        vertex v(alpha*p1->x + beta*p2->x + gamma*p3->x,
+                 alpha*p1->y + beta*p2->y + gamma*p3->y,
+                 alpha*p1->z + beta*p2->z + gamma*p3->z);
+        point3D nPt(alpha*n1->x + beta*n2->x + gamma*n3->x,
+                    alpha*n1->y + beta*n2->y + gamma*n3->y,
+                    alpha*n1->z + beta*n2->z + gamma*n3->z);
+        nPt.normalize();
+
+        // Now that we have a sort of average vertex and normal, find the
+        // appropriate color.
+        v.computeLight(normal(nPt.x, nPt.y, nPt.z), *rf->lighting);
+        return v.c.toUInt32(maxIntensity);
+    }
+
+    // GOURAUD
+    // Update the colors based on where on the facet we are
+    rgb c;
+    c.r = alpha*v1NDC->c.r + beta*v2NDC->c.r + gamma*v3NDC->c.r;
+    c.g = alpha*v1NDC->c.g + beta*v2NDC->c.g + gamma*v3NDC->c.g;
+    c.b = alpha*v1NDC->c.b + beta*v2NDC->c.b + gamma*v3NDC->c.b;
+    return c.toUInt32(maxIntensity);
+}
+
+/*
+ image::writeFragment
+
+ Writes one pixel of a facet that passed the depth test.  Under deferred
+ Phong shading, its world space position and normal and its material are
+ stored in the G-buffer to be lit later.  Otherwise it is shaded right away.
+
+ Arguments: rasterFacet *rf - The prepared facet the pixel is on
+            int x - Column of the pixel
+            int y - Row of the pixel
+            float alpha - Barycentric coordinate of the facet's first vertex
+            float beta - Barycentric coordinate of the facet's second vertex
+            float gamma - Barycentric coordinate of the facet's third vertex
+            int maxIntensity - The rgb values will be scaled from 0 to
+                this number.  This cannot exceed 255.
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   Nothing.
+*/
+void image::writeFragment
+(
+    rasterFacet         *rf,
+    int                 x,
+    int                 y,
+    float               alpha,
+    float               beta,
+    float               gamma,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    if (alg != DeferredPhong) {
+        this->colors[y][x] = this->shadePixel(rf, alpha, beta, gamma,
+            maxIntensity, alg);
+        return;
+    }
+
+    // Interpolate exactly as shadePixel does, so lighting the stored values
+    // gives the same color
+    point3D *p1 = &rf->p1, *p2 = &rf->p2, *p3 = &rf->p3;
+    normal *n1 = &rf->n1, *n2 = &rf->n2, *n3 = &rf->n3;
+    gBuffer *g = &this->gbuffer;
+    size_t i = g->at(x, y);
+    g->x[i] = alpha*p1->x + beta*p2->x + gamma*p3->x;
+    g->y[i] = alpha*p1->y + beta*p2->y + gamma*p3->y;
+    g->z[i] = alpha*p1->z + beta*p2->z + gamma*p3->z;
+    g->nx[i] = alpha*n1->x + beta*n2->x + gamma*n3->x;
+    g->ny[i] = alpha*n1->y + beta*n2->y + gamma*n3->y;
+    g->nz[i] = alpha*n1->z + beta*n2->z + gamma*n3->z;
+    g->material[i] = rf->materialID;
+}
+
+/*
+ image::rasterSpan
+
+ Rasters one row of pixels of a prepared facet, one pixel at a time.  The
+ edge functions are stepped with an addition per pixel.  Every pixel inside
+ of the facet is depth tested and then shaded.
+
+ Arguments: rasterFacet *rf - The prepared facet to raster
+            int y - The row to raster
+            int x0 - Leftmost column of the span
+            int x1 - One past the rightmost column of the span
+            int64_t w1 - Value of the edge function opposite v1 at (x0, y),
+                less its fill rule bias
+            int64_t w2 - Same as w1, for the edge opposite v2
+            int64_t w3 - Same as w1, for the edge opposite v3
+            int maxIntensity - The rgb values will be scaled from 0 to
+                this number.  This cannot exceed 255.
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   (int) - The number of pixels written
+*/
+int image::rasterSpan
+(
+    rasterFacet         *rf,
+    int                 y,
+    int                 x0,
+    int                 x1,
+    int64_t             w1,
+    int64_t             w2,
+    int64_t             w3,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    vertex *v1NDC = &rf->v1NDC, *v2NDC = &rf->v2NDC, *v3NDC = &rf->v3NDC;
+    edgeFunction *e1 = &rf->e1, *e2 = &rf->e2, *e3 = &rf->e3;
+    float invArea = rf->invArea;
+
+    uint32_t *depthRow = this->depths[y];
+    int written = 0;
+
+    for (int x = x0; x < x1; ++x, w1 += e1->a, w2 += e2->a, w3 += e3->a) {
+        // The pixel is inside the triangle iff. no edge function is
+        // negative, which is true iff. the sign bit of their OR is clear
+        if ((w1 | w2 | w3) < 0)
+            continue;
+
+        // Barycentric coordinates of this pixel
+        float alpha = (w1 + e1->bias) * invArea;
+        float beta  = (w2 + e2->bias) * invArea;
+        float gamma = (w3 + e3->bias) * invArea;
+
+        // Depth of this pixel, which must be between the near and far
+        // planes to be seen
+        float z = alpha*v1NDC->z + beta*v2NDC->z + gamma*v3NDC->z;
+        if (z < -1 || z > 1)
+            continue;
+
+        // Check if the point is in front of everything else.  Note that the
+        // z axis is reversed, so the front is the most negative.
+        uint32_t depth = (uint32_t) ((z * 0.5f + 0.5f) * DEPTH_MAX);
+        if (depth > depthRow[x])
+            continue;
+        depthRow[x] = depth;
+
+        // Fill the pixel with the color computed based on light, texture,
+        // distance, etc.
+        this->writeFragment(rf, x, y, alpha, beta, gamma, maxIntensity,
+            alg);
+        written++;
+    }
+
+    return written;
+}
+
+/*
+ image::rasterRect
+
+ Rasters the part of a prepared facet that lies inside of a rectangle on the
+ image.  The edge functions are evaluated once at the corner of the rectangle
+ and then stepped with additions up each column, and each row is rastered as
+ a span.  When the image allows it, the work is handed to the vector
+ rasterizer instead.  Pixels outside of the rectangle are never touched.
+
+ Arguments: rasterFacet *rf - The prepared facet to raster
+            int x0 - Leftmost column of the rectangle
+            int y0 - Bottommost row of the rectangle
+            int x1 - One past the rightmost column of the rectangle
+            int y1 - One past the topmost row of the rectangle
+            int maxIntensity - The rgb values will be scaled from 0 to
+                this number.  This cannot exceed 255.
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   (int) - The number of pixels written
+*/
+int image::rasterRect
+(
+    rasterFacet         *rf,
+    int                 x0,
+    int                 y0,
+    int                 x1,
+    int                 y1,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    // Use vector instructions if the facet allows for it
+    if (this->simd != SIMDNone && rf->simdSafe &&
+        this->xres <= SIMD_GUARD && this->yres <= SIMD_GUARD) {
+        return this->rasterRegionSIMD(rf, x0, y0, x1, y1, maxIntensity,
+            alg);
+    }
+
+    edgeFunction *e1 = &rf->e1, *e2 = &rf->e2, *e3 = &rf->e3;
+    int written = 0;
+
+    // Edge function values at the first pixel of the current row, with the
+    // fill rule bias already applied.  The bias is added back in before
+    // computing barycentric coordinates.
+    int64_t w1Row = e1->at(x0, y0) - e1->bias;
+    int64_t w2Row = e2->at(x0, y0) - e2->bias;
+    int64_t w3Row = e3->at(x0, y0) - e3->bias;
+
+    for (int y = y0; y < y1; ++y) {
+        written += this->rasterSpan(rf, y, x0, x1, w1Row, w2Row, w3Row,
+            maxIntensity, alg);
+
+        // Step every edge function up one row
+        w1Row += e1->b;
+        w2Row += e2->b;
+        w3Row += e3->b;
+    }
+
+    return written;
+}
+
+/*
+ image::updateHiZ
+
+ Recomputes the least and greatest depth of a tile of the hierarchical depth
+ buffer after pixels in it have been written, and marks it clean.
+
+ Arguments: int tile - Index of the tile to update
+
+ Returns:   Nothing.
+*/
+void image::updateHiZ
+(
+    int                 tile
+)
+{
+    int x0 = (tile % this->hizCols) * HIZ_TILE;
+    int y0 = (tile / this->hizCols) * HIZ_TILE;
+    int x1 = min(x0 + HIZ_TILE, this->xres);
+    int y1 = min(y0 + HIZ_TILE, this->yres);
+
+    uint32_t lo = -1, hi = 0;
+    for (int y = y0; y < y1; ++y) {
+        uint32_t *depthRow = this->depths[y];
+        for (int x = x0; x < x1; ++x) {
+            lo = min(lo, depthRow[x]);
+            hi = max(hi, depthRow[x]);
+        }
+    }
+    this->hizMin[tile] = lo;
+    this->hizMax[tile] = hi;
+    this->hizDirty[tile] = 0;
+}
+
+/*
+ image::rasterRegion
+
+ Rasters the part of a prepared facet that lies inside of a rectangle on the
+ image.  The rectangle is walked one tile of the hierarchical depth buffer at
+ a time.  Any tile whose farthest pixel is nearer than the nearest point on
+ the facet is already completely hiding it there, so it is skipped without
+ touching a single pixel; if every tile is skipped, the whole facet is
+ rejected.  Writing to a tile only marks it dirty, and it is recomputed the
+ next time a facet could be rejected by it, so tiles that are only drawn
+ into once never pay for it.  Pixels outside of the rectangle are never
+ touched, so disjoint rectangles that are aligned to TILE_SIZE can be
+ rastered concurrently.
+
+ Arguments: rasterFacet *rf - The prepared facet to raster
+            int x0 - Leftmost column of the rectangle
+            int y0 - Bottommost row of the rectangle
+            int x1 - One past the rightmost column of the rectangle
+            int y1 - One past the topmost row of the rectangle
+            int maxIntensity - The rgb values will be scaled from 0 to
+                this number.  This cannot exceed 255.
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   Nothing.
+*/
+void image::rasterRegion
+(
+    rasterFacet         *rf,
+    int                 x0,
+    int                 y0,
+    int                 x1,
+    int                 y1,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    assert(rf);
+
+    // Never leave the image
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, this->xres);
+    y1 = min(y1, this->yres);
+
+    // Only visit depth tiles that the facet's bounding box touches
+    int bx0 = max(x0, rf->xMin), by0 = max(y0, rf->yMin);
+    int bx1 = min(x1, rf->xMax), by1 = min(y1, rf->yMax);
+    int tx0 = bx0 / HIZ_TILE, ty0 = by0 / HIZ_TILE;
+    int tx1 = (bx1 + HIZ_TILE - 1) / HIZ_TILE;
+    int ty1 = (by1 + HIZ_TILE - 1) / HIZ_TILE;
+
+    // The vector rasterizer rasters the full width of a tile, as pixels
+    // outside the bounding box fail the edge tests anyway and full tiles
+    // fill its blocks.  The scalar rasterizer sticks to the bounding box.
+    bool wide = this->simd != SIMDNone && rf->simdSafe &&
+        this->xres <= SIMD_GUARD && this->yres <= SIMD_GUARD;
+
+    for (int ty = ty0; ty < ty1; ++ty) {
+        for (int tx = tx0; tx < tx1; ++tx) {
+            int tile = ty * this->hizCols + tx;
+
+            // Early out if everything in this tile is in front of the facet.
+            // A dirty tile's maximum may be too large, so bring it up to
+            // date before giving up on rejecting the facet.
+            if (rf->depthMin > this->hizMax[tile])
+                continue;
+            if (this->hizDirty[tile]) {
+                this->updateHiZ(tile);
+                if (rf->depthMin > this->hizMax[tile])
+                    continue;
             }
-            cout << endl;
+
+            int rx0 = max(tx * HIZ_TILE, wide ? x0 : bx0);
+            int rx1 = min((tx + 1) * HIZ_TILE, wide ? x1 : bx1);
+            int ry0 = max(ty * HIZ_TILE, by0);
+            int ry1 = min((ty + 1) * HIZ_TILE, by1);
+            if (this->rasterRect(rf, rx0, ry0, rx1, ry1, maxIntensity,
+                                 alg) > 0)
+                this->hizDirty[tile] = 1;
         }
     }
 }
@@ -259,11 +1044,10 @@ void image::outputPPM
  based on either Gouraud or Phong shading algorithm.  Which is used is a
  parameter to the function.
 
- Arguments: facet f - The facet to display
-            shape3D *shape - Contains information about the material of f
-            camera cam - Contains information about what can and can't be seen
-                by the view point
-            vector<light> lights - A vector of light sources in the system
+ Arguments: int idx - Index of the facet to display in the mesh's facets
+            const instance *inst - Its mesh contains the facet, and it has
+                the material
+            vertexCache *cache - The instance's transformed and lit vertices
             int maxIntensity - The rgb values will be scaled from 0 to
                 this number.  This cannot exceed 255.
             shading alg - Defines which algorithm to use when shading
@@ -272,176 +1056,150 @@ void image::outputPPM
 */
 void image::rasterTriangle
 (
-    facet               f,
-    shape3D             *shape,
-    camera              cam,
-    vector<light>       lights,
+    int                 idx,
+    const instance      *inst,
+    vertexCache         *cache,
     int                 maxIntensity,
     shading             alg
 )
 {
-    // Vertices
-    vertex v1Orig = shape->vertices.at(f.v1);
-    vertex v2Orig = shape->vertices.at(f.v2);
-    vertex v3Orig = shape->vertices.at(f.v3);
-
-    // Convert vertices to NDC
-    // Populate our vertices with Cartesian NDC coordinates
-    vertex v1NDC, v2NDC, v3NDC;
-    v1Orig.worldToCartNDC(shape->ptTransform, cam, &v1NDC);
-    v2Orig.worldToCartNDC(shape->ptTransform, cam, &v2NDC);
-    v3Orig.worldToCartNDC(shape->ptTransform, cam, &v3NDC);
+    rasterFacet rf[MAX_CLIP_FACETS];
+    int n = this->setupTriangle(idx, inst, cache, alg, rf);
+    for (int i = 0; i < n; ++i) {
+        this->rasterRegion(&rf[i], 0, 0, this->xres, this->yres,
+            maxIntensity, alg);
+    }
+}
 
-    // If the vertex is not facing the camera, we do not want to see it.
-    if (!facingCamera(v1NDC, v2NDC, v3NDC))
-        return;
+/*
+ image::inView
 
-    // Normals for computing light
-    normal n1 = shape->normals.at(f.n1);
-    normal n2 = shape->normals.at(f.n2);
-    normal n3 = shape->normals.at(f.n3);
+ Decides whether any part of an instance could be drawn, by testing its
+ bounding sphere against the camera's view frustum.  Objects up to a couple
+ of pixels off of the image are kept, as they may still touch its edge.
 
-    // The material of the shape
-    material m = shape->mat;
+ Arguments: const instance *inst - The instance to test
+            const Matrix4f &toWorld - Transforms the mesh to world space,
+                usually the instance's ptTransform
+            camera &cam - The camera the scene is viewed from
 
-    if (alg == Gouraud) {
-        // Compute the color for each vertex
-        v1Orig.computeLight(n1, m.ambient, m.diffuse, m.specular,
-            m.shininess, cam, lights);
-        v2Orig.computeLight(n2, m.ambient, m.diffuse, m.specular,
-            m.shininess, cam, lights);
-        v3Orig.computeLight(n3, m.ambient, m.diffuse, m.specular,
-            m.shininess, cam, lights);
-
-        // Copy colors over
-        v1NDC.c = v1Orig.c;
-        v2NDC.c = v2Orig.c;
-        v3NDC.c = v3Orig.c;
-    }
+ Returns:   (bool) - False if the instance is certainly out of view
+*/
+bool image::inView
+(
+    const instance      *inst,
+    const Matrix4f      &toWorld,
+    camera              &cam
+)
+{
+    assert(inst);
 
-    // Vertices in screen coordinates
-    vertex v1, v2, v3;
-    v1NDC.NDCToImage(this->xres, this->yres, &v1);
-    v2NDC.NDCToImage(this->xres, this->yres, &v2);
-    v3NDC.NDCToImage(this->xres, this->yres, &v3);
-
-    // Define our iteration bounds based on the bounds of the facet
-    float xMin = min(v1.x, min(v2.x, v3.x));
-    float yMin = min(v1.y, min(v2.y, v3.y));
-    float xMax = max(v1.x, max(v2.x, v3.x));
-    float yMax = max(v1.y, max(v2.y, v3.y));
-
-    // Values used to determine whether point is on interior or exterior of
-    // triangle
-    float alpha, beta, gamma;
-    // Will contain color of each new pixel that we paint
-    uint32_t color = 0;
-
-    // Color each point iff. it is inside the triangle described by v1 v2 v3
-    for (int x = xMin; x < xMax; ++x) {
-        for (int y = yMin; y < yMax; ++y) {
-            alpha = v1.barycentricCoeff(v2, v3, point3D(x, y, 0));
-            beta =  v2.barycentricCoeff(v1, v3, point3D(x, y, 0));
-            gamma = v3.barycentricCoeff(v1, v2, point3D(x, y, 0));
-
-            // If alpha, beta and gamma are all between 0 and 1, the point is
-            // inside the triangle
-            point3D botCorner(0, 0, 0);
-            point3D topCorner(1, 1, 1);
-            if (point3D(alpha, beta, gamma).inCube(botCorner, topCorner)) {
-                // Find the weighted vertex value.  This will be used to decide
-                // whether the point is behind something already in view.
-                vertex vNDC =
-                    vertex(alpha*v1NDC.x + alpha*v2NDC.x + alpha*v3NDC.x,
-                            beta*v1NDC.y +  beta*v2NDC.y +  beta*v3NDC.y,
-                           gamma*v1NDC.z + gamma*v2NDC.z + gamma*v3NDC.z);
-
-                // Check if the point is in front of everything else.  Note
-                // that the z axis is reversed, so the front is the most
-                // negative.
-                if (vNDC.z > this->depths[y][x])
-                    continue;
-                this->depths[y][x] = vNDC.z;
-
-                // PHONG
-                if (alg == Phong) {
-                    // Find the weighted normal value
-                    normal nNDC =
-                        normal(alpha*n1.x + alpha*n2.x + alpha*n3.x,
-                                beta*n1.y +  beta*n2.y +  beta*n3.y,
-                               gamma*n1.z + gamma*n2.z + gamma*n3.z);
-
-                    // Now that we have a sort of average vertex and normal,
-                    // find the appropriate color.
-                    vNDC.computeLight(n1, m.ambient, m.diffuse,
-                        m.specular, m.shininess, cam, lights);
-                    color = vNDC.c.toUInt32(maxIntensity);
-                } else if (alg == Gouraud) {
-                    // GOURAUD
-                    // Update the colors based on where on the facet we are
-                    rgb c;
-                    c.r = alpha*v1NDC.c.r + beta*v2NDC.c.r + gamma*v3NDC.c.r;
-                    c.g = alpha*v1NDC.c.g + beta*v2NDC.c.g + gamma*v3NDC.c.g;
-                    c.b = alpha*v1NDC.c.b + beta*v2NDC.c.b + gamma*v3NDC.c.b;
-                    color = c.toUInt32(maxIntensity);
-                }
-                // Fill the pixel with the color computed based on light,
-                // texture, distance, etc.
-                (*this)[y][x] = color;
-            }
-        }
+    // Two pixels, in NDC
+    float xMargin = 4.0f / this->xres, yMargin = 4.0f / this->yres;
+    return cam.canSee(inst->worldBounds(toWorld), xMargin, yMargin);
+}
+
+/*
+ image::rasterCached
+
+ Rasters every facet of an instance whose vertices have already been
+ transformed and lit.  Under deferred Phong shading, the instance's material
+ is added to the G-buffer first, and the pixels are left to be lit by
+ shadeDeferred.
+
+ Arguments: const instance *inst - The instance to raster
+            vertexCache *cache - The instance's transformed and lit vertices
+            shading alg - The shading algorithm to use
+
+ Returns:   Nothing.
+*/
+void image::rasterCached
+(
+    const instance      *inst,
+    vertexCache         *cache,
+    shading             alg
+)
+{
+    assert(inst);
+    assert(cache);
+    assert(cache->inst == inst);
+
+    if (alg == DeferredPhong)
+        this->addMaterial(cache);
+
+    // Want to raster every face on the instance's mesh
+    int nFacets = inst->mesh->facets.size();
+    for (int f = 0; f < nFacets; ++f) {
+        this->rasterTriangle(f, inst, cache, this->intensity, alg);
     }
 }
 
 /*
- image::rasterShape
+ image::rasterInstance
 
- Takes a shape and rasters every facet on it.
+ Takes an instance, transforms and lights all of its mesh's vertices once
+ with its transformation and material, then rasters every facet on it.
+ Nothing is done if the instance is out of view.
 
- Arguments: shape3D shape - The shape to raster
-            camera cam - Information about the view of the shape
+ Arguments: const instance *inst - The instance to raster
+            vertexCache *cache - Where to keep the transformed and lit
+                vertices, which may have been used for another instance
+            camera cam - Information about the view of the instance
             vector<light> lights - List of light sources in the system
             shading alg - The shading algorithm to use
 
  Returns:   Nothing.
 */
-void image::rasterShape
+void image::rasterInstance
 (
-    shape3D             *shape,
+    const instance      *inst,
+    vertexCache         *cache,
     camera              cam,
     vector<light>       lights,
     shading             alg
 )
 {
-    // Want to raster every face on the shape
-    std::vector<facet>::iterator f = shape->facets.begin();
-    for (; f != shape->facets.end(); ++f) {
-        this->rasterTriangle(*f, shape, cam, lights, this->intensity, alg);
-    }
+    if (!this->inView(inst, inst->ptTransform, cam))
+        return;
+
+    cache->build(inst, inst->ptTransform, cam, lights, alg == Gouraud,
+        this->xres, this->yres, 1, this->simd);
+    this->rasterCached(inst, cache, alg);
 }
 
 /*
- image::rasterShapes
+ image::rasterInstances
 
- Takes a list of shapes and rasters each of them.
+ Takes a list of instances and rasters each of them.  One vertex cache is
+ reused for all of them, so instances of the same mesh listed one after
+ another share its buffers and its vertex and normal pairings.  Under
+ deferred Phong shading, every visible pixel is then lit once, split across
+ threads.
 
- Arguments: vector<shape3D> *shapes - The list of shapes to raster
-            camera cam - Information about the view of the shape
+ Arguments: instanceList *instances - The list of instances to raster
+            camera cam - Information about the view of the instances
             vector<light> lights - List of light sources in the system
             shading alg - The shading algorithm to use
+            int nThreads - Number of threads to light pixels with under
+                deferred Phong shading, or 0 to use one per core
 
  Returns:   Nothing.
 */
-void image::rasterShapes
+void image::rasterInstances
 (
-    vector<shape3D>     *shapes,
+    instanceList        *instances,
     camera              cam,
     vector<light>       lights,
-    shading             alg
+    shading             alg,
+    int                 nThreads
 )
 {
-    vector<shape3D>::iterator s = shapes->begin();
-    for (; s != shapes->end(); ++s) {
-        this->rasterShape(&(*s), cam, lights, alg);
+    vertexCache cache;
+    instanceList::iterator i = instances->begin();
+    for (; i != instances->end(); ++i) {
+        this->rasterInstance(&(*i), &cache, cam, lights, alg);
     }
+
+    if (alg == DeferredPhong)
+        this->shadeDeferred(nThreads);
 }
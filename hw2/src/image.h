@@ -11,6 +11,8 @@
 #define IMAGE
 
 #include <cmath>
+#include <cstdlib>
+#include <vector>
 
 #include <Eigen/Dense>
 
@@ -18,72 +20,260 @@
 #include "transform.h"
 #include "light.h"
 #include "projection.h"
+#include "simd.h"
+#include "instance.h"
+#include "vertexCache.h"
+#include "ppmWriter.h"
+#include "gBuffer.h"
 
 // Enums
 /*
  shading
 
  Used to determine which shading algorithm to use when rastering the image.
+ DeferredPhong produces the same image as Phong, but rastering only fills
+ the G-buffer, and each visible pixel is lit once afterwards.
 */
 typedef enum _shading {
     Gouraud,
     Phong,
+    DeferredPhong,
 } shading;
 
+// Width and height, in pixels, of the square screen tiles used when binning
+// facets for multithreaded rasterization
+#define TILE_SIZE       64
+
+// Width and height, in pixels, of the square tiles of the hierarchical depth
+// buffer.  TILE_SIZE must be a multiple of this so that threads rastering
+// different screen tiles never share a depth tile.
+#define HIZ_TILE        8
+
+// Depths are stored as 24 bit fixed point values, where 0 is the near plane
+// and DEPTH_MAX is the far plane
+#define DEPTH_MAX       0xffffff
+
+// Clipping a facet against the near plane leaves at most this many facets
+#define MAX_CLIP_FACETS 2
+
+// Rows of the color and depth buffers start on boundaries of this many bytes
+#define ROW_ALIGN       64
+
+// Vector rasterization uses 32 bit edge functions, which cannot overflow as
+// long as the image and every facet's vertices lie within this many pixels
+// of the origin.  Facets reaching further out are rastered by scalar code.
+#define SIMD_GUARD      8192
+
 // Structs
 
+/*
+ edgeFunction
+
+ The line equation a*x + b*y + c for one edge of a facet in screen space.  It
+ is oriented so that it is positive on the interior side of the edge, so that
+ it can be stepped across the screen with only additions.  The bias is 0 for
+ top and left edges and 1 otherwise, which is subtracted before testing so
+ that pixels lying exactly on an edge shared by two facets are only drawn by
+ one of them.
+*/
+typedef struct _edgeFunction {
+    int64_t     a;
+    int64_t     b;
+    int64_t     c;
+    int64_t     bias;
+
+    _edgeFunction() : a (0), b (0), c (0), bias (0) {}
+    ~_edgeFunction() {}
+
+    int64_t at(int x, int y) const { return a*x + b*y + c; }
+} edgeFunction;
+
+/*
+ rasterFacet
+
+ A facet that has been transformed to screen space and survived culling.  It
+ holds everything needed to raster any rectangular region of the facet, so
+ the facet can be set up once and then rastered piecewise by several threads.
+ The vertices are kept in screen space and in NDC, where the NDC vertices
+ also carry the vertex colors under Gouraud shading.  Under Phong shading, the
+ world space positions and normals of the vertices are kept for lighting,
+ along with the lights prepared for the facet's material and, under deferred
+ Phong shading, the ID of the material in the image's G-buffer.
+*/
+typedef struct _rasterFacet {
+    vertex      v1;
+    vertex      v2;
+    vertex      v3;
+    vertex      v1NDC;
+    vertex      v2NDC;
+    vertex      v3NDC;
+    point3D     p1;
+    point3D     p2;
+    point3D     p3;
+    normal      n1;
+    normal      n2;
+    normal      n3;
+    const instance *inst;
+    const lightingContext *lighting;
+    int         materialID;
+
+    // Edge functions opposite v1, v2 and v3, respectively, and the
+    // reciprocal of their value at the vertex they are opposite of.  Scaling
+    // an edge function by invArea gives the barycentric coordinate of its
+    // opposite vertex.
+    edgeFunction e1;
+    edgeFunction e2;
+    edgeFunction e3;
+    float       invArea;
+
+    // True if every vertex is within SIMD_GUARD pixels of the origin
+    bool        simdSafe;
+
+    // No pixel on the facet has a depth less than this
+    uint32_t    depthMin;
+
+    // Screen bounding box of the facet, clamped to the image
+    int         xMin;
+    int         yMin;
+    int         xMax;
+    int         yMax;
+} rasterFacet;
+
+/*
+ pixelView
+
+ A rectangle of pixels in a color or depth buffer.  Consecutive rows are
+ pitch pixels apart in memory, so a view of part of a buffer is walked the
+ same way as a view of all of it.
+*/
+typedef struct _pixelView {
+    uint32_t    *data;
+    int         width;
+    int         height;
+    int         pitch;
+
+    _pixelView(uint32_t *data, int w, int h, int pitch)
+        : data (data), width (w), height (h), pitch (pitch) {}
+    ~_pixelView() {}
+
+    uint32_t *row(int y) const { return data + (size_t) y * pitch; }
+} pixelView;
+
 /*
  image
 
  Represents an image on a screen.  It contains screen resolution, the max
  intensity of a pixel color, the pixel colors themselves and the depth of the
- frontmost object at each location.
+ frontmost object at each location.  Colors and depths are each stored in a
+ single aligned buffer, one row after another starting from the bottom, with
+ every row padded out to pitch pixels so that it starts on a cache line.
+ The colors and depths arrays hold a pointer to the start of each row.
 */
 typedef struct _image {
     int         xres;
     int         yres;
     int         intensity;
+    int         pitch;
+    uint32_t    *colorBuffer;
+    uint32_t    *depthBuffer;
     uint32_t    **colors;
     uint32_t    **depths;
+    simdLevel   simd;
+
+    // Hierarchical depth buffer.  For every HIZ_TILE x HIZ_TILE tile of the
+    // image, the least and greatest depth of any pixel in it.  Tiles that
+    // have been written since they were last computed are marked dirty, in
+    // which case hizMax is still an upper bound on the tile's depths.
+    int         hizCols;
+    int         hizRows;
+    uint32_t    *hizMin;
+    uint32_t    *hizMax;
+    uint8_t     *hizDirty;
 
-    // Create a 2D vector of pixels given xres and yres
+    // Geometry buffer for deferred shading, which is only allocated once a
+    // material is added to it
+    gBuffer     gbuffer;
+
+    // Create a buffer of pixels given xres and yres, cleared to a color
     _image(int xres, int yres, int i, uint32_t rgba)
-        : xres (xres), yres (yres), intensity (i)
+        : xres (xres), yres (yres), intensity (i), simd (detectSIMD())
     {
+        hizCols = (xres + HIZ_TILE - 1) / HIZ_TILE;
+        hizRows = (yres + HIZ_TILE - 1) / HIZ_TILE;
+        hizMin = (uint32_t *)malloc(hizCols * hizRows * sizeof(uint32_t));
+        hizMax = (uint32_t *)malloc(hizCols * hizRows * sizeof(uint32_t));
+        hizDirty = (uint8_t *)malloc(hizCols * hizRows * sizeof(uint8_t));
+
+        // Round rows up to a whole number of cache lines
+        int lineLen = ROW_ALIGN / sizeof(uint32_t);
+        pitch = (xres + lineLen - 1) / lineLen * lineLen;
+        size_t size = (size_t) pitch * yres * sizeof(uint32_t);
+        if (posix_memalign((void **) &colorBuffer, ROW_ALIGN, size))
+            colorBuffer = NULL;
+        if (posix_memalign((void **) &depthBuffer, ROW_ALIGN, size))
+            depthBuffer = NULL;
+        assert(colorBuffer && depthBuffer);
+
         colors = (uint32_t **)malloc(yres * sizeof(uint32_t *));
         depths = (uint32_t **)malloc(yres * sizeof(uint32_t *));
         for (int r = 0; r < yres; ++r) {
-            colors[r] = (uint32_t *)malloc(xres * sizeof(uint32_t));
-            depths[r] = (uint32_t *)malloc(xres * sizeof(uint32_t));
-            for (int c = 0; c < xres; ++c) {
-                colors[r][c] = rgba;
-                depths[r][c] = -1;
-            }
+            colors[r] = colorBuffer + (size_t) r * pitch;
+            depths[r] = depthBuffer + (size_t) r * pitch;
         }
+
+        clear(rgba);
     }
     ~_image() {
-        for (int r = 0; r < yres; ++r) {
-            free (colors[r]);
-            free (depths[r]);
-        }
+        free (colorBuffer);
+        free (depthBuffer);
+        free (colors);
+        free (depths);
+        free (hizMin);
+        free (hizMax);
+        free (hizDirty);
+    }
+
+    pixelView colorView(int x0, int y0, int x1, int y1) {
+        return pixelView(colors[y0] + x0, x1 - x0, y1 - y0, pitch);
+    }
+    pixelView depthView(int x0, int y0, int x1, int y1) {
+        return pixelView(depths[y0] + x0, x1 - x0, y1 - y0, pitch);
     }
 
     // Allow us to access colors array with square brackets
     uint32_t* &operator[] (unsigned int i) { return colors[i]; }
 
+    void clear (uint32_t);
     void outputPPM ();
+    void outputPPM (ppmWriter*);
 
     void drawLine (point2D, point2D, uint32_t);
-    void generateWireframes (std::vector<shape3D>*, uint32_t);
+    void generateWireframes (shapeList*, uint32_t);
     void generateWireframe (shape3D*, uint32_t);
 
-    void rasterTriangle (facet, shape3D*, camera, std::vector<light>, int, shading);
-    void rasterShapes (std::vector<shape3D>*, camera, std::vector<light>, shading);
-    void rasterShape (shape3D*, camera, std::vector<light>, shading);
+    int setupTriangle (int, const instance*, vertexCache*, shading, rasterFacet*);
+    int clipTriangle (int, const instance*, vertexCache*, shading, rasterFacet*);
+    void rasterRegion (rasterFacet*, int, int, int, int, int, shading);
+    int rasterRect (rasterFacet*, int, int, int, int, int, shading);
+    int rasterRegionSIMD (rasterFacet*, int, int, int, int, int, shading);
+    int rasterSpan (rasterFacet*, int, int, int, int64_t, int64_t, int64_t, int, shading);
+    void updateHiZ (int);
+    uint32_t shadePixel (rasterFacet*, float, float, float, int, shading);
+    void writeFragment (rasterFacet*, int, int, float, float, float, int, shading);
+    void addMaterial (vertexCache*);
+    void shadeDeferredRect (int, int, int, int);
+    void shadeDeferred (int);
+    void rasterTriangle (int, const instance*, vertexCache*, int, shading);
+    bool inView (const instance*, const Eigen::Matrix4f&, camera&);
+    void rasterCached (const instance*, vertexCache*, shading);
+    void rasterInstances (instanceList*, camera, std::vector<light>, shading, int);
+    void rasterInstance (const instance*, vertexCache*, camera, std::vector<light>, shading);
+    void rasterInstancesBinned (instanceList*, camera, std::vector<light>, shading, int, ppmWriter*);
 
 } image;
 
 // Function handles
-void NDCToScreen (int, int, camera*, std::vector<shape3D>*, std::vector<shape3D>*);
+void fillPixels (simdLevel, uint32_t*, size_t, uint32_t);
+void NDCToScreen (int, int, camera*, shapeList*, shapeList*);
 
 #endif // ifndef IMAGE
@@ -0,0 +1,42 @@
+/******************************************************************************
+
+ instance.cpp
+
+ Contains methods for placing instances of meshes in a scene.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include "instance.h"
+
+using namespace std;
+using namespace Eigen;
+
+/*
+ instance::worldBounds
+
+ Finds a sphere in world space around every vertex of the instance's mesh.
+ The center of the mesh's bounding sphere is transformed, and its radius is
+ scaled by the most the transformation stretches any direction, which is the
+ largest singular value of its linear part.
+
+ Arguments: const Matrix4f &toWorld - Transforms the mesh to world space,
+                usually the instance's ptTransform
+
+ Returns:   (boundingSphere) - A sphere containing the transformed mesh
+*/
+boundingSphere instance::worldBounds
+(
+    const Matrix4f      &toWorld
+) const
+{
+    assert(this->mesh);
+
+    const boundingSphere &b = this->mesh->bounds;
+    Vector4f c = toWorld * Vector4f(b.center.x, b.center.y, b.center.z, 1);
+    Matrix3f linear = toWorld.topLeftCorner<3, 3>();
+    SelfAdjointEigenSolver<Matrix3f> stretch(linear.transpose() * linear,
+        EigenvaluesOnly);
+    float scale = sqrt(stretch.eigenvalues().maxCoeff());
+    return boundingSphere(point3D(c(0), c(1), c(2)), b.radius * scale);
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+
+ instance.h
+
+ Contains instance struct
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef INSTANCE
+#define INSTANCE
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include "shape3d.h"
+
+// Structs
+/*
+ instance
+
+ One placement of a mesh in a scene.  The mesh's vertices, normals and
+ facets are shared by every instance of it and are never modified through
+ one.  Each instance has its own material and its own transformation
+ matrices, which are used in place of the mesh's.
+*/
+typedef struct _instance {
+    std::string         name;
+    const shape3D       *mesh;
+    material            mat;
+
+    Eigen::Matrix4f     ptTransform;
+    Eigen::Matrix4f     normTransform;
+
+    _instance() : name (""), mesh (NULL), mat (material()),
+        ptTransform(Eigen::Matrix4f::Identity()),
+        normTransform(Eigen::Matrix4f::Identity()) {}
+    _instance(std::string name, const shape3D *mesh) : name (name),
+        mesh (mesh), mat (material()),
+        ptTransform(Eigen::Matrix4f::Identity()),
+        normTransform(Eigen::Matrix4f::Identity()) {}
+    ~_instance() {}
+
+    boundingSphere worldBounds (const Eigen::Matrix4f&) const;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+} instance;
+
+// Types
+/*
+ instanceList
+
+ A list of instances.  Instances hold fixed size Eigen matrices, which must
+ be aligned, so like matrixList they need Eigen's allocator to live in a
+ vector.
+*/
+typedef std::vector<instance, Eigen::aligned_allocator<instance> >
+    instanceList;
+
+#endif // ifndef INSTANCE
@@ -0,0 +1,75 @@
+/******************************************************************************
+
+ light.cpp
+
+ Contains methods for preparing lights to be evaluated at many points.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include "light.h"
+
+using namespace std;
+
+/*
+ lightingContext::prepare
+
+ Fills the context for lighting points on a material with the argued lights
+ as seen from the argued camera.  Any lights already in the context are
+ replaced, reusing its arrays.
+
+ Arguments: const camera &cam - The camera the scene is viewed from
+            const vector<light> &lights - Lights in the system
+            rgb ambient - Ambient RGB value of the material
+            rgb diffuse - Diffuse RGB value of the material
+            rgb specular - Specular RGB value of the material
+            float shininess - Shininess of the material
+
+ Returns:   Nothing.
+*/
+void lightingContext::prepare
+(
+    const camera        &cam,
+    const vector<light> &lights,
+    rgb                 ambient,
+    rgb                 diffuse,
+    rgb                 specular,
+    float               shininess
+)
+{
+    this->eyeX = cam.pos.x;
+    this->eyeY = cam.pos.y;
+    this->eyeZ = cam.pos.z;
+    this->ambient = ambient;
+    this->shininess = shininess;
+    this->specPower = -1;
+    if (shininess >= 0 && shininess <= MAX_INT_SHININESS &&
+        shininess == (int) shininess)
+        this->specPower = (int) shininess;
+
+    int n = lights.size();
+    this->x.resize(n);
+    this->y.resize(n);
+    this->z.resize(n);
+    this->attenuation.resize(n);
+    this->diffuseR.resize(n);
+    this->diffuseG.resize(n);
+    this->diffuseB.resize(n);
+    this->specularR.resize(n);
+    this->specularG.resize(n);
+    this->specularB.resize(n);
+
+    for (int i = 0; i < n; ++i) {
+        const light *l = &lights[i];
+        this->x[i] = l->loc.x;
+        this->y[i] = l->loc.y;
+        this->z[i] = l->loc.z;
+        this->attenuation[i] = l->attenuation;
+        this->diffuseR[i] = l->color.r * diffuse.r;
+        this->diffuseG[i] = l->color.g * diffuse.g;
+        this->diffuseB[i] = l->color.b * diffuse.b;
+        this->specularR[i] = l->color.r * specular.r;
+        this->specularG[i] = l->color.g * specular.g;
+        this->specularB[i] = l->color.b * specular.b;
+    }
+}
@@ -2,7 +2,7 @@
 
  light.h
 
- Contains light struct and the rgb color struct
+ Contains light struct, the rgb color struct and the lightingContext struct
 
  Author: Tim Menninger
 
@@ -69,4 +69,50 @@ typedef struct _light {
     ~_light() {}
 } light;
 
+// Largest shininess that is raised to by repeated multiplication rather than
+// by pow when lighting, if it is a whole number
+#define MAX_INT_SHININESS   128
+
+/*
+ lightingContext
+
+ Everything needed to light a point on one material as seen by one camera,
+ prepared once before any points are lit.  Each light is stored as a
+ separate array per component.  The light colors are premultiplied by the
+ material's diffuse and specular colors, so lighting a point only has to
+ scale them by the attenuation and angle terms.  If the shininess is a
+ small whole number, specPower holds it and the specular term is raised to
+ it by multiplication.  Otherwise specPower is -1.
+*/
+typedef struct _lightingContext {
+    float               eyeX;
+    float               eyeY;
+    float               eyeZ;
+    rgb                 ambient;
+    float               shininess;
+    int                 specPower;
+
+    std::vector<float>  x;
+    std::vector<float>  y;
+    std::vector<float>  z;
+    std::vector<float>  attenuation;
+    std::vector<float>  diffuseR;
+    std::vector<float>  diffuseG;
+    std::vector<float>  diffuseB;
+    std::vector<float>  specularR;
+    std::vector<float>  specularG;
+    std::vector<float>  specularB;
+
+    _lightingContext() : eyeX (0), eyeY (0), eyeZ (0), ambient (rgb()),
+        shininess (0), specPower (0), x (), y (), z (), attenuation (),
+        diffuseR (), diffuseG (), diffuseB (), specularR (), specularG (),
+        specularB () {}
+    ~_lightingContext() {}
+
+    int numLights() const { return x.size(); }
+
+    void prepare (const camera&, const std::vector<light>&, rgb, rgb, rgb,
+        float);
+} lightingContext;
+
 #endif // ifndef LIGHT
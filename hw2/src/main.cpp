@@ -3,14 +3,35 @@
  main.cpp
 
  Main loop for HW2.  This reads from the command line a file, x and y
- resolutions and an algorithm code.  Then, it draws the image and outputs in
- PPM format.
+ resolutions and an algorithm code, followed by any options.  Then, it draws
+ the image and outputs in PPM format.  The algorithm code is 0 for Gouraud
+ shading, 1 for Phong shading or 2 for deferred Phong shading, which draws
+ the same image as Phong but lights each pixel once, after every facet has
+ been rastered.
+
+ Options:
+    -b          Raster with the tile-binned, multithreaded rasterizer
+    -j <int>    Number of threads the binned rasterizer, deferred lighting
+                and batch rendering use (default is one per core)
+    -s <level>  Widest vector instructions to raster with, one of scalar,
+                sse2 or avx2 (default is the widest the CPU supports)
+    -B <int>    Instead of outputting the image, raster it this many times
+                with each rasterizer and print how long each took
+    -o <file>   Write the image to this file instead of standard output, or
+                with -F, start each frame's file name with this
+    -f <fmt>    PPM encoding to write, p3 (ASCII, the default) or p6 (binary)
+    -r          With -b, write each band of rows as soon as it is rastered
+                rather than once the whole image is done
+    -F <file>   Render every frame listed in this file, each to its own
+                file, instead of one image
 
  Author: Tim Menninger
 
 ******************************************************************************/
 #include "parseScene.h"
 #include "image.h"
+#include "bench.h"
+#include "batch.h"
 #include "geom.h"
 #include "light.h"
 
@@ -20,12 +41,52 @@
 using namespace std;
 
 int main(int argc, char **argv) {
-    if (argc != 5) {
-        cout << "usage: ./shaded [file] [yres] [xres] [mode]" << endl;
+    if (argc < 5) {
+        cout << "usage: ./shaded [file] [yres] [xres] [mode] [-b] [-j threads]"
+                " [-s scalar|sse2|avx2] [-B frames] [-o file] [-f p3|p6]"
+                " [-r] [-F frames]" << endl;
         return 1;
     }
     int xres = atoi(argv[2]), yres = atoi(argv[3]), mode = atoi(argv[4]);
 
+    // Any remaining arguments are options
+    bool binned = false;
+    int nThreads = 0;
+    simdLevel simd = detectSIMD();
+    int benchFrames = 0;
+    const char *outFile = NULL;
+    ppmFormat format = PPMAscii;
+    bool streamRows = false;
+    char *frameFile = NULL;
+    for (int i = 5; i < argc; ++i) {
+        string opt(argv[i]);
+        if (opt == "-b") {
+            binned = true;
+        } else if (opt == "-j" && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        } else if (opt == "-s" && i + 1 < argc) {
+            string level(argv[++i]);
+            simdLevel requested = level == "avx2" ? SIMDAVX2 :
+                (level == "sse2" ? SIMDSSE2 : SIMDNone);
+            // Never use instructions the CPU does not have
+            simd = requested < simd ? requested : simd;
+        } else if (opt == "-B" && i + 1 < argc) {
+            benchFrames = atoi(argv[++i]);
+        } else if (opt == "-o" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (opt == "-f" && i + 1 < argc) {
+            string fmt(argv[++i]);
+            format = fmt == "p6" ? PPMBinary : PPMAscii;
+        } else if (opt == "-r") {
+            streamRows = true;
+        } else if (opt == "-F" && i + 1 < argc) {
+            frameFile = argv[++i];
+        } else {
+            cout << opt << " is not a valid option" << endl;
+            return 1;
+        }
+    }
+
     shading alg;
     // Determine which algorithm to use.
     switch (mode) {
@@ -35,6 +96,9 @@ int main(int argc, char **argv) {
         case 1:
             alg = Phong;
             break;
+        case 2:
+            alg = DeferredPhong;
+            break;
         default:
             cout << mode << " does not match an algorithm" << endl;
             return 1;
@@ -45,13 +109,43 @@ int main(int argc, char **argv) {
     vector<light> lights;
     vector<string> order;
     map<string, shape3D*> originals;
-    vector<shape3D> copies;
+    instanceList instances;
     int status = parseScene(argv[1], &cam, &lights,
-        &order, &originals, &copies);
-    // Create the shaded model
+        &order, &originals, &instances);
+
+    // Compare the rasterizers instead of drawing the image if asked to
+    if (benchFrames > 0) {
+        return benchRaster(&instances, cam, lights, alg, xres, yres,
+            MAX_INTENSITY, benchFrames);
+    }
+
+    // Render every frame of a batch to its own file if asked to, in which
+    // case -o names the start of each file
+    if (frameFile) {
+        vector<frameSpec> frames;
+        if (parseFrames(frameFile, &frames))
+            return 1;
+        return renderBatch(&instances, cam, lights, alg, &frames, xres, yres,
+            MAX_INTENSITY, BKG_COLOR, simd, nThreads, format,
+            outFile ? outFile : "frame");
+    }
+
+    ppmWriter out;
+    if (out.open(outFile, format, xres, yres, MAX_INTENSITY))
+        return 1;
+
+    // Create the shaded model.  The binned rasterizer can write rows out as
+    // they are finished, otherwise the image is written once it is done.
     image im(xres, yres, MAX_INTENSITY, BKG_COLOR);
-    im.rasterShapes(&copies, cam, lights, alg);
-    im.outputPPM();
+    im.simd = simd;
+    if (binned) {
+        im.rasterInstancesBinned(&instances, cam, lights, alg, nThreads,
+            streamRows ? &out : NULL);
+    } else {
+        im.rasterInstances(&instances, cam, lights, alg, nThreads);
+    }
+    if (!binned || !streamRows)
+        im.outputPPM(&out);
 
-    return 0;
+    return out.close();
 }
@@ -0,0 +1,57 @@
+/******************************************************************************
+
+ meshSoA.h
+
+ Contains meshSoA struct
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef MESHSOA
+#define MESHSOA
+
+#include <vector>
+
+#include "geom.h"
+#include "vertex.h"
+#include "normal.h"
+
+// Structs
+/*
+ meshSoA
+
+ The vertex positions and normals of a mesh, stored as a separate array for
+ each component.  A pass over the mesh that only needs positions reads 12
+ bytes per vertex instead of a whole vertex struct, and four or eight
+ vertices can be loaded into a vector register at once.  It is indexed the
+ same way as the vertices and normals of a shape3D, including the dummy
+ entries at index 0.
+*/
+typedef struct _meshSoA {
+    std::vector<float>  x;
+    std::vector<float>  y;
+    std::vector<float>  z;
+    std::vector<float>  nx;
+    std::vector<float>  ny;
+    std::vector<float>  nz;
+
+    _meshSoA() : x (), y (), z (), nx (), ny (), nz () {}
+    ~_meshSoA() {}
+
+    void resize(int nVertices, int nNormals) {
+        x.resize(nVertices);
+        y.resize(nVertices);
+        z.resize(nVertices);
+        nx.resize(nNormals);
+        ny.resize(nNormals);
+        nz.resize(nNormals);
+    }
+    int numVertices() const { return x.size(); }
+    int numNormals() const { return nx.size(); }
+
+    vertex vertexAt(int i) const { return vertex(x[i], y[i], z[i]); }
+    point3D pointAt(int i) const { return point3D(x[i], y[i], z[i]); }
+    normal normalAt(int i) const { return normal(nx[i], ny[i], nz[i]); }
+} meshSoA;
+
+#endif // ifndef MESHSOA
@@ -3,7 +3,9 @@
  objParser.cpp
 
  Parses OBJ files and creates a shape object containing a vector of its
- vertices and faces.
+ vertices and faces.  The files themselves are read by the OBJ loader
+ shared by every assignment, which maps a binary cache kept next to each
+ file instead of parsing the file again on every run.
 
  Usage: ./objParser
 
@@ -18,12 +20,10 @@ using namespace std;
 /*
  parseObjFile
 
- Opens the argued OBJ file and creates a vertex for every vertex and a facet
- for every face in the file.  This assumes that the OBJ file is such that
- every line either contains v <float> <float> <float> or f <int> <int> <int>.
- If this is not the case, the behavior is undefined.  It then writes the
- contents to the argued output file with the name of the input file ahead
- of it.
+ Loads the argued OBJ file with the shared OBJ loader and creates a vertex
+ for every vertex, a normal for every normal and a facet for every face in
+ the file.  Faces are expected to give a vertex and a normal for each
+ corner, as in v//n.
 
  Arguments: char *filename - The name of the OBJ file to read
             shape3D *shape - The output shape
@@ -40,60 +40,36 @@ int parseObjFile
     // Set the filename
     string fn(filename);
     shape->name = fn.substr(0, fn.length()-FEXT_LEN);
-    // Open the file
-    ifstream inFile(fn);
-    if (!inFile.is_open()) {
-        cout << "unable to open " << fn << endl;
+
+    objMeshView mesh;
+    if (mesh.open(fn))
         return 1;
-    }
 
     // To make facets easier, put an empty vertex at beginning of vertices
     //    so we can one-index them.   Same for surface normals
     shape->clear();
 
-    // Instantiate a vertex and facet to fill before each push_back
-    vertex ver;
-    facet fac;
-    normal vn;
-
-    // The string buffer that will be read
-    string line;
-    // Read each line and create an element
-    while (getline(inFile, line)) {
-        // Split the space-separated line into a vector of strings
-        vector<string> vals;
-        string temp;
-        stringstream s(line);
-        while (s >> temp)
-            vals.push_back(temp);
-
-        // Handle the line according to its identifier (vertex or facet)
-        if (vals[0] == "v") {
-            // Is a vertex -- vals contains 'v' then 3 floats
-            ver = vertex(stof(vals[1]), stof(vals[2]), stof(vals[3]));
-            shape->vertices.push_back(ver);
-        } else if (vals[0] == "vn") {
-            vn = normal(stof(vals[1]), stof(vals[2]), stof(vals[3]));
-            shape->normals.push_back(vn);
-        } else if (vals[0] == "f") {
-            int vertices[3];
-            int normals[3];
-            // Is a facet -- vals contains 'f' then 3 ints//int values
-            for (int i = 0; i < 3; ++i) {
-                int delimiterIdx = vals[i+1].find("//");
-                vertices[i] = stoi(vals[i+1].substr(0, delimiterIdx));
-                normals[i] = stoi(vals[i+1].substr(delimiterIdx+2));
-            }
-            fac = facet(vertices[0], vertices[1], vertices[2],
-                        normals[0], normals[1], normals[2]);
-            shape->facets.push_back(fac);
-        } else {
-            cout << "error parsing " << fn << endl;
-            inFile.close();
-            return 1;
-        }
-    }
-    inFile.close();
+    int nVertices = mesh.numPositions();
+    int nNormals = mesh.numNormals();
+    int nFacets = mesh.numTriangles();
+    shape->vertices.reserve(nVertices + 1);
+    shape->normals.reserve(nNormals + 1);
+    shape->facets.reserve(nFacets);
+
+    const float *p = mesh.positions;
+    for (int i = 0; i < nVertices; ++i, p += 3)
+        shape->vertices.push_back(vertex(p[0], p[1], p[2]));
+    const float *n = mesh.normals;
+    for (int i = 0; i < nNormals; ++i, n += 3)
+        shape->normals.push_back(normal(n[0], n[1], n[2]));
+    const int *cv = mesh.faceV;
+    const int *cn = mesh.faceN;
+    for (int i = 0; i < nFacets; ++i, cv += 3, cn += 3)
+        shape->facets.push_back(facet(cv[0], cv[1], cv[2],
+            cn[0], cn[1], cn[2]));
+
+    // Keep a copy of the mesh for the vectorized transform
+    shape->updateSoA();
 
     return 0;
 }
@@ -24,6 +24,7 @@
 #include "normal.h"
 #include "light.h"
 #include "shape3d.h"
+#include "meshCache.h"
 
 
 #define FEXT_LEN        4         // Number of characters in OBJ file extension
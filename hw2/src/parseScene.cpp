@@ -35,18 +35,18 @@ using namespace Eigen;
             [  0   0   0   1 ]
 
  Arguments: ifstream *openFile - The file being read
-            vector<MatrixXd> *ptMatrices - The matrices created from the
+            matrixList *ptMatrices - The matrices created from the
                 instructions in the file.
-            vector<MatrixXd> *normMatrices - All matrices from the file
-                that aren't translations, to be used on normals
+            matrixList *normMatrices - All matrices from the file that
+                aren't translations, to be used on normals
 
  Returns:   (int) - Zero if successful, nonzero otherwise.
 */
 int generateMatrix
 (
     ifstream            *openFile,
-    vector<MatrixXd>    *ptMatrices,
-    vector<MatrixXd>    *normMatrices
+    matrixList          *ptMatrices,
+    matrixList          *normMatrices
 )
 {
     assert(openFile);
@@ -61,7 +61,7 @@ int generateMatrix
     // Read each line and create an element
     while (getline(*openFile, line)) {
         // Will be the matrix that is added next
-        MatrixXd m(4, 4);
+        Matrix4f m;
 
         // Generate the matrix from the instruction on this line
         if (generateTransform(line, &m) == 0)
@@ -253,24 +253,25 @@ void getLightSources
 }
 
 /*
- getTransformedShapes
+ getInstances
 
  Takes a file and parses it for transformations to be done on shapes.  It
- creates the appropriate matrices and applies the transforms onto copies of
- the original objects.
+ creates the appropriate matrices and, for each block, an instance of the
+ original object with those transformations and its own material.  The
+ instance refers to the original object's geometry rather than copying it.
 
  Arguments: ifstream *inFile - The file to parse
             map<string, shape3D*> - Maps object names to their objects so we
-                know which object to modify during parsing
-            vector<shape3D> *out - Filled with transformed shapes
+                know which object to instance during parsing
+            instanceList *out - Filled with the instances
 
  Returns:   Nothing.
 */
-void getTransformedShapes
+void getInstances
 (
     ifstream                        *inFile,
     map<string, shape3D*>           *originals,
-    vector<shape3D>                 *out
+    instanceList                    *out
 )
 {
     // The next sets of lines each describe a transformation on an object,
@@ -278,11 +279,9 @@ void getTransformedShapes
     string line;
     vector<string> vals;
     while (getline(*inFile, line)) {
-        // Create the empty shape and give it an approprate name
+        // Create the instance and give it an approprate name
         string objName = line.substr(0, line.length());
-        shape3D newShape = *(*originals)[objName];
-        // Give the name and copy number to the new shape
-        newShape.name = objName + "_copy";
+        instance inst(objName + "_copy", (*originals)[objName]);
 
         // The material of the shape, which we will then insert
         material mat;
@@ -301,21 +300,18 @@ void getTransformedShapes
         vals = getSpaceDelimitedWords(line);
         mat.shininess = stof(vals[1]);
 
-        // Insert the material into the shape
-        newShape.mat = mat;
+        // Insert the material into the instance
+        inst.mat = mat;
 
         // Create a transformation matrix from the instructions
-        MatrixXd ptTransMatrix = MatrixXd::Identity(4, 4);
-        MatrixXd normTransMatrix = MatrixXd::Identity(4, 4);
-        vector<MatrixXd> ptMatrices;
-        vector<MatrixXd> normMatrices;
+        matrixList ptMatrices;
+        matrixList normMatrices;
         generateMatrix(inFile, &ptMatrices, &normMatrices);
-        transformMatrix(&newShape.ptTransform, &ptMatrices);
-        transformMatrix(&newShape.normTransform, &normMatrices);
-        normTransMatrix = normTransMatrix.inverse().transpose();
+        transformMatrix(&inst.ptTransform, &ptMatrices);
+        transformMatrix(&inst.normTransform, &normMatrices);
 
-        // Add the shape to the output
-        out->push_back(newShape);
+        // Add the instance to the output
+        out->push_back(inst);
     }
 }
 
@@ -327,8 +323,8 @@ void getTransformedShapes
  an empty line, then a set of transformations.  Each transformation is
  separated by an empty line and has the form of <shape_name>\n<transformations>
  with each transformation on a new line.  It fills a vector with the order
- objects were read, a map of names to original objects, and a map of names
- to a vector of copies of that original object.  The file argued should have
+ objects were read, a map of names to original objects, and a vector of
+ instances of those objects.  The file argued should have
  the form:
     camera:
     position <float x> <float y> <float z>
@@ -366,8 +362,8 @@ void getTransformedShapes
                 read.
             map<string, shape3D*> *originals - Maps object names to the
                 object definition.
-            map<string, vector<shape3D> > *out - Maps object names to a
-                vector of its transformed copies.
+            instanceList *out - Filled with an instance of an original
+                object for each transformation block, in order.
 
  Returns:   (int) - 0 if successful, nonzero otherwise
 */
@@ -378,7 +374,7 @@ int parseScene
     vector<light>                   *lights,
     vector<string>                  *order,
     map<string, shape3D*>           *originals,
-    vector<shape3D>                 *out
+    instanceList                    *out
 )
 {
     assert(filename);
@@ -403,8 +399,8 @@ int parseScene
     // The next line(s) are objects and names for those objects
     getOriginalShapes(&inFile, order, originals);
 
-    // The next line(s) are shapes to copy and transformations to do
-    getTransformedShapes(&inFile, originals, out);
+    // The next line(s) are shapes to instance and transformations to do
+    getInstances(&inFile, originals, out);
 
     return 0;
 }
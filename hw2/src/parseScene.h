@@ -18,10 +18,11 @@
 #include "transform.h"
 #include "camera.h"
 #include "light.h"
+#include "instance.h"
 
 #define OBJ_DIR "data/"
 
 // Externally public functions
-int parseScene (char*, camera*, std::vector<light>*, std::vector<std::string>*, std::map<std::string, shape3D*>*, std::vector<shape3D>*);
+int parseScene (char*, camera*, std::vector<light>*, std::vector<std::string>*, std::map<std::string, shape3D*>*, instanceList*);
 
 #endif // ifndef PARSESCENE
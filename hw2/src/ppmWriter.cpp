@@ -0,0 +1,139 @@
+/******************************************************************************
+
+ ppmWriter.cpp
+
+ Contains methods for writing images in PPM format.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <iostream>
+#include <assert.h>
+
+#include "ppmWriter.h"
+
+using namespace std;
+
+/*
+ ppmWriter::open
+
+ Opens the file to write to and writes the PPM header.
+
+ Arguments: const char *filename - The file to write to, or NULL to write to
+                standard output
+            ppmFormat format - Whether to write P3 or P6
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            int intensity - Max intensity of any one pixel color.  This
+                cannot exceed 255.
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int ppmWriter::open
+(
+    const char          *filename,
+    ppmFormat           format,
+    int                 xres,
+    int                 yres,
+    int                 intensity
+)
+{
+    this->close();
+
+    if (filename) {
+        this->out = fopen(filename, "wb");
+        if (!this->out) {
+            cout << "unable to open " << filename << endl;
+            return 1;
+        }
+        this->ownsFile = true;
+    } else {
+        // Anything already written to cout must come out before the image
+        cout.flush();
+        this->out = stdout;
+        this->ownsFile = false;
+    }
+
+    this->format = format;
+    this->xres = xres;
+    this->yres = yres;
+
+    // A P3 sample is at most 3 digits and a space or newline
+    this->row.resize(format == PPMBinary ? 3 * xres : 12 * xres);
+
+    // Required PPM header, then x and y resolutions and max intensity
+    fprintf(this->out, "%s\n%d %d\n%d\n", format == PPMBinary ? "P6" : "P3",
+        xres, yres, intensity);
+
+    return 0;
+}
+
+/*
+ ppmWriter::writeRow
+
+ Writes one row of the image.  Colors are RGBA with red in the most
+ significant byte.  In P3, every pixel is written on its own line with its
+ samples separated by spaces.
+
+ Arguments: const uint32_t *colors - The xres colors of the row
+
+ Returns:   Nothing.
+*/
+void ppmWriter::writeRow
+(
+    const uint32_t      *colors
+)
+{
+    assert(this->out);
+    assert(colors);
+
+    char *p = &this->row[0];
+    if (this->format == PPMBinary) {
+        for (int x = 0; x < this->xres; ++x) {
+            *p++ = colors[x] >> 24;
+            *p++ = colors[x] >> 16;
+            *p++ = colors[x] >> 8;
+        }
+    } else {
+        for (int x = 0; x < this->xres; ++x) {
+            for (int i = 3; i > 0; --i) {
+                // Write the sample's digits without leading zeros
+                unsigned int sample = (colors[x] >> (i * 8)) & 255;
+                if (sample >= 100)
+                    *p++ = '0' + sample / 100;
+                if (sample >= 10)
+                    *p++ = '0' + sample / 10 % 10;
+                *p++ = '0' + sample % 10;
+                *p++ = i == 1 ? '\n' : ' ';
+            }
+        }
+    }
+
+    fwrite(&this->row[0], 1, p - &this->row[0], this->out);
+}
+
+/*
+ ppmWriter::close
+
+ Flushes everything written and closes the file if the writer opened one.
+
+ Arguments: None.
+
+ Returns:   (int) - 0 if everything was written successfully, nonzero
+                otherwise
+*/
+int ppmWriter::close
+(
+)
+{
+    if (!this->out)
+        return 0;
+
+    int status = fflush(this->out) != 0 || ferror(this->out);
+    if (this->ownsFile)
+        status |= fclose(this->out) != 0;
+    this->out = NULL;
+    this->ownsFile = false;
+
+    return status;
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+
+ ppmWriter.h
+
+ Contains ppmWriter struct
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef PPMWRITER
+#define PPMWRITER
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+// Enums
+/*
+ ppmFormat
+
+ The two encodings of a PPM image.  P3 writes every sample as decimal text
+ and P6 writes every sample as a single byte.
+*/
+typedef enum _ppmFormat {
+    PPMAscii,
+    PPMBinary,
+} ppmFormat;
+
+// Structs
+/*
+ ppmWriter
+
+ Writes an image in PPM format to a file or to standard output one row at a
+ time.  Each row is formatted into a buffer and written with a single call,
+ so nothing is flushed per pixel.  Rows must be written from the top of the
+ image down.
+*/
+typedef struct _ppmWriter {
+    FILE                *out;
+    bool                ownsFile;
+    ppmFormat           format;
+    int                 xres;
+    int                 yres;
+    std::vector<char>   row;
+
+    _ppmWriter() : out (NULL), ownsFile (false), format (PPMAscii), xres (0),
+        yres (0), row () {}
+    ~_ppmWriter() { close(); }
+
+    int open (const char*, ppmFormat, int, int, int);
+    void writeRow (const uint32_t*);
+    int close ();
+} ppmWriter;
+
+#endif // ifndef PPMWRITER
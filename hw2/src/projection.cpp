@@ -20,9 +20,9 @@ using namespace Eigen;
  projects them all onto NDC.
 
  Arguments: camera cam - The camera view parameters
-            vector<shape3D> *shapes - A vector of original shapes that
+            shapeList *shapes - A vector of original shapes that
                 will be transformed.
-            vector<shape3D> *NDCShapes - An output vector of all of the shapes
+            shapeList *NDCShapes - An output vector of all of the shapes
                 from the map, projected onto NDC
 
  Returns:   Nothing.
@@ -30,12 +30,12 @@ using namespace Eigen;
 void worldToCartNDC
 (
     camera                          cam,
-    vector<shape3D>                 *shapes,
-    vector<shape3D>                 *NDCShapes
+    shapeList                       *shapes,
+    shapeList                       *NDCShapes
 )
 {
     // Convert each shape to NDC
-    vector<shape3D>::iterator s = shapes->begin();
+    shapeList::iterator s = shapes->begin();
     for (; s != shapes->end(); ++s) {
         shape3D proj;
 
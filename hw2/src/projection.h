@@ -22,6 +22,6 @@
 #include "light.h"
 #include "shape3d.h"
 
-void worldToCartNDC (camera, std::vector<shape3D>*, std::vector<shape3D>*);
+void worldToCartNDC (camera, shapeList*, shapeList*);
 
 #endif // ifndef PERSPECTIVE
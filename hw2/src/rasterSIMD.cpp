@@ -0,0 +1,552 @@
+/******************************************************************************
+
+ rasterSIMD.cpp
+
+ Contains the vector rasterizer, which tests coverage and depth for a block
+ of pixels in a row at once.  AVX2 rasters 8x1 blocks and SSE2 rasters 4x1
+ blocks.  Every operation is done in the same order as in the scalar
+ rasterizer in image.cpp, so both produce identical images.  Pixels left over
+ at the end of a row that do not fill a block are handed to the scalar code.
+ Also contains the vector fill used to clear the color and depth buffers.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include "image.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
+using namespace std;
+
+/*
+ detectSIMD
+
+ Asks the CPU which vector instruction sets it supports.
+
+ Arguments: None.
+
+ Returns:   (simdLevel) - The widest instruction set the rasterizer can use
+*/
+simdLevel detectSIMD
+(
+)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SIMDAVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMDSSE2;
+#endif
+    return SIMDNone;
+}
+
+#ifdef HAVE_X86_SIMD
+
+/*
+ fillAVX2
+
+ Fills a buffer 32 bytes at a time.
+
+ Arguments: uint32_t *dst - The buffer, which starts on a 32 byte boundary
+            size_t n - Number of pixels in the buffer
+            uint32_t value - The value to fill every pixel with
+
+ Returns:   Nothing.
+*/
+__attribute__((target("avx2")))
+static void fillAVX2
+(
+    uint32_t            *dst,
+    size_t              n,
+    uint32_t            value
+)
+{
+    __m256i v = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_store_si256((__m256i *) (dst + i), v);
+    for (; i < n; ++i)
+        dst[i] = value;
+}
+
+/*
+ fillSSE2
+
+ Fills a buffer 16 bytes at a time.
+
+ Arguments: uint32_t *dst - The buffer, which starts on a 16 byte boundary
+            size_t n - Number of pixels in the buffer
+            uint32_t value - The value to fill every pixel with
+
+ Returns:   Nothing.
+*/
+static void fillSSE2
+(
+    uint32_t            *dst,
+    size_t              n,
+    uint32_t            value
+)
+{
+    __m128i v = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_store_si128((__m128i *) (dst + i), v);
+    for (; i < n; ++i)
+        dst[i] = value;
+}
+
+#endif // ifdef HAVE_X86_SIMD
+
+/*
+ fillPixels
+
+ Fills a buffer of pixels with one value, using the widest allowed vector
+ instruction set.
+
+ Arguments: simdLevel simd - The widest instruction set to use
+            uint32_t *dst - The buffer, which starts on a ROW_ALIGN boundary
+            size_t n - Number of pixels in the buffer
+            uint32_t value - The value to fill every pixel with
+
+ Returns:   Nothing.
+*/
+void fillPixels
+(
+    simdLevel           simd,
+    uint32_t            *dst,
+    size_t              n,
+    uint32_t            value
+)
+{
+    assert(dst);
+
+#ifdef HAVE_X86_SIMD
+    if (simd == SIMDAVX2) {
+        fillAVX2(dst, n, value);
+        return;
+    }
+    if (simd == SIMDSSE2) {
+        fillSSE2(dst, n, value);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = value;
+}
+
+#ifdef HAVE_X86_SIMD
+
+/*
+ shadeLanes
+
+ Colors the pixels of a block whose lanes passed the depth test by calling
+ the scalar shading code on each of them.  Used for Phong shading, which is
+ not vectorized, and deferred Phong shading, where the G-buffer is filled
+ instead.
+
+ Arguments: image *im - The image being rastered
+            rasterFacet *rf - The facet being rastered
+            int y - Row of the block
+            int x - Column of the first pixel in the block
+            int mask - Bit i is set if lane i passed the depth test
+            float *alpha - Barycentric coordinates of v1, one per lane
+            float *beta - Barycentric coordinates of v2, one per lane
+            float *gamma - Barycentric coordinates of v3, one per lane
+            int maxIntensity - Scale of the output colors
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   Nothing.
+*/
+static void shadeLanes
+(
+    image               *im,
+    rasterFacet         *rf,
+    int                 y,
+    int                 x,
+    int                 mask,
+    float               *alpha,
+    float               *beta,
+    float               *gamma,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    for (int i = 0; mask != 0; ++i, mask >>= 1) {
+        if (mask & 1) {
+            im->writeFragment(rf, x + i, y, alpha[i], beta[i], gamma[i],
+                maxIntensity, alg);
+        }
+    }
+}
+
+/*
+ rasterRegionSSE2
+
+ Rasters a rectangle of a facet four pixels at a time using SSE2.  See
+ image::rasterRegionSIMD for arguments and return value.
+*/
+static int rasterRegionSSE2
+(
+    image               *im,
+    rasterFacet         *rf,
+    int                 x0,
+    int                 y0,
+    int                 x1,
+    int                 y1,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    edgeFunction *e1 = &rf->e1, *e2 = &rf->e2, *e3 = &rf->e3;
+
+    // Per lane offsets of each edge function from the first lane, and how
+    // far each edge function steps from one block to the next
+    int a1 = e1->a, a2 = e2->a, a3 = e3->a;
+    __m128i lane1 = _mm_setr_epi32(0, a1, 2*a1, 3*a1);
+    __m128i lane2 = _mm_setr_epi32(0, a2, 2*a2, 3*a2);
+    __m128i lane3 = _mm_setr_epi32(0, a3, 2*a3, 3*a3);
+    __m128i step1 = _mm_set1_epi32(4*a1);
+    __m128i step2 = _mm_set1_epi32(4*a2);
+    __m128i step3 = _mm_set1_epi32(4*a3);
+    __m128i bias1 = _mm_set1_epi32(e1->bias);
+    __m128i bias2 = _mm_set1_epi32(e2->bias);
+    __m128i bias3 = _mm_set1_epi32(e3->bias);
+
+    __m128 invArea = _mm_set1_ps(rf->invArea);
+    __m128 z1 = _mm_set1_ps(rf->v1NDC.z);
+    __m128 z2 = _mm_set1_ps(rf->v2NDC.z);
+    __m128 z3 = _mm_set1_ps(rf->v3NDC.z);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 depthMax = _mm_set1_ps(DEPTH_MAX);
+    __m128 nearZ = _mm_set1_ps(-1);
+    __m128 farZ = _mm_set1_ps(1);
+    __m128i allSet = _mm_set1_epi32(-1);
+    __m128i signFlip = _mm_set1_epi32(0x80000000);
+
+    // Vertex colors for Gouraud shading
+    __m128 r1 = _mm_set1_ps(rf->v1NDC.c.r), r2 = _mm_set1_ps(rf->v2NDC.c.r);
+    __m128 r3 = _mm_set1_ps(rf->v3NDC.c.r), g1 = _mm_set1_ps(rf->v1NDC.c.g);
+    __m128 g2 = _mm_set1_ps(rf->v2NDC.c.g), g3 = _mm_set1_ps(rf->v3NDC.c.g);
+    __m128 b1 = _mm_set1_ps(rf->v1NDC.c.b), b2 = _mm_set1_ps(rf->v2NDC.c.b);
+    __m128 b3 = _mm_set1_ps(rf->v3NDC.c.b);
+    __m128 scale = _mm_set1_ps(maxIntensity);
+    __m128i alphaChannel = _mm_set1_epi32((int) (1.0f * maxIntensity));
+
+    float alpha[4], beta[4], gamma[4];
+    int written = 0;
+
+    int64_t w1Row = e1->at(x0, y0) - e1->bias;
+    int64_t w2Row = e2->at(x0, y0) - e2->bias;
+    int64_t w3Row = e3->at(x0, y0) - e3->bias;
+
+    for (int y = y0; y < y1; ++y, w1Row += e1->b, w2Row += e2->b,
+                                  w3Row += e3->b) {
+        uint32_t *colorRow = im->colors[y];
+        uint32_t *depthRow = im->depths[y];
+
+        __m128i w1 = _mm_add_epi32(_mm_set1_epi32((int) w1Row), lane1);
+        __m128i w2 = _mm_add_epi32(_mm_set1_epi32((int) w2Row), lane2);
+        __m128i w3 = _mm_add_epi32(_mm_set1_epi32((int) w3Row), lane3);
+
+        int x = x0;
+        for (; x + 4 <= x1; x += 4, w1 = _mm_add_epi32(w1, step1),
+                                    w2 = _mm_add_epi32(w2, step2),
+                                    w3 = _mm_add_epi32(w3, step3)) {
+            // Coverage, a lane is inside if no edge function is negative
+            __m128i all = _mm_or_si128(_mm_or_si128(w1, w2), w3);
+            __m128i inside = _mm_cmpgt_epi32(all, allSet);
+            if (_mm_movemask_epi8(inside) == 0)
+                continue;
+
+            // Barycentric coordinates and depth
+            __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(w1, bias1)),
+                invArea);
+            __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(w2, bias2)),
+                invArea);
+            __m128 g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(w3, bias3)),
+                invArea);
+            __m128 zv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, z1),
+                _mm_mul_ps(b, z2)), _mm_mul_ps(g, z3));
+
+            // Discard lanes outside of the near and far planes
+            __m128 clipped = _mm_or_ps(_mm_cmplt_ps(zv, nearZ),
+                _mm_cmpgt_ps(zv, farZ));
+
+            // Depth test, using a signed compare on values with the sign bit
+            // flipped to get an unsigned compare
+            __m128i depth = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(
+                _mm_mul_ps(zv, half), half), depthMax));
+            __m128i old = _mm_loadu_si128((__m128i *) (depthRow + x));
+            __m128i behind = _mm_cmpgt_epi32(_mm_xor_si128(depth, signFlip),
+                _mm_xor_si128(old, signFlip));
+
+            __m128i pass = _mm_andnot_si128(_mm_or_si128(behind,
+                _mm_castps_si128(clipped)), inside);
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(pass));
+            if (mask == 0)
+                continue;
+            written += __builtin_popcount(mask);
+
+            // Write depths through the lane mask
+            _mm_storeu_si128((__m128i *) (depthRow + x), _mm_or_si128(
+                _mm_and_si128(pass, depth), _mm_andnot_si128(pass, old)));
+
+            if (alg == Gouraud) {
+                // Interpolate and pack the colors the way rgb::toUInt32 does
+                __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, r1),
+                    _mm_mul_ps(b, r2)), _mm_mul_ps(g, r3));
+                __m128 gr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, g1),
+                    _mm_mul_ps(b, g2)), _mm_mul_ps(g, g3));
+                __m128 bl = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, b1),
+                    _mm_mul_ps(b, b2)), _mm_mul_ps(g, b3));
+                __m128i color = _mm_cvttps_epi32(_mm_mul_ps(r, scale));
+                color = _mm_add_epi32(_mm_slli_epi32(color, 8),
+                    _mm_cvttps_epi32(_mm_mul_ps(gr, scale)));
+                color = _mm_add_epi32(_mm_slli_epi32(color, 8),
+                    _mm_cvttps_epi32(_mm_mul_ps(bl, scale)));
+                color = _mm_add_epi32(_mm_slli_epi32(color, 8),
+                    alphaChannel);
+
+                __m128i oldColor = _mm_loadu_si128((__m128i *)
+                    (colorRow + x));
+                _mm_storeu_si128((__m128i *) (colorRow + x), _mm_or_si128(
+                    _mm_and_si128(pass, color),
+                    _mm_andnot_si128(pass, oldColor)));
+            } else {
+                _mm_storeu_ps(alpha, a);
+                _mm_storeu_ps(beta, b);
+                _mm_storeu_ps(gamma, g);
+                shadeLanes(im, rf, y, x, mask, alpha, beta, gamma,
+                    maxIntensity, alg);
+            }
+        }
+
+        // Finish whatever is left of the row one pixel at a time
+        if (x < x1) {
+            int64_t dx = x - x0;
+            written += im->rasterSpan(rf, y, x, x1, w1Row + dx*e1->a,
+                w2Row + dx*e2->a, w3Row + dx*e3->a, maxIntensity, alg);
+        }
+    }
+
+    return written;
+}
+
+/*
+ rasterRegionAVX2
+
+ Rasters a rectangle of a facet eight pixels at a time using AVX2.  See
+ image::rasterRegionSIMD for arguments and return value.
+*/
+__attribute__((target("avx2")))
+static int rasterRegionAVX2
+(
+    image               *im,
+    rasterFacet         *rf,
+    int                 x0,
+    int                 y0,
+    int                 x1,
+    int                 y1,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+    edgeFunction *e1 = &rf->e1, *e2 = &rf->e2, *e3 = &rf->e3;
+
+    // Per lane offsets of each edge function from the first lane, and how
+    // far each edge function steps from one block to the next
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i lane1 = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(e1->a));
+    __m256i lane2 = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(e2->a));
+    __m256i lane3 = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(e3->a));
+    __m256i step1 = _mm256_set1_epi32(8 * e1->a);
+    __m256i step2 = _mm256_set1_epi32(8 * e2->a);
+    __m256i step3 = _mm256_set1_epi32(8 * e3->a);
+    __m256i bias1 = _mm256_set1_epi32(e1->bias);
+    __m256i bias2 = _mm256_set1_epi32(e2->bias);
+    __m256i bias3 = _mm256_set1_epi32(e3->bias);
+
+    __m256 invArea = _mm256_set1_ps(rf->invArea);
+    __m256 z1 = _mm256_set1_ps(rf->v1NDC.z);
+    __m256 z2 = _mm256_set1_ps(rf->v2NDC.z);
+    __m256 z3 = _mm256_set1_ps(rf->v3NDC.z);
+    __m256 half = _mm256_set1_ps(0.5f);
+    __m256 depthMax = _mm256_set1_ps(DEPTH_MAX);
+    __m256 nearZ = _mm256_set1_ps(-1);
+    __m256 farZ = _mm256_set1_ps(1);
+    __m256i allSet = _mm256_set1_epi32(-1);
+    __m256i signFlip = _mm256_set1_epi32(0x80000000);
+
+    // Vertex colors for Gouraud shading
+    __m256 r1 = _mm256_set1_ps(rf->v1NDC.c.r);
+    __m256 r2 = _mm256_set1_ps(rf->v2NDC.c.r);
+    __m256 r3 = _mm256_set1_ps(rf->v3NDC.c.r);
+    __m256 g1 = _mm256_set1_ps(rf->v1NDC.c.g);
+    __m256 g2 = _mm256_set1_ps(rf->v2NDC.c.g);
+    __m256 g3 = _mm256_set1_ps(rf->v3NDC.c.g);
+    __m256 b1 = _mm256_set1_ps(rf->v1NDC.c.b);
+    __m256 b2 = _mm256_set1_ps(rf->v2NDC.c.b);
+    __m256 b3 = _mm256_set1_ps(rf->v3NDC.c.b);
+    __m256 scale = _mm256_set1_ps(maxIntensity);
+    __m256i alphaChannel = _mm256_set1_epi32((int) (1.0f * maxIntensity));
+
+    float alpha[8], beta[8], gamma[8];
+    int written = 0;
+
+    int64_t w1Row = e1->at(x0, y0) - e1->bias;
+    int64_t w2Row = e2->at(x0, y0) - e2->bias;
+    int64_t w3Row = e3->at(x0, y0) - e3->bias;
+
+    for (int y = y0; y < y1; ++y, w1Row += e1->b, w2Row += e2->b,
+                                  w3Row += e3->b) {
+        uint32_t *colorRow = im->colors[y];
+        uint32_t *depthRow = im->depths[y];
+
+        __m256i w1 = _mm256_add_epi32(_mm256_set1_epi32((int) w1Row), lane1);
+        __m256i w2 = _mm256_add_epi32(_mm256_set1_epi32((int) w2Row), lane2);
+        __m256i w3 = _mm256_add_epi32(_mm256_set1_epi32((int) w3Row), lane3);
+
+        int x = x0;
+        for (; x + 8 <= x1; x += 8, w1 = _mm256_add_epi32(w1, step1),
+                                    w2 = _mm256_add_epi32(w2, step2),
+                                    w3 = _mm256_add_epi32(w3, step3)) {
+            // Coverage, a lane is inside if no edge function is negative
+            __m256i all = _mm256_or_si256(_mm256_or_si256(w1, w2), w3);
+            __m256i inside = _mm256_cmpgt_epi32(all, allSet);
+            if (_mm256_testz_si256(inside, inside))
+                continue;
+
+            // Barycentric coordinates and depth
+            __m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(
+                _mm256_add_epi32(w1, bias1)), invArea);
+            __m256 b = _mm256_mul_ps(_mm256_cvtepi32_ps(
+                _mm256_add_epi32(w2, bias2)), invArea);
+            __m256 g = _mm256_mul_ps(_mm256_cvtepi32_ps(
+                _mm256_add_epi32(w3, bias3)), invArea);
+            __m256 zv = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, z1),
+                _mm256_mul_ps(b, z2)), _mm256_mul_ps(g, z3));
+
+            // Discard lanes outside of the near and far planes
+            __m256 clipped = _mm256_or_ps(_mm256_cmp_ps(zv, nearZ,
+                _CMP_LT_OQ), _mm256_cmp_ps(zv, farZ, _CMP_GT_OQ));
+
+            // Depth test, using a signed compare on values with the sign bit
+            // flipped to get an unsigned compare
+            __m256i depth = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(
+                _mm256_mul_ps(zv, half), half), depthMax));
+            __m256i old = _mm256_loadu_si256((__m256i *) (depthRow + x));
+            __m256i behind = _mm256_cmpgt_epi32(
+                _mm256_xor_si256(depth, signFlip),
+                _mm256_xor_si256(old, signFlip));
+
+            __m256i pass = _mm256_andnot_si256(_mm256_or_si256(behind,
+                _mm256_castps_si256(clipped)), inside);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(pass));
+            if (mask == 0)
+                continue;
+            written += __builtin_popcount(mask);
+
+            // Write depths through the lane mask
+            _mm256_storeu_si256((__m256i *) (depthRow + x),
+                _mm256_blendv_epi8(old, depth, pass));
+
+            if (alg == Gouraud) {
+                // Interpolate and pack the colors the way rgb::toUInt32 does
+                __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, r1),
+                    _mm256_mul_ps(b, r2)), _mm256_mul_ps(g, r3));
+                __m256 gr = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, g1),
+                    _mm256_mul_ps(b, g2)), _mm256_mul_ps(g, g3));
+                __m256 bl = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, b1),
+                    _mm256_mul_ps(b, b2)), _mm256_mul_ps(g, b3));
+                __m256i color = _mm256_cvttps_epi32(_mm256_mul_ps(r, scale));
+                color = _mm256_add_epi32(_mm256_slli_epi32(color, 8),
+                    _mm256_cvttps_epi32(_mm256_mul_ps(gr, scale)));
+                color = _mm256_add_epi32(_mm256_slli_epi32(color, 8),
+                    _mm256_cvttps_epi32(_mm256_mul_ps(bl, scale)));
+                color = _mm256_add_epi32(_mm256_slli_epi32(color, 8),
+                    alphaChannel);
+
+                __m256i oldColor = _mm256_loadu_si256((__m256i *)
+                    (colorRow + x));
+                _mm256_storeu_si256((__m256i *) (colorRow + x),
+                    _mm256_blendv_epi8(oldColor, color, pass));
+            } else {
+                _mm256_storeu_ps(alpha, a);
+                _mm256_storeu_ps(beta, b);
+                _mm256_storeu_ps(gamma, g);
+                shadeLanes(im, rf, y, x, mask, alpha, beta, gamma,
+                    maxIntensity, alg);
+            }
+        }
+
+        // Finish whatever is left of the row one pixel at a time
+        if (x < x1) {
+            int64_t dx = x - x0;
+            written += im->rasterSpan(rf, y, x, x1, w1Row + dx*e1->a,
+                w2Row + dx*e2->a, w3Row + dx*e3->a, maxIntensity, alg);
+        }
+    }
+
+    return written;
+}
+
+#endif // ifdef HAVE_X86_SIMD
+
+/*
+ image::rasterRegionSIMD
+
+ Rasters the part of a prepared facet that lies inside of a rectangle on the
+ image using the widest vector instructions allowed by this->simd.  The
+ rectangle must already be clamped to the facet's bounding box, and the facet
+ must be simdSafe.
+
+ Arguments: rasterFacet *rf - The prepared facet to raster
+            int x0 - Leftmost column of the rectangle
+            int y0 - Bottommost row of the rectangle
+            int x1 - One past the rightmost column of the rectangle
+            int y1 - One past the topmost row of the rectangle
+            int maxIntensity - The rgb values will be scaled from 0 to
+                this number.  This cannot exceed 255.
+            shading alg - Defines which algorithm to use when shading
+
+ Returns:   (int) - The number of pixels written
+*/
+int image::rasterRegionSIMD
+(
+    rasterFacet         *rf,
+    int                 x0,
+    int                 y0,
+    int                 x1,
+    int                 y1,
+    int                 maxIntensity,
+    shading             alg
+)
+{
+#ifdef HAVE_X86_SIMD
+    if (this->simd == SIMDAVX2) {
+        return rasterRegionAVX2(this, rf, x0, y0, x1, y1, maxIntensity,
+            alg);
+    }
+    if (this->simd == SIMDSSE2) {
+        return rasterRegionSSE2(this, rf, x0, y0, x1, y1, maxIntensity,
+            alg);
+    }
+#endif
+
+    // No vector instructions, so raster each row one pixel at a time
+    edgeFunction *e1 = &rf->e1, *e2 = &rf->e2, *e3 = &rf->e3;
+    int written = 0;
+    for (int y = y0; y < y1; ++y) {
+        int64_t dy = y - y0;
+        written += this->rasterSpan(rf, y, x0, x1,
+            e1->at(x0, y0) - e1->bias + dy*e1->b,
+            e2->at(x0, y0) - e2->bias + dy*e2->b,
+            e3->at(x0, y0) - e3->bias + dy*e3->b,
+            maxIntensity, alg);
+    }
+    return written;
+}
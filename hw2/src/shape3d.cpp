@@ -24,28 +24,115 @@ void shape3D::transform
 )
 {
     // Apply the transformation to every point in the copy
-    vector<vertex>::iterator v = this->vertices.begin() + 1;
-    for (; v != this->vertices.end(); ++v) {
-        // Create a vector from the vertex
-        MatrixXd vOld(4, 1);
-        vOld << v->x, v->y, v->z, 1;
-
-        // Transform the vertex
-        MatrixXd vNew = this->ptTransform * vOld;
-        *v = vertex(vNew(0), vNew(1), vNew(2));
-    }
+    int nVertices = this->vertices.size() - 1;
+    transformVertexArray(this->ptTransform, &this->vertices[1], nVertices,
+        &this->vertices[1]);
 
     // Normals are also all still the same
     vector<normal>::iterator n = this->normals.begin();
     for (; n != this->normals.end(); ++n) {
-        // Create a vector from the vertex
-        MatrixXd nOld(4, 1);
-        nOld << n->x, n->y, n->z, 1;
-
-        // Transform the vertex
-        MatrixXd nNew = this->normTransform * nOld;
+        Vector4f nNew = this->normTransform * Vector4f(n->x, n->y, n->z, 1);
         *n = normal(nNew(0), nNew(1), nNew(2));
     }
+
+    this->updateSoA();
+}
+
+/*
+ shape3D::toSoA
+
+ Copies the vertices and normals of the shape into a mesh stored as separate
+ arrays for each component.
+
+ Arguments: meshSoA *mesh - Filled with the vertices and normals
+
+ Returns:   Nothing.
+*/
+void shape3D::toSoA
+(
+    meshSoA             *mesh
+)
+{
+    assert(mesh);
+
+    int nVertices = this->vertices.size();
+    int nNormals = this->normals.size();
+    mesh->resize(nVertices, nNormals);
+    for (int i = 0; i < nVertices; ++i) {
+        mesh->x[i] = this->vertices[i].x;
+        mesh->y[i] = this->vertices[i].y;
+        mesh->z[i] = this->vertices[i].z;
+    }
+    for (int i = 0; i < nNormals; ++i) {
+        mesh->nx[i] = this->normals[i].x;
+        mesh->ny[i] = this->normals[i].y;
+        mesh->nz[i] = this->normals[i].z;
+    }
+}
+
+/*
+ shape3D::updateBounds
+
+ Finds a sphere around every vertex of the shape, centered on the middle of
+ their bounding box.  The dummy vertex at index 0 is not included.
+
+ Returns:   Nothing.
+*/
+void shape3D::updateBounds
+(
+)
+{
+    int nVertices = this->vertices.size();
+    if (nVertices < 2) {
+        this->bounds = boundingSphere();
+        return;
+    }
+
+    point3D lo = this->vertices[1].toPoint3D(), hi = lo;
+    for (int i = 2; i < nVertices; ++i) {
+        vertex *v = &this->vertices[i];
+        lo = point3D(min(lo.x, v->x), min(lo.y, v->y), min(lo.z, v->z));
+        hi = point3D(max(hi.x, v->x), max(hi.y, v->y), max(hi.z, v->z));
+    }
+    point3D center((lo.x + hi.x) / 2, (lo.y + hi.y) / 2, (lo.z + hi.z) / 2);
+
+    float radius = 0;
+    for (int i = 1; i < nVertices; ++i)
+        radius = max(radius, center.distanceTo(this->vertices[i].toPoint3D()));
+    this->bounds = boundingSphere(center, radius);
+}
+
+/*
+ shape3D::fromSoA
+
+ Replaces the vertices and normals of the shape with those of a mesh stored
+ as separate arrays for each component.  The facets are left alone, so the
+ mesh should be indexed the same way.  The soa copy and the bounding sphere
+ are refreshed as well.
+
+ Arguments: const meshSoA *mesh - The vertices and normals to copy
+
+ Returns:   Nothing.
+*/
+void shape3D::fromSoA
+(
+    const meshSoA       *mesh
+)
+{
+    assert(mesh);
+
+    int nVertices = mesh->numVertices();
+    int nNormals = mesh->numNormals();
+    this->vertices.resize(nVertices);
+    this->normals.resize(nNormals);
+    for (int i = 0; i < nVertices; ++i)
+        this->vertices[i] = mesh->vertexAt(i);
+    for (int i = 0; i < nNormals; ++i)
+        this->normals[i] = mesh->normalAt(i);
+
+    if (mesh != &this->soa)
+        this->soa = *mesh;
+    this->updateBounds();
 }
 
 /*
@@ -113,6 +200,32 @@ void shape3D::NDCToScreen
     outShape->mat = this->mat;
 }
 
+/*
+ shape3D::toClipMatrix
+
+ Creates the matrix that takes the shape's vertices straight to homogeneous
+ NDC, which is the product of the camera's world to clip matrix and the
+ shape's own transformation.  This is meant to be computed once per shape
+ and reused for every vertex.
+
+ Arguments: camera &cam - The camera the shape is viewed from
+            Matrix4f *toClip - The matrix that will be populated
+
+ Returns:   Nothing.
+*/
+void shape3D::toClipMatrix
+(
+    camera              &cam,
+    Matrix4f            *toClip
+)
+{
+    assert(toClip);
+
+    Matrix4f worldToClip;
+    cam.worldToClipMatrix(&worldToClip);
+    *toClip = worldToClip * this->ptTransform;
+}
+
 /*
  shape3D::worldToCartNDC
 
@@ -142,12 +255,12 @@ void shape3D::worldToCartNDC
     // Project each point in the original shape and put it in the new shape
     // Recall that facets assume vertices are 1-indexed, so the 0th vertex
     // is a dummy
-    vector<vertex>::iterator v = this->vertices.begin() + 1;
-    for (; v != this->vertices.end(); ++v) {
-        vertex projPt;
-        v->worldToCartNDC(this->ptTransform, cam, &projPt);
-        proj->vertices.push_back(projPt);
-    }
+    Matrix4f toClip;
+    this->toClipMatrix(cam, &toClip);
+    int nVertices = this->vertices.size() - 1;
+    proj->vertices.resize(nVertices + 1);
+    projectVertexArray(toClip, &this->vertices[1], nVertices,
+        &proj->vertices[1]);
     // All of the facets are still the same set of 3 vertices
     proj->facets = this->facets;
     // Normals are also all still the same
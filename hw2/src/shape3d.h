@@ -14,6 +14,7 @@
 #include <assert.h>
 
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
 
 #include "geom.h"
 #include "vertex.h"
@@ -21,6 +22,7 @@
 #include "camera.h"
 #include "normal.h"
 #include "light.h"
+#include "meshSoA.h"
 
 
 // Structs
@@ -44,7 +46,11 @@ typedef struct _material {
  shape3D
 
  Contains a vector of vertices in 3 dimensions and a vector of facets which
- are described by indices in the vertex vector.
+ are described by indices in the vertex vector.  The transformation matrices
+ are fixed size, so the shape must be allocated aligned.  The soa mesh holds
+ a copy of the vertices and normals as separate arrays for the vectorized
+ transform, and is refreshed with updateSoA whenever they change, along with
+ the bounding sphere of the vertices in object space.
 */
 typedef struct _shape3D {
     std::string         name;
@@ -52,14 +58,17 @@ typedef struct _shape3D {
     std::vector<facet>  facets;
     std::vector<normal> normals;
     material            mat;
+    meshSoA             soa;
+    boundingSphere      bounds;
 
-    Eigen::MatrixXd     ptTransform;
-    Eigen::MatrixXd     normTransform;
+    Eigen::Matrix4f     ptTransform;
+    Eigen::Matrix4f     normTransform;
 
     _shape3D() : name (""),
         vertices (), facets (), normals (), mat (material()),
-        ptTransform(Eigen::MatrixXd::Identity(4, 4)),
-        normTransform(Eigen::MatrixXd::Identity(4, 4)) {}
+        soa (), bounds (),
+        ptTransform(Eigen::Matrix4f::Identity()),
+        normTransform(Eigen::Matrix4f::Identity()) {}
     ~_shape3D() {}
 
     void clear() {
@@ -70,12 +79,31 @@ typedef struct _shape3D {
         normals.clear();
         normals.push_back(normal());
         facets.clear();
+        soa = meshSoA();
+        bounds = boundingSphere();
     }
 
     void NDCToScreen (int, int, _shape3D*);
+    void toClipMatrix (camera&, Eigen::Matrix4f*);
     void worldToCartNDC (camera, _shape3D*);
     void transform ();
+    void toSoA (meshSoA*);
+    void fromSoA (const meshSoA*);
+    void updateBounds ();
+    void updateSoA () { toSoA(&soa); updateBounds(); }
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 } shape3D;
 
+// Types
+/*
+ shapeList
+
+ A list of shapes.  Shapes hold fixed size Eigen matrices, which must be
+ aligned, so like matrixList they need Eigen's allocator to live in a
+ vector.
+*/
+typedef std::vector<shape3D, Eigen::aligned_allocator<shape3D> > shapeList;
+
 
 #endif // ifndef SHAPE3D
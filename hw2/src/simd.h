@@ -0,0 +1,31 @@
+/******************************************************************************
+
+ simd.h
+
+ Contains the simdLevel enum, which is shared by every stage of the renderer
+ that has vectorized code.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef SIMD
+#define SIMD
+
+// Enums
+/*
+ simdLevel
+
+ The widest vector instruction set the renderer is allowed to use.  SSE2
+ rasters 4x1 blocks of pixels and transforms 4 vertices at once, and AVX2
+ rasters 8x1 blocks and transforms 8 vertices at once.
+*/
+typedef enum _simdLevel {
+    SIMDNone,
+    SIMDSSE2,
+    SIMDAVX2,
+} simdLevel;
+
+// Function handles
+simdLevel detectSIMD ();
+
+#endif // ifndef SIMD
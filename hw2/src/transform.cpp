@@ -13,6 +13,101 @@
 using namespace std;
 using namespace Eigen;
 
+/*
+ translationMatrix
+
+ Populates a matrix with a translation.
+
+ Arguments: float x - Distance to translate in x
+            float y - Distance to translate in y
+            float z - Distance to translate in z
+            Matrix4f *m - The matrix to populate
+
+ Returns:   Nothing.
+*/
+void translationMatrix
+(
+    float               x,
+    float               y,
+    float               z,
+    Matrix4f            *m
+)
+{
+    assert(m);
+
+    *m << 1, 0, 0, x,
+          0, 1, 0, y,
+          0, 0, 1, z,
+          0, 0, 0, 1;
+}
+
+/*
+ rotationMatrix
+
+ Populates a matrix with a counterclockwise rotation about an axis.
+
+ Arguments: float x - X component of the axis of rotation
+            float y - Y component of the axis of rotation
+            float z - Z component of the axis of rotation
+            float theta - Angle of rotation in radians
+            Matrix4f *m - The matrix to populate
+
+ Returns:   Nothing.
+*/
+void rotationMatrix
+(
+    float               x,
+    float               y,
+    float               z,
+    float               theta,
+    Matrix4f            *m
+)
+{
+    assert(m);
+
+    // Normalize the axis of rotation
+    float mag = sqrt(x*x + y*y + z*z);
+    x /= mag;
+    y /= mag;
+    z /= mag;
+
+    float sinT = sin(theta);
+    float cosT = cos(theta);
+
+    *m <<    x*x+(1-x*x)*cosT,   x*y*(1-cosT)-z*sinT,   x*z*(1-cosT)+y*sinT, 0,
+          x*y*(1-cosT)+z*sinT,      y*y+(1-y*y)*cosT,   y*z*(1-cosT)-x*sinT, 0,
+          x*z*(1-cosT)-y*sinT,   y*z*(1-cosT)+x*sinT,      z*z+(1-z*z)*cosT, 0,
+                            0,                     0,                     0, 1;
+}
+
+/*
+ scalingMatrix
+
+ Populates a matrix with a scaling along each axis.
+
+ Arguments: float x - Scale factor in x
+            float y - Scale factor in y
+            float z - Scale factor in z
+            Matrix4f *m - The matrix to populate
+
+ Returns:   Nothing.
+*/
+void scalingMatrix
+(
+    float               x,
+    float               y,
+    float               z,
+    Matrix4f            *m
+)
+{
+    assert(m);
+
+    *m << x, 0, 0, 0,
+          0, y, 0, 0,
+          0, 0, z, 0,
+          0, 0, 0, 1;
+}
+
 /*
  generateTransform
 
@@ -21,14 +116,14 @@ using namespace Eigen;
 
  Arguments: string transform - A string representation of the transformation
                 vector
-            MatrixXd *m - The matrix to populate
+            Matrix4f *m - The matrix to populate
 
  Returns:   int - Number of values in string, negative if error
 */
 int generateTransform
 (
     string              transform,
-    MatrixXd            *m
+    Matrix4f            *m
 )
 {
     // Split the space-separated line into a vector of strings
@@ -39,43 +134,21 @@ int generateTransform
         return 0;
 
     // Faster to convert to float only once
-    float x = stof(vals[1]), y = stof(vals[2]), z = stof(vals[3]), mag;
-
-    // Only used in 'r' case
-    float sinT, cosT, theta;
+    float x = stof(vals[1]), y = stof(vals[2]), z = stof(vals[3]);
 
     // Handle the possible transform cases
     switch (transform[0]) {
         case 'r':
-            // Normalize the axis of rotation
-            mag = sqrt(x*x + y*y + z*z);
-            x /= mag;
-            y /= mag;
-            z /= mag;
-
             // Last value of rotation is angle
-            theta = stof(vals[4]);
-            sinT = sin(theta);
-            cosT = cos(theta);
-
-            *m <<    x*x+(1-x*x)*cosT,   x*y*(1-cosT)-z*sinT,   x*z*(1-cosT)+y*sinT, 0,
-                  x*y*(1-cosT)+z*sinT,      y*y+(1-y*y)*cosT,   y*z*(1-cosT)-x*sinT, 0,
-                  x*z*(1-cosT)-y*sinT,   y*z*(1-cosT)+x*sinT,      z*z+(1-z*z)*cosT, 0,
-                                    0,                     0,                     0, 1;
+            rotationMatrix(x, y, z, stof(vals[4]), m);
             break;
         case 's':
             // Expect 's' then n dimensions of scalar
-            *m << x, 0, 0, 0,
-                  0, y, 0, 0,
-                  0, 0, z, 0,
-                  0, 0, 0, 1;
+            scalingMatrix(x, y, z, m);
             break;
         case 't':
             // Should contain 't' then translate in n dimensions
-            *m <<  1, 0, 0, x,
-                   0, 1, 0, y,
-                   0, 0, 1, z,
-                   0, 0, 0, 1;
+            translationMatrix(x, y, z, m);
             break;
         default:
             cout << "unable to parse file" << endl;
@@ -91,26 +164,25 @@ int generateTransform
  Takes a vector of matrix factors and a matrix and multiplies the matrix by
  each of the matrices in the vector, in reverse order.  So if we have matrix
  M and vector { A, B, C } the product will be ABCM, returned in an argued
- matrix.  The matrix argued should be of the same dimension as those in
- the vector, and should be square.
+ matrix.
 
- Arguments: MatrixXd *matrix - A matrix that will be multiplied.  The output
+ Arguments: Matrix4f *matrix - A matrix that will be multiplied.  The output
                 will be stored in this matrix.
-            vector<MatrixXd> *factors - The matrices to multiply by
+            matrixList *factors - The matrices to multiply by
 
  Returns:   Nothing
 */
 void transformMatrix
 (
-    MatrixXd            *matrix,
-    vector<MatrixXd>    *factors
+    Matrix4f            *matrix,
+    matrixList          *factors
 )
 {
     assert(matrix);
     assert(factors);
 
     // Multiply by all of the matrices in the file.
-    vector<MatrixXd>::reverse_iterator it = factors->rbegin();
+    matrixList::reverse_iterator it = factors->rbegin();
     for (; it != factors->rend(); ++it) {
         // Multiply matrix by the accumulator
         *matrix = *it * *matrix;
@@ -18,10 +18,24 @@
 #include <assert.h>
 
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
 #include "utils.h"
 
+// Types
+/*
+ matrixList
+
+ A list of 4x4 transformation matrices.  Fixed size Eigen matrices must be
+ aligned, so they need Eigen's allocator to live in a vector.
+*/
+typedef std::vector<Eigen::Matrix4f,
+    Eigen::aligned_allocator<Eigen::Matrix4f> > matrixList;
+
 // Externally public functions
-void transformMatrix (Eigen::MatrixXd*, std::vector<Eigen::MatrixXd>*);
-int generateTransform (std::string, Eigen::MatrixXd*);
+void translationMatrix (float, float, float, Eigen::Matrix4f*);
+void rotationMatrix (float, float, float, float, Eigen::Matrix4f*);
+void scalingMatrix (float, float, float, Eigen::Matrix4f*);
+void transformMatrix (Eigen::Matrix4f*, matrixList*);
+int generateTransform (std::string, Eigen::Matrix4f*);
 
 #endif // ifndef TRANSFORM
@@ -0,0 +1,339 @@
+/******************************************************************************
+
+ transformSIMD.cpp
+
+ Contains the vertex transform, which takes a range of a mesh's vertices to
+ world space, clip space w, NDC and screen space in one pass.  The mesh is
+ stored as an array per component, so AVX2 transforms 8 vertices at once and
+ SSE2 transforms 4 by loading each component straight into a vector
+ register.  Every operation is done in the same order as in the scalar
+ transform, so all three produce identical vertices.  Vertices left over at
+ the end of the range that do not fill a vector are handed to the scalar
+ code.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include "vertexCache.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
+using namespace std;
+using namespace Eigen;
+
+/*
+ vertexStreams
+
+ Pointers to the start of every array read or written by the transform, so
+ that each kernel does not have to look them up in the mesh and cache.
+*/
+typedef struct _vertexStreams {
+    const float *x, *y, *z;
+    float       *worldX, *worldY, *worldZ;
+    float       *ndcX, *ndcY, *ndcZ, *clipW;
+    float       *screenX, *screenY;
+} vertexStreams;
+
+/*
+ transformScalar
+
+ Transforms a range of vertices one at a time.  Each row of a matrix is
+ applied as ((m0*x + m1*y) + m2*z) + m3, and the NDC point is scaled to the
+ screen the same way as vertex::NDCToImage.
+
+ Arguments: const Matrix4f &toWorld - Transforms the mesh to world space
+            const Matrix4f &toClip - Transforms the mesh to homogeneous NDC
+            float halfX - Half the X resolution of the image, rounded down
+            float halfY - Half the Y resolution of the image, rounded down
+            vertexStreams *s - The arrays to read from and write to
+            int first - Index of the first vertex to transform
+            int last - One past the index of the last vertex to transform
+
+ Returns:   Nothing.
+*/
+static void transformScalar
+(
+    const Matrix4f      &toWorld,
+    const Matrix4f      &toClip,
+    float               halfX,
+    float               halfY,
+    vertexStreams       *s,
+    int                 first,
+    int                 last
+)
+{
+    const Matrix4f &w = toWorld, &c = toClip;
+    for (int i = first; i < last; ++i) {
+        float x = s->x[i], y = s->y[i], z = s->z[i];
+
+        s->worldX[i] = w(0,0)*x + w(0,1)*y + w(0,2)*z + w(0,3);
+        s->worldY[i] = w(1,0)*x + w(1,1)*y + w(1,2)*z + w(1,3);
+        s->worldZ[i] = w(2,0)*x + w(2,1)*y + w(2,2)*z + w(2,3);
+
+        // The cartesian point is the homogenous point scaled by 1/w
+        float hw = c(3,0)*x + c(3,1)*y + c(3,2)*z + c(3,3);
+        float nx = (c(0,0)*x + c(0,1)*y + c(0,2)*z + c(0,3)) / hw;
+        float ny = (c(1,0)*x + c(1,1)*y + c(1,2)*z + c(1,3)) / hw;
+        float nz = (c(2,0)*x + c(2,1)*y + c(2,2)*z + c(2,3)) / hw;
+        s->clipW[i] = hw;
+        s->ndcX[i] = nx;
+        s->ndcY[i] = ny;
+        s->ndcZ[i] = nz;
+
+        // Scale NDC (-1, 1) to whole pixels in (0, xres) and (0, yres)
+        s->screenX[i] = (int) ((1 + nx) * halfX);
+        s->screenY[i] = (int) ((1 + ny) * halfY);
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+
+/*
+ rowSSE2
+
+ Applies one row of a matrix to 4 vertices.
+
+ Arguments: __m128 *m - The 4 entries of the row, each in every lane
+            __m128 x - X coordinates of the vertices
+            __m128 y - Y coordinates of the vertices
+            __m128 z - Z coordinates of the vertices
+
+ Returns:   (__m128) - The row applied to each vertex
+*/
+static inline __m128 rowSSE2
+(
+    __m128              *m,
+    __m128              x,
+    __m128              y,
+    __m128              z
+)
+{
+    __m128 sum = _mm_add_ps(_mm_mul_ps(m[0], x), _mm_mul_ps(m[1], y));
+    sum = _mm_add_ps(sum, _mm_mul_ps(m[2], z));
+    return _mm_add_ps(sum, m[3]);
+}
+
+/*
+ transformSSE2
+
+ Transforms a range of vertices 4 at a time.
+
+ Arguments: See transformScalar.
+
+ Returns:   Nothing.
+*/
+static void transformSSE2
+(
+    const Matrix4f      &toWorld,
+    const Matrix4f      &toClip,
+    float               halfX,
+    float               halfY,
+    vertexStreams       *s,
+    int                 first,
+    int                 last
+)
+{
+    // Every matrix entry is broadcast to all lanes once
+    __m128 w[3][4], c[4][4];
+    for (int r = 0; r < 4; ++r) {
+        for (int col = 0; col < 4; ++col) {
+            if (r < 3)
+                w[r][col] = _mm_set1_ps(toWorld(r, col));
+            c[r][col] = _mm_set1_ps(toClip(r, col));
+        }
+    }
+    __m128 one = _mm_set1_ps(1), hx = _mm_set1_ps(halfX);
+    __m128 hy = _mm_set1_ps(halfY);
+
+    int i = first;
+    for (; i + 4 <= last; i += 4) {
+        __m128 x = _mm_loadu_ps(s->x + i);
+        __m128 y = _mm_loadu_ps(s->y + i);
+        __m128 z = _mm_loadu_ps(s->z + i);
+
+        _mm_storeu_ps(s->worldX + i, rowSSE2(w[0], x, y, z));
+        _mm_storeu_ps(s->worldY + i, rowSSE2(w[1], x, y, z));
+        _mm_storeu_ps(s->worldZ + i, rowSSE2(w[2], x, y, z));
+
+        __m128 hw = rowSSE2(c[3], x, y, z);
+        __m128 nx = _mm_div_ps(rowSSE2(c[0], x, y, z), hw);
+        __m128 ny = _mm_div_ps(rowSSE2(c[1], x, y, z), hw);
+        __m128 nz = _mm_div_ps(rowSSE2(c[2], x, y, z), hw);
+        _mm_storeu_ps(s->clipW + i, hw);
+        _mm_storeu_ps(s->ndcX + i, nx);
+        _mm_storeu_ps(s->ndcY + i, ny);
+        _mm_storeu_ps(s->ndcZ + i, nz);
+
+        // Truncating to an integer and back lands on whole pixels
+        __m128 sx = _mm_mul_ps(_mm_add_ps(one, nx), hx);
+        __m128 sy = _mm_mul_ps(_mm_add_ps(one, ny), hy);
+        _mm_storeu_ps(s->screenX + i, _mm_cvtepi32_ps(_mm_cvttps_epi32(sx)));
+        _mm_storeu_ps(s->screenY + i, _mm_cvtepi32_ps(_mm_cvttps_epi32(sy)));
+    }
+
+    transformScalar(toWorld, toClip, halfX, halfY, s, i, last);
+}
+
+/*
+ rowAVX2
+
+ Applies one row of a matrix to 8 vertices.
+
+ Arguments: __m256 *m - The 4 entries of the row, each in every lane
+            __m256 x - X coordinates of the vertices
+            __m256 y - Y coordinates of the vertices
+            __m256 z - Z coordinates of the vertices
+
+ Returns:   (__m256) - The row applied to each vertex
+*/
+__attribute__((target("avx2")))
+static inline __m256 rowAVX2
+(
+    __m256              *m,
+    __m256              x,
+    __m256              y,
+    __m256              z
+)
+{
+    __m256 sum = _mm256_add_ps(_mm256_mul_ps(m[0], x), _mm256_mul_ps(m[1], y));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(m[2], z));
+    return _mm256_add_ps(sum, m[3]);
+}
+
+/*
+ transformAVX2
+
+ Transforms a range of vertices 8 at a time.
+
+ Arguments: See transformScalar.
+
+ Returns:   Nothing.
+*/
+__attribute__((target("avx2")))
+static void transformAVX2
+(
+    const Matrix4f      &toWorld,
+    const Matrix4f      &toClip,
+    float               halfX,
+    float               halfY,
+    vertexStreams       *s,
+    int                 first,
+    int                 last
+)
+{
+    // Every matrix entry is broadcast to all lanes once
+    __m256 w[3][4], c[4][4];
+    for (int r = 0; r < 4; ++r) {
+        for (int col = 0; col < 4; ++col) {
+            if (r < 3)
+                w[r][col] = _mm256_set1_ps(toWorld(r, col));
+            c[r][col] = _mm256_set1_ps(toClip(r, col));
+        }
+    }
+    __m256 one = _mm256_set1_ps(1), hx = _mm256_set1_ps(halfX);
+    __m256 hy = _mm256_set1_ps(halfY);
+
+    int i = first;
+    for (; i + 8 <= last; i += 8) {
+        __m256 x = _mm256_loadu_ps(s->x + i);
+        __m256 y = _mm256_loadu_ps(s->y + i);
+        __m256 z = _mm256_loadu_ps(s->z + i);
+
+        _mm256_storeu_ps(s->worldX + i, rowAVX2(w[0], x, y, z));
+        _mm256_storeu_ps(s->worldY + i, rowAVX2(w[1], x, y, z));
+        _mm256_storeu_ps(s->worldZ + i, rowAVX2(w[2], x, y, z));
+
+        __m256 hw = rowAVX2(c[3], x, y, z);
+        __m256 nx = _mm256_div_ps(rowAVX2(c[0], x, y, z), hw);
+        __m256 ny = _mm256_div_ps(rowAVX2(c[1], x, y, z), hw);
+        __m256 nz = _mm256_div_ps(rowAVX2(c[2], x, y, z), hw);
+        _mm256_storeu_ps(s->clipW + i, hw);
+        _mm256_storeu_ps(s->ndcX + i, nx);
+        _mm256_storeu_ps(s->ndcY + i, ny);
+        _mm256_storeu_ps(s->ndcZ + i, nz);
+
+        // Truncating to an integer and back lands on whole pixels
+        __m256 sx = _mm256_mul_ps(_mm256_add_ps(one, nx), hx);
+        __m256 sy = _mm256_mul_ps(_mm256_add_ps(one, ny), hy);
+        _mm256_storeu_ps(s->screenX + i,
+            _mm256_cvtepi32_ps(_mm256_cvttps_epi32(sx)));
+        _mm256_storeu_ps(s->screenY + i,
+            _mm256_cvtepi32_ps(_mm256_cvttps_epi32(sy)));
+    }
+
+    transformScalar(toWorld, toClip, halfX, halfY, s, i, last);
+}
+
+#endif // ifdef HAVE_X86_SIMD
+
+/*
+ transformMeshSoA
+
+ Transforms a contiguous range of a mesh's vertices to world space, clip
+ space w, NDC and screen space, storing them in a vertex cache whose arrays
+ are already large enough.  The widest allowed vector instruction set is
+ used.
+
+ Arguments: simdLevel simd - The widest instruction set to use
+            const Matrix4f &toWorld - Transforms the mesh to world space
+            const Matrix4f &toClip - Transforms the mesh to homogeneous NDC
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            const meshSoA *mesh - The vertices to transform
+            int first - Index of the first vertex to transform
+            int last - One past the index of the last vertex to transform
+            vertexCache *cache - The cache to fill
+
+ Returns:   Nothing.
+*/
+void transformMeshSoA
+(
+    simdLevel           simd,
+    const Matrix4f      &toWorld,
+    const Matrix4f      &toClip,
+    int                 xres,
+    int                 yres,
+    const meshSoA       *mesh,
+    int                 first,
+    int                 last,
+    vertexCache         *cache
+)
+{
+    assert(mesh);
+    assert(cache);
+
+    if (first >= last)
+        return;
+
+    vertexStreams s;
+    s.x = &mesh->x[0];
+    s.y = &mesh->y[0];
+    s.z = &mesh->z[0];
+    s.worldX = &cache->world.x[0];
+    s.worldY = &cache->world.y[0];
+    s.worldZ = &cache->world.z[0];
+    s.ndcX = &cache->ndc.x[0];
+    s.ndcY = &cache->ndc.y[0];
+    s.ndcZ = &cache->ndc.z[0];
+    s.clipW = &cache->clipW[0];
+    s.screenX = &cache->screenX[0];
+    s.screenY = &cache->screenY[0];
+
+    // Resolutions are halved as integers, as in vertex::NDCToImage
+    float halfX = xres / 2, halfY = yres / 2;
+
+#ifdef HAVE_X86_SIMD
+    if (simd == SIMDAVX2) {
+        transformAVX2(toWorld, toClip, halfX, halfY, &s, first, last);
+        return;
+    }
+    if (simd == SIMDSSE2) {
+        transformSSE2(toWorld, toClip, halfX, halfY, &s, first, last);
+        return;
+    }
+#endif
+    transformScalar(toWorld, toClip, halfX, halfY, &s, first, last);
+}
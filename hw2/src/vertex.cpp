@@ -15,89 +15,136 @@ using namespace Eigen;
 /*
  vertex::operator*
 
- Defines the multiplication operator for a vertex and a matrix.  It creates a
- matrix out of the vertex, multiplies by the matrix, and returns the vertex
- with the resultant matrix values.
+ Defines the multiplication operator for a vertex and a 4x4 matrix.  The
+ vertex is treated as a homogeneous point with w = 1, and the resultant x, y
+ and z values are returned without dividing by w.
 
- Arguments: const MatrixXd &m - The matrix to multiply by
+ Arguments: const Matrix4f &m - The matrix to multiply by
 
  Returns:   (vertex) - Vertex after multiplication
 */
 vertex vertex::operator*
 (
-    const MatrixXd      &m
-)
+    const Matrix4f      &m
+) const
 {
-    // Want to handle 3D and 4D
-    int dim = m.rows();
-    MatrixXd vec(dim, 1);
-
-    // Populate the vector to match the input matrix's dimension
-    switch(dim) {
-        case 3:
-            vec << this->x, this->y, this->z;
-            break;
-        case 4:
-            vec << this->x, this->y, this->z, 1;
-            break;
-        default:
-            return vertex();
-    }
+    Vector4f vec = m * Vector4f(this->x, this->y, this->z, 1);
+    return vertex(vec(0), vec(1), vec(2));
+}
+
+/*
+ vertex::operator*
+
+ Defines the multiplication operator for a vertex and a 3x3 matrix.
 
-    // Do the computation and turn it back to a vertex
-    vec = m * vec;
+ Arguments: const Matrix3f &m - The matrix to multiply by
 
+ Returns:   (vertex) - Vertex after multiplication
+*/
+vertex vertex::operator*
+(
+    const Matrix3f      &m
+) const
+{
+    Vector3f vec = m * Vector3f(this->x, this->y, this->z);
     return vertex(vec(0), vec(1), vec(2));
 }
 
 /*
  vertex::worldToCartNDC
 
- Takes a point and a perspective projection matrix and converts the original
- point to Cartesian normalized device coordinates (NDC).
+ Takes a point and a matrix that takes it to homogeneous NDC, and converts
+ the point to Cartesian normalized device coordinates (NDC).  The matrix is
+ usually the product of the perspective projection, world to camera and
+ shape transformation matrices, computed once for a whole shape.
 
- Arguments: MatrixXd transform - The transformation matrix to apply
-            camera cam - Used to convert to camera space then NDC
+ Arguments: const Matrix4f &toClip - Transforms the point to homogeneous NDC
             vertex *proj - Where to store the projected point
 
  Returns:   Nothing.
 */
 void vertex::worldToCartNDC
 (
-    MatrixXd            transform,
-    camera              cam,
+    const Matrix4f      &toClip,
     vertex              *proj
 )
 {
     assert(proj);
 
-    // First get the transformation matrix that can convert world space to
-    // camera space
-    MatrixXd toCam(4, 4);
-    cam.worldToCameraMatrix(&toCam);
-
-    // Get the perspective projection matrix that we will use to get from a
-    // point in camera space to our screen
-    MatrixXd toNDC(4, 4);
-    cam.perspectiveProjectionMatrix(&toNDC);
-
-    // Create a 4D vector (x, y, z, w) out of the original point where w = 1
-    MatrixXd origVec(4, 1);
-    origVec << this->x, this->y, this->z, 1;
-
-    // The output homogenous NDC point will be a 4D vector, and is computed
-    // by multiplying the perspective projection matrix by the original point
-    MatrixXd NDC = toNDC * (toCam * (transform * origVec));
+    // The output homogenous NDC point will be a 4D vector
+    Vector4f NDC = toClip * Vector4f(this->x, this->y, this->z, 1);
 
     // The cartesian point is the x, y, z coordinates of the homogenous NDC
     // normalized by scaling by 1/w, where w is at the 3rd index (0-indexed)
     NDC /= NDC(3);
 
-    // Use the resultant 4D vector to populate the argued address with the
-    // projected point
     *proj = vertex(NDC(0), NDC(1), NDC(2));
 }
 
+/*
+ transformVertexArray
+
+ Multiplies every vertex in an array by a matrix, treating each as a
+ homogeneous point with w = 1.  Colors are carried over unchanged.  The input
+ and output arrays may be the same.
+
+ Arguments: const Matrix4f &m - The matrix to multiply by
+            const vertex *in - The vertices to transform
+            int n - Number of vertices in the array
+            vertex *out - Filled with the n transformed vertices
+
+ Returns:   Nothing.
+*/
+void transformVertexArray
+(
+    const Matrix4f      &m,
+    const vertex        *in,
+    int                 n,
+    vertex              *out
+)
+{
+    assert(in);
+    assert(out);
+
+    for (int i = 0; i < n; ++i) {
+        Vector4f vec = m * Vector4f(in[i].x, in[i].y, in[i].z, 1);
+        out[i] = vertex(vec(0), vec(1), vec(2), in[i].c);
+    }
+}
+
+/*
+ projectVertexArray
+
+ Takes every vertex in an array to Cartesian NDC with a matrix that takes
+ points to homogeneous NDC, as vertex::worldToCartNDC does for a single
+ vertex.  Colors are carried over unchanged.  The input and output arrays may
+ be the same.
+
+ Arguments: const Matrix4f &toClip - Transforms a point to homogeneous NDC
+            const vertex *in - The vertices to project
+            int n - Number of vertices in the array
+            vertex *out - Filled with the n projected vertices
+
+ Returns:   Nothing.
+*/
+void projectVertexArray
+(
+    const Matrix4f      &toClip,
+    const vertex        *in,
+    int                 n,
+    vertex              *out
+)
+{
+    assert(in);
+    assert(out);
+
+    for (int i = 0; i < n; ++i) {
+        Vector4f NDC = toClip * Vector4f(in[i].x, in[i].y, in[i].z, 1);
+        NDC /= NDC(3);
+        out[i] = vertex(NDC(0), NDC(1), NDC(2), in[i].c);
+    }
+}
+
 /*
  vertex::NDCToImage
 
@@ -124,80 +171,99 @@ void vertex::NDCToImage
     *out = vertex(winX, winY, 0);
 }
 
+/*
+ raiseSpecular
+
+ Raises the specular term of a lit point to the shininess of its material.
+ Whole number shininesses are raised to by squaring and multiplying, and any
+ other shininess with pow.
+
+ Arguments: float base - The specular term, which is not negative
+            const lightingContext &ctx - Holds the shininess
+
+ Returns:   (float) - base raised to the shininess
+*/
+static inline float raiseSpecular
+(
+    float                   base,
+    const lightingContext   &ctx
+)
+{
+    if (ctx.specPower < 0)
+        return pow(base, ctx.shininess);
+
+    float result = 1;
+    for (int e = ctx.specPower; e > 0; e >>= 1) {
+        if (e & 1)
+            result *= base;
+        base *= base;
+    }
+    return result;
+}
+
 /*
  vertex::computeLight
 
  Computes the lighting of this vertex given all of the light sources and their
- parameters in the system.
+ parameters in the system, which have been prepared for the material of the
+ vertex.  Nothing is copied or allocated, so this can be called per pixel.
 
- Arguments: normal n - The normal to this vertex.
-            rgb ambient - Ambient RGB value of this shape
-            rgb diffuse - Diffuse RGB value of this shape
-            rgb specular - Specular RGB value of this shape
-            float shininess - Shininess of the shape
-            camera cam - The camera the image is viewed from
-            vector<light> lights - Lights in the system
+ Arguments: const normal &n - The normal to this vertex.
+            const lightingContext &ctx - The camera, lights and material
 
  Returns:   Nothing.
 */
 void vertex::computeLight
 (
-    normal          n,
-    rgb             ambient,
-    rgb             diffuse,
-    rgb             specular,
-    float           shininess,
-    camera          cam,
-    vector<light>   lights
+    const normal            &n,
+    const lightingContext   &ctx
 )
 {
-    // Accumulators for computing light intensity
-    rgb diffuseSum(0, 0, 0);
-    rgb specularSum(0, 0, 0);
+    // Accumulators for computing light intensity, already scaled by the
+    // material's diffuse and specular colors
+    float diffuseR = 0, diffuseG = 0, diffuseB = 0;
+    float specularR = 0, specularG = 0, specularB = 0;
 
     // Vector at point P in direction of camera
-    point3D eDir(cam.pos.x - this->x,
-        cam.pos.y - this->y, cam.pos.z - this->z);
+    point3D eDir(ctx.eyeX - this->x, ctx.eyeY - this->y, ctx.eyeZ - this->z);
     eDir.normalize();
 
+    // Point representation of normal
+    point3D normPt(n.x, n.y, n.z);
+
     // Compute the aggregate light contribution of the lights on point v
-    vector<light>::iterator l = lights.begin();
-    for (; l != lights.end(); ++l) {
-        // Compute the distance so we can get attenuation
-        float dist = l->loc.distanceTo(this->toPoint3D());
-        // Get the attenuation constant from the light source
-        float k = l->attenuation;
-        float attenuation = 1 / (1 + k*dist*dist);
-
-        // Scale light intensity by attenuation
-        l->color = l->color * attenuation;
-
-        // Vector in direction of light source
-        point3D lDir(l->loc.x - this->x,
-            l->loc.y - this->y, l->loc.z - this->z);
+    int nLights = ctx.numLights();
+    for (int i = 0; i < nLights; ++i) {
+        // Vector in direction of light source, whose length gives the
+        // attenuation
+        point3D lDir(ctx.x[i] - this->x, ctx.y[i] - this->y,
+            ctx.z[i] - this->z);
+        float distSq = lDir.dot(lDir);
+        float attenuation = 1 / (1 + ctx.attenuation[i] * distSq);
         lDir.normalize();
 
-        // Point representation of normal
-        point3D normPt(n.x, n.y, n.z);
         // Add in to diffuse
         float colorScale = lDir.dot(normPt);
-        colorScale = colorScale < 0 ? 0 : colorScale;
-        diffuseSum = diffuseSum + (l->color * colorScale);
+        colorScale = colorScale < 0 ? 0 : colorScale * attenuation;
+        diffuseR += ctx.diffuseR[i] * colorScale;
+        diffuseG += ctx.diffuseG[i] * colorScale;
+        diffuseB += ctx.diffuseB[i] * colorScale;
+
         // Add light to specular
         point3D eyePlusLight = eDir + lDir;
         eyePlusLight.normalize();
         float specScale = eyePlusLight.dot(normPt);
         specScale = specScale < 0 ? 0 : specScale;
-        specularSum = specularSum + (l->color * pow(specScale, shininess));
+        specScale = raiseSpecular(specScale, ctx) * attenuation;
+        specularR += ctx.specularR[i] * specScale;
+        specularG += ctx.specularG[i] * specScale;
+        specularB += ctx.specularB[i] * specScale;
     }
 
     // Using aggregate light, determine intensity of r, g and b
-    float r = ambient.r + diffuseSum.r * diffuse.r +
-        specularSum.r * specular.r;
-    float g = ambient.g + diffuseSum.g * diffuse.g +
-        specularSum.g * specular.g;
-    float b = ambient.b + diffuseSum.b * diffuse.b +
-        specularSum.b * specular.b;
+    float r = ctx.ambient.r + diffuseR + specularR;
+    float g = ctx.ambient.g + diffuseG + specularG;
+    float b = ctx.ambient.b + diffuseB + specularB;
 
     // Can't have intensities greater than 1
     this->c = rgb(r > 1 ? 1 : r, g > 1 ? 1 : g, b > 1 ? 1 : b);
@@ -38,14 +38,21 @@ typedef struct _vertex {
         : x (x), y (y), z (z), c (c) {}
     ~_vertex() {}
 
-    _vertex operator* (const Eigen::MatrixXd& m);
+    _vertex operator* (const Eigen::Matrix4f& m) const;
+    _vertex operator* (const Eigen::Matrix3f& m) const;
 
     point3D toPoint3D() { return point3D(x, y, z); }
 
     void NDCToImage (int, int, _vertex*);
-    void worldToCartNDC (Eigen::MatrixXd, camera, _vertex*);
-    void computeLight (normal, rgb, rgb, rgb, float, camera, std::vector<light>);
+    void worldToCartNDC (const Eigen::Matrix4f&, _vertex*);
+    void computeLight (const normal&, const lightingContext&);
     float barycentricCoeff (_vertex, _vertex, point3D);
 } vertex;
 
+// Externally public functions
+void transformVertexArray (const Eigen::Matrix4f&, const vertex*, int,
+    vertex*);
+void projectVertexArray (const Eigen::Matrix4f&, const vertex*, int,
+    vertex*);
+
 #endif // ifndef VERTEX
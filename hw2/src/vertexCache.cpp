@@ -0,0 +1,286 @@
+/******************************************************************************
+
+ vertexCache.cpp
+
+ Contains the vertex processing stage of the rasterizer, which transforms and
+ lights every vertex of an instance once so that the facets sharing it do
+ not each have to.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <thread>
+#include <functional>
+#include <unordered_map>
+
+#include "vertexCache.h"
+
+using namespace std;
+using namespace Eigen;
+
+/*
+ transformNormals
+
+ Transforms a contiguous range of a mesh's normals to world space and
+ normalizes them, storing them in the cache.
+
+ Arguments: const meshSoA *mesh - The normals to transform
+            Matrix3f *normTransform - Transforms object space normals to
+                world space
+            int first - Index of the first normal to transform
+            int last - One past the index of the last normal to transform
+            vertexCache *cache - The cache to fill
+
+ Returns:   Nothing.
+*/
+static void transformNormals
+(
+    const meshSoA       *mesh,
+    Matrix3f            *normTransform,
+    int                 first,
+    int                 last,
+    vertexCache         *cache
+)
+{
+    for (int i = first; i < last; ++i) {
+        Vector3f world = *normTransform *
+            Vector3f(mesh->nx[i], mesh->ny[i], mesh->nz[i]);
+        float mag = world.norm();
+        if (mag > 0)
+            world /= mag;
+        cache->world.nx[i] = world(0);
+        cache->world.ny[i] = world(1);
+        cache->world.nz[i] = world(2);
+    }
+}
+
+/*
+ lightCorners
+
+ Lights a contiguous range of the distinct vertex and normal pairings used by
+ a mesh's facets, storing the colors in the cache.  The pairings are read
+ from the cache's pairs, and the lights from its lighting context.
+
+ Arguments: int first - Index of the first pairing to light
+            int last - One past the index of the last pairing to light
+            vertexCache *cache - The cache to fill
+
+ Returns:   Nothing.
+*/
+static void lightCorners
+(
+    int                 first,
+    int                 last,
+    vertexCache         *cache
+)
+{
+    const vector<int> &pairs = cache->pairs;
+    for (int i = first; i < last; ++i) {
+        vertex v = cache->world.vertexAt(pairs[2*i]);
+        v.computeLight(cache->world.normalAt(pairs[2*i + 1]),
+            cache->lighting);
+        cache->colors[i] = v.c;
+    }
+}
+
+/*
+ splitRange
+
+ Splits the range [0, n) into nThreads contiguous pieces of nearly equal
+ size and finds the bounds of one of them.
+
+ Arguments: int n - Size of the range to split
+            int nThreads - Number of pieces to split it into
+            int t - Which piece to find the bounds of
+            int *first - Set to the first index in the piece
+            int *last - Set to one past the last index in the piece
+
+ Returns:   Nothing.
+*/
+static void splitRange
+(
+    int                 n,
+    int                 nThreads,
+    int                 t,
+    int                 *first,
+    int                 *last
+)
+{
+    *first = (long) n * t / nThreads;
+    *last = (long) n * (t + 1) / nThreads;
+}
+
+/*
+ joinAll
+
+ Waits for every thread in a list to finish, then empties the list.
+
+ Arguments: vector<thread> *workers - The threads to wait for
+
+ Returns:   Nothing.
+*/
+static void joinAll
+(
+    vector<thread>      *workers
+)
+{
+    vector<thread>::iterator w = workers->begin();
+    for (; w != workers->end(); ++w)
+        w->join();
+    workers->clear();
+}
+
+/*
+ vertexCache::findPairs
+
+ Finds every distinct pairing of vertex and normal used by a corner of one of
+ the cached mesh's facets, and which pairing each facet corner uses.
+
+ Arguments: None.
+
+ Returns:   Nothing.
+*/
+void vertexCache::findPairs()
+{
+    assert(this->mesh);
+
+    const vector<facet> &facets = this->mesh->facets;
+    unordered_map<uint64_t, int> pairIndices;
+    this->pairs.clear();
+    this->corners.resize(3 * facets.size());
+    for (unsigned int f = 0; f < facets.size(); ++f) {
+        const facet *fac = &facets[f];
+        int vs[3] = { fac->v1, fac->v2, fac->v3 };
+        int ns[3] = { fac->n1, fac->n2, fac->n3 };
+        for (int i = 0; i < 3; ++i) {
+            uint64_t key = ((uint64_t) vs[i] << 32) | (uint32_t) ns[i];
+            unordered_map<uint64_t, int>::iterator found =
+                pairIndices.find(key);
+            if (found == pairIndices.end()) {
+                found = pairIndices.insert(
+                    make_pair(key, (int) this->pairs.size() / 2)).first;
+                this->pairs.push_back(vs[i]);
+                this->pairs.push_back(ns[i]);
+            }
+            this->corners[3*f + i] = found->second;
+        }
+    }
+}
+
+/*
+ vertexCache::build
+
+ Fills the cache for an instance.  Every vertex is transformed and every
+ normal is transformed once, reading them from the soa mesh of the
+ instance's mesh, which is never modified.  If the instance is lit per
+ vertex, the distinct pairings of vertex and normal used by the facets are
+ found, unless the cache was last built for the same mesh, and each is lit
+ once.  Each of these steps is split across the argued number of threads.
+
+ Arguments: const instance *inst - The instance to fill the cache from
+            const Matrix4f &toWorld - Transforms the mesh to world space,
+                usually the instance's ptTransform
+            camera &cam - The camera the scene is viewed from
+            vector<light> &lights - Lights in the system
+            bool lit - True if vertices should be lit, as in Gouraud shading
+            int xres - X resolution of the image in pixels
+            int yres - Y resolution of the image in pixels
+            int nThreads - Number of threads to split the work across
+            simdLevel simd - The widest instruction set to transform with
+
+ Returns:   Nothing.
+*/
+void vertexCache::build
+(
+    const instance      *inst,
+    const Matrix4f      &toWorld,
+    camera              &cam,
+    vector<light>       &lights,
+    bool                lit,
+    int                 xres,
+    int                 yres,
+    int                 nThreads,
+    simdLevel           simd
+)
+{
+    assert(inst);
+    assert(inst->mesh);
+
+    // The soa mesh is filled whenever the mesh is read or transformed
+    const meshSoA *soa = &inst->mesh->soa;
+    assert(soa->numVertices() == (int) inst->mesh->vertices.size());
+    assert(soa->numNormals() == (int) inst->mesh->normals.size());
+
+    // The pairings found for another mesh do not apply to this one
+    if (this->mesh != inst->mesh) {
+        this->pairs.clear();
+        this->corners.clear();
+    }
+    this->mesh = inst->mesh;
+    this->inst = inst;
+
+    // Matrices are computed once for the whole instance.  Normals are
+    // transformed by the inverse transpose of the linear part of the
+    // instance's transformation.
+    Matrix4f toClip;
+    cam.worldToClipMatrix(&toClip);
+    this->worldToClip = toClip;
+    toClip = toClip * toWorld;
+    Matrix3f normTransform =
+        toWorld.topLeftCorner<3, 3>().inverse().transpose();
+
+    // The lights are prepared for the instance's material once, whether
+    // vertices or pixels are lit
+    const material *m = &inst->mat;
+    this->lighting.prepare(cam, lights, m->ambient, m->diffuse, m->specular,
+        m->shininess);
+
+    int nVertices = soa->numVertices();
+    int nNormals = soa->numNormals();
+    this->world.resize(nVertices, nNormals);
+    this->ndc.resize(nVertices, 0);
+    this->clipW.resize(nVertices);
+    this->screenX.resize(nVertices);
+    this->screenY.resize(nVertices);
+
+    // Transform the vertices and normals, with each thread taking a piece
+    // of each.  The calling thread takes the first piece itself.
+    nThreads = max(nThreads, 1);
+    vector<thread> workers;
+    int first, last;
+    for (int t = 1; t < nThreads; ++t) {
+        splitRange(nVertices, nThreads, t, &first, &last);
+        workers.push_back(thread(transformMeshSoA, simd, cref(toWorld),
+            cref(toClip), xres, yres, soa, first, last, this));
+        splitRange(nNormals, nThreads, t, &first, &last);
+        workers.push_back(thread(transformNormals, soa, &normTransform,
+            first, last, this));
+    }
+    splitRange(nVertices, nThreads, 0, &first, &last);
+    transformMeshSoA(simd, toWorld, toClip, xres, yres, soa, first, last,
+        this);
+    splitRange(nNormals, nThreads, 0, &first, &last);
+    transformNormals(soa, &normTransform, first, last, this);
+    joinAll(&workers);
+
+    if (!lit) {
+        this->colors.clear();
+        return;
+    }
+
+    // Find every distinct pairing of vertex and normal, and which pairing
+    // each facet corner uses, if they are not known for this mesh yet
+    if (this->corners.size() != 3 * this->mesh->facets.size())
+        this->findPairs();
+
+    // Light each pairing once
+    int nPairs = this->pairs.size() / 2;
+    this->colors.resize(nPairs);
+    for (int t = 1; t < nThreads; ++t) {
+        splitRange(nPairs, nThreads, t, &first, &last);
+        workers.push_back(thread(lightCorners, first, last, this));
+    }
+    splitRange(nPairs, nThreads, 0, &first, &last);
+    lightCorners(first, last, this);
+    joinAll(&workers);
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+
+ vertexCache.h
+
+ Contains the vertexCache struct, which holds every vertex of an instance
+ after it has been transformed and lit.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef VERTEXCACHE
+#define VERTEXCACHE
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include "geom.h"
+#include "vertex.h"
+#include "normal.h"
+#include "camera.h"
+#include "light.h"
+#include "shape3d.h"
+#include "instance.h"
+#include "meshSoA.h"
+#include "simd.h"
+
+// Structs
+/*
+ vertexCache
+
+ The post-transform cache for one instance.  Every vertex of the instance's
+ mesh is transformed to world space, NDC and screen space exactly once, and
+ every normal to world space exactly once, indexed the same way as the mesh's
+ vertices and normals.  World space positions and normals are held in world,
+ NDC positions in ndc, the w of each vertex in clip space, before division,
+ in clipW, and screen positions in screenX and screenY, each as separate
+ arrays per component.  worldToClip is the camera's transformation from
+ world space to clip space the cache was built with.  Under Gouraud shading,
+ every distinct pairing of a vertex with a normal used by a facet corner is
+ lit exactly once, pairs holds the vertex and normal index of each, and
+ corners holds, for each facet, the index in colors of each of its three
+ corners.  lighting holds the lights prepared for the instance's material,
+ for lighting its vertices or, under Phong shading, its pixels.  Under
+ deferred Phong shading, materialID is the ID the image gave that material.
+
+ The cache is keyed on the mesh and the instance it was last built for.  The
+ pairings depend only on the mesh, so they are kept when the cache is rebuilt
+ for the same mesh, whether for another frame or for another instance of it.
+*/
+typedef struct _vertexCache {
+    const shape3D           *mesh;
+    const instance          *inst;
+    meshSoA                 world;
+    meshSoA                 ndc;
+    std::vector<float>      clipW;
+    Eigen::Matrix4f         worldToClip;
+    std::vector<float>      screenX;
+    std::vector<float>      screenY;
+    std::vector<rgb>        colors;
+    std::vector<int>        pairs;
+    std::vector<int>        corners;
+    lightingContext         lighting;
+    int                     materialID;
+
+    _vertexCache() : mesh (NULL), inst (NULL), world (), ndc (), clipW (),
+        worldToClip (Eigen::Matrix4f::Identity()), screenX (), screenY (),
+        colors (), pairs (), corners (), lighting (), materialID (-1) {}
+    ~_vertexCache() {}
+
+    vertex screenAt(int i) const { return vertex(screenX[i], screenY[i], 0); }
+
+    void build (const instance*, const Eigen::Matrix4f&, camera&,
+        std::vector<light>&, bool, int, int, int, simdLevel);
+    void findPairs ();
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+} vertexCache;
+
+// Types
+/*
+ vertexCacheList
+
+ A list of vertex caches, one per instance.  Caches hold a fixed size Eigen
+ matrix, which must be aligned, so like matrixList they need Eigen's
+ allocator to live in a vector.
+*/
+typedef std::vector<vertexCache, Eigen::aligned_allocator<vertexCache> >
+    vertexCacheList;
+
+// Externally public functions
+void transformMeshSoA (simdLevel, const Eigen::Matrix4f&,
+    const Eigen::Matrix4f&, int, int, const meshSoA*, int, int, vertexCache*);
+
+#endif // ifndef VERTEXCACHE
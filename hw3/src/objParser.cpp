@@ -3,7 +3,9 @@
  objParser.cpp
 
  Parses OBJ files and creates an object containing a vector of its
- vertices and normals.
+ vertices and normals.  The files themselves are read by the OBJ loader
+ shared by every assignment, which maps a binary cache kept next to each
+ file instead of parsing the file again on every run.
 
  Usage: ./objParser
 
@@ -18,12 +20,12 @@ using namespace std;
 /*
  parseObjFile
 
- Opens the argued OBJ file and creates a vertex for every vertex and a facet
- for every face in the file.  This assumes that the OBJ file is such that
- every line either contains v <float> <float> <float> or f <int> <int> <int>.
- If this is not the case, the behavior is undefined.  It then writes the
- contents to the argued output file with the name of the input file ahead
- of it.
+ Loads the argued OBJ file with the shared OBJ loader, welds the corners of
+ its faces into vertices, orders them for the vertex cache, and appends the
+ vertices to the object's vertex and normal buffers and the triangles to its
+ index buffer, finds the edges of all of the object's triangles for its edge
+ buffer, and marks the buffers dirty.  Faces are expected to give a vertex
+ and a normal for each corner, as in v//n.
 
  Arguments: char *filename - The name of the OBJ file to read
             Object *obj - The output object
@@ -40,55 +42,42 @@ int parseObjFile
     // Set the filename
     string fn(filename);
     obj->name = fn.substr(0, fn.length()-FEXT_LEN);
-    // Open the file
-    ifstream inFile(fn);
-    if (!inFile.is_open()) {
-        cout << "unable to open " << fn << endl;
+
+    objMeshView mesh;
+    if (mesh.openOptimized(fn))
         return 1;
+
+    // Each distinct combination of position, texture coordinate and normal
+    // is stored once, and the triangles index them.  A corner without a
+    // normal gets a zero normal.
+    weldedMesh welded;
+    weldMesh(&mesh, &welded);
+
+    // Draw the triangles in an order that reuses transformed vertices,
+    // unless objcache -O already stored them in one
+    if (!mesh.isOptimized()) {
+        meshOptimizeStats stats;
+        optimizeMesh(&welded, &stats);
     }
 
-    // Initiate vectors that will contain all vertices and normals.  Then, when
-    // we populate the vectors in the Object struct, we will index from these.
-    vector<Triple> vertices;
-    vertices.push_back(Triple(0, 0, 0));
-    vector<Triple> normals;
-    normals.push_back(Triple(0, 0, 0));
-
-    // The string buffer that will be read
-    string line;
-    // Read each line and create an element
-    while (getline(inFile, line)) {
-        // Split the space-separated line into a vector of strings
-        vector<string> vals;
-        string temp;
-        stringstream s(line);
-        while (s >> temp)
-            vals.push_back(temp);
-
-        // Handle the line according to its identifier (vertex or facet)
-        if (vals[0] == "v") {
-            // Is a vertex -- vals contains 'v' then 3 floats
-            Triple ver(stof(vals[1]), stof(vals[2]), stof(vals[3]));
-            vertices.push_back(ver);
-        } else if (vals[0] == "vn") {
-            Triple vn(stof(vals[1]), stof(vals[2]), stof(vals[3]));
-            normals.push_back(vn);
-        } else if (vals[0] == "f") {
-            // Is a facet -- vals contains 'f' then 3 ints//int values
-            for (int i = 0; i < 3; ++i) {
-                int delimiterIdx = vals[i+1].find("//");
-                obj->vertex_buffer.push_back(
-                    vertices[stoi(vals[i+1].substr(0, delimiterIdx))]);
-                obj->normal_buffer.push_back(
-                    normals[stoi(vals[i+1].substr(delimiterIdx+2))]);
-            }
-        } else {
-            cout << "error parsing " << fn << endl;
-            inFile.close();
-            return 1;
-        }
+    unsigned int base = obj->vertex_buffer.size();
+    int nVertices = welded.numVertices();
+    obj->vertex_buffer.reserve(base + nVertices);
+    obj->normal_buffer.reserve(base + nVertices);
+    const float *v = welded.positions.data();
+    const float *n = welded.normals.data();
+    for (int i = 0; i < nVertices; ++i, v += 3, n += 3) {
+        obj->vertex_buffer.push_back(Triple(v[0], v[1], v[2]));
+        obj->normal_buffer.push_back(Triple(n[0], n[1], n[2]));
     }
-    inFile.close();
+
+    obj->index_buffer.reserve(obj->index_buffer.size() +
+        welded.indices.size());
+    vector<unsigned int>::iterator i = welded.indices.begin();
+    for (; i != welded.indices.end(); ++i)
+        obj->index_buffer.push_back(base + *i);
+    findEdges(obj->index_buffer, obj->vertex_buffer.size(), &obj->edge_buffer);
+    obj->buffers_dirty = true;
 
     return 0;
 }
@@ -18,6 +18,9 @@
 #include <assert.h>
 
 #include "utils.h"
+#include "meshCache.h"
+#include "meshWeld.h"
+#include "meshOptimize.h"
 
 
 #define FEXT_LEN        4         // Number of characters in OBJ file extension
@@ -85,8 +88,8 @@ struct Transforms
 
 /* The following struct is used to represent objects.
  *
- * The main things to note here are the 'vertex_buffer' and 'normal_buffer'
- * vectors.
+ * The main things to note here are the 'vertex_buffer', 'normal_buffer' and
+ * 'index_buffer' vectors.
  *
  * You will see later in the 'draw_objects' function that OpenGL requires
  * us to supply it all the faces that make up an object in one giant
@@ -109,13 +112,39 @@ struct Transforms
  *
  * This array of 36 vertices becomes our 'vertex_array'.
  *
- * While it may be obvious to us that some of the vertices in the array are
- * repeats, OpenGL has no way of knowing this. The redundancy is necessary
- * since OpenGL needs the vertices of every face to be explicitly given.
+ * Obviously to us, some of the vertices in that array are repeats. Rather
+ * than give OpenGL every face's vertices explicitly, we give it each
+ * distinct vertex once in 'vertex_buffer', and say which vertices make up
+ * each face in 'index_buffer'. With the cube example, if each corner of the
+ * cube has one normal, 'vertex_buffer' holds just the 8 corners and
+ * 'index_buffer' holds the 24 indices of the corners of the faces, in the
+ * order above.
  *
  * The 'normal_buffer' stores all the normals corresponding to the vertices
- * in the 'vertex_buffer'. With the cube example, since the "vertex array"
- * has "36" vertices, the "normal array" also has "36" normals.
+ * in the 'vertex_buffer', so a vertex that is used with two different
+ * normals is stored twice. Our faces are triangles, so every 3 consecutive
+ * indices in 'index_buffer' make up one face.
+ *
+ * 'edge_buffer' is only used to draw wireframes. It holds every edge of
+ * the faces once as 2 consecutive indices, so an edge shared by two faces
+ * is drawn once rather than twice.
+ *
+ * The buffers live in our program's memory. To draw from them, OpenGL has
+ * to copy them to the graphics card every frame. Instead, we can copy them
+ * once into "buffer objects" (VBOs) on the graphics card and draw from
+ * those. 'vertex_vbo', 'normal_vbo', 'index_vbo' and 'edge_vbo' name the
+ * buffer objects, and are 0 until the first copy. 'buffers_dirty' says the
+ * buffers have changed since they were last copied, and must be set
+ * whenever they are edited so the change is copied before the next draw.
+ * See the 'upload_object' function for details.
+ *
+ * 'model_matrix' is all of the transformations in 'transform_sets'
+ * multiplied together, so the object can be placed with one matrix rather
+ * than by redoing every transformation each time it is drawn. The 16
+ * values are in the column-major order 'glMultMatrixf' takes. Like
+ * 'buffers_dirty', 'model_dirty' says 'transform_sets' has changed since
+ * the matrix was last made, and must be set whenever they are edited. See
+ * the 'composeTransforms' function for details.
  */
 struct Object
 {
@@ -127,6 +156,8 @@ struct Object
      */
     std::vector<Triple> vertex_buffer;
     std::vector<Triple> normal_buffer;
+    std::vector<unsigned int> index_buffer;
+    std::vector<unsigned int> edge_buffer;
 
     std::vector<Transforms> transform_sets;
 
@@ -139,6 +170,27 @@ struct Object
     float specular_reflect[3];
 
     float shininess;
+
+    unsigned int vertex_vbo;
+    unsigned int normal_vbo;
+    unsigned int index_vbo;
+    unsigned int edge_vbo;
+    bool buffers_dirty;
+
+    float model_matrix[16];
+    bool model_dirty;
+
+    Object() : shininess (0), vertex_vbo (0), normal_vbo (0), index_vbo (0),
+               edge_vbo (0), buffers_dirty (true), model_dirty (true)
+    {
+        for (int i = 0; i < 3; ++i) {
+            ambient_reflect[i] = 0;
+            diffuse_reflect[i] = 0;
+            specular_reflect[i] = 0;
+        }
+        for (int i = 0; i < 16; ++i)
+            model_matrix[i] = (i % 5 == 0) ? 1 : 0;
+    }
 };
 
 
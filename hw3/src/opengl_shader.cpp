@@ -1,6 +1,8 @@
 #include <cmath>
 #include <Eigen/Dense>
 #include "parseScene.h"
+#include "headless.h"
+#include "frameTimer.h"
 
 using namespace std;
 using namespace Eigen;
@@ -20,7 +22,9 @@ void display(void);
 
 void init_lights();
 void set_lights();
+void upload_object(Object *obj);
 void draw_objects();
+void draw_headless_frame(int frame, int num_frames);
 
 void mouse_pressed(int button, int state, int x, int y);
 void mouse_moved(int x, int y);
@@ -63,6 +67,31 @@ float x_view_angle = 0, y_view_angle = 0;
 bool is_pressed = false;
 bool wireframe_mode = false;
 
+/* Whether objects are drawn from copies of their buffers kept on the graphics
+ * card ("buffer objects") rather than from our program's memory. See the
+ * 'upload_object' function for details. 'vbo_supported' says whether the
+ * buffer object functions exist at all, which needs OpenGL 1.5. Without
+ * them, 'vbo_mode' stays off. See the 'main' function.
+ */
+bool vbo_mode = true;
+bool vbo_supported = true;
+
+/* Whether wireframes are drawn by outlining the faces with 'glPolygonMode'
+ * rather than drawing each edge as a line. See the 'draw_objects' function
+ * for details.
+ */
+bool polygon_wireframe = false;
+
+/* Times frames and shows the times in the window's title once 'f' turns
+ * it on. See frameTimer.cpp for details.
+ */
+frameTimer frame_timer("Test");
+
+/* Whether we are drawing frames without a window, as asked for with
+ * '-headless' on the command line. See the 'main' function for details.
+ */
+bool headless_mode = false;
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -294,6 +323,11 @@ void reshape(int width, int height)
  */
 void display(void)
 {
+    /* We note when we start drawing so we can show how long the frame took
+     * (see the 'frame_timer' variable).
+     */
+    frame_timer.startFrame();
+
     /* The following line of code is typically the first line of code in any
      * 'display' function. It tells OpenGL to reset the "color buffer" (which
      * is our pixel grid of RGB values) and the depth buffer.
@@ -460,9 +494,28 @@ void display(void)
      * RGB pixel grids and the depth buffer respectively.
      *
      * The following function, 'glutSwapBuffers', tells OpenGL to swap the
-     * active and off-screen buffers.
+     * active and off-screen buffers. The frame is timed before the swap,
+     * which could also wait for the screen to refresh.
      */
-    glutSwapBuffers();
+    if(!headless_mode)
+    {
+        frame_timer.endFrame();
+        glutSwapBuffers();
+    }
+}
+
+/* 'draw_headless_frame' function:
+ *
+ * Draws one of the frames asked for with '-headless'. The camera circles
+ * the scene once over all of the frames, so we turn the scene about its y
+ * axis a little more each frame. There is no window and no buffers to swap,
+ * so 'display' leaves the frame where it was drawn for 'runHeadless' to
+ * read back (see headless.cpp).
+ */
+void draw_headless_frame(int frame, int num_frames)
+{
+    x_view_angle = 360.0 * frame / num_frames;
+    display();
 }
 
 /* 'init_lights' function:
@@ -567,6 +620,64 @@ void set_lights()
     }
 }
 
+/* 'upload_object' function:
+ *
+ * Copies an object's vertex, normal, index and edge buffers into OpenGL
+ * "buffer objects" (VBOs), which live in the graphics card's memory.
+ *
+ * When we give 'glVertexPointer' and friends a pointer into our program's
+ * memory, OpenGL has to read the whole array over again every time we draw,
+ * since it has no way of knowing whether we changed it. For big objects,
+ * that copying takes far longer than the drawing itself. A buffer object
+ * is an array that OpenGL owns instead. We copy our arrays into buffer
+ * objects once, and from then on draw straight from them, so drawing an
+ * object costs the same few calls however many vertices it has.
+ *
+ * The copy is only made again when the object's 'buffers_dirty' flag says
+ * its buffers changed.
+ */
+void upload_object(Object *obj)
+{
+    /* 'glGenBuffers' gives us names for new buffer objects, the same way
+     * 'glGenTextures' gives names for textures. We only need to do this the
+     * first time an object is uploaded.
+     */
+    if(obj->vertex_vbo == 0)
+    {
+        GLuint names[4];
+        glGenBuffers(4, names);
+        obj->vertex_vbo = names[0];
+        obj->normal_vbo = names[1];
+        obj->index_vbo = names[2];
+        obj->edge_vbo = names[3];
+    }
+
+    /* 'glBindBuffer' makes a buffer object the current one for a target.
+     * 'GL_ARRAY_BUFFER' is the target 'glVertexPointer' and 'glNormalPointer'
+     * read from, and 'GL_ELEMENT_ARRAY_BUFFER' is the one 'glDrawElements'
+     * reads indices from. 'glBufferData' then copies our array into the
+     * current buffer object of a target. 'GL_STATIC_DRAW' hints to OpenGL
+     * that we will draw from the buffer many times but rarely change it, so
+     * it should keep the buffer where drawing from it is fastest.
+     */
+    glBindBuffer(GL_ARRAY_BUFFER, obj->vertex_vbo);
+    glBufferData(GL_ARRAY_BUFFER, obj->vertex_buffer.size() * sizeof(Triple),
+                 obj->vertex_buffer.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, obj->normal_vbo);
+    glBufferData(GL_ARRAY_BUFFER, obj->normal_buffer.size() * sizeof(Triple),
+                 obj->normal_buffer.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->index_vbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 obj->index_buffer.size() * sizeof(GLuint),
+                 obj->index_buffer.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obj->edge_vbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 obj->edge_buffer.size() * sizeof(GLuint),
+                 obj->edge_buffer.data(), GL_STATIC_DRAW);
+
+    obj->buffers_dirty = false;
+}
+
 /* 'draw_objects' function:
  *
  * This function has OpenGL render our objects to the display screen. It
@@ -599,9 +710,7 @@ void draw_objects()
         /* The following brace is not necessary, but it keeps things organized.
          */
         {
-            int num_transform_sets = objects[i].transform_sets.size();
-
-            /* The loop tells OpenGL to modify our modelview matrix with the
+            /* The following tells OpenGL to modify our modelview matrix with the
              * desired geometric transformations for this object. Remember
              * though that our 'transform_sets' struct assumes that transformations
              * are conveniently given in sets of translation -> rotate -> scaling;
@@ -616,7 +725,7 @@ void draw_objects()
              *    translate by 2, 0, 5
              *    rotate about 0, 1, 0.5 and by angle = 0.6 radians
              *
-             * Obviously, we cannot use the following loop for this, because the order
+             * Obviously, we cannot store this as a single set, because the order
              * is not translate -> rotate -> scale. Instead, we need to make the following
              * calls in this exact order:
              *
@@ -630,20 +739,20 @@ void draw_objects()
              *
              * Keep all this in mind to come up with an appropriate way to store and apply
              * geometric transformations for each object in your scenes.
+             *
+             * Each of those calls multiplies the Modelview Matrix by another
+             * matrix, and an object's transformations do not change from
+             * frame to frame. So rather than making every call each time we
+             * draw, we multiply the matrices together once when the scene
+             * is parsed (see the 'composeTransforms' function) and hand the
+             * result to 'glMultMatrixf', which multiplies the Modelview
+             * Matrix by it just as the calls would have. If the object's
+             * transformations are edited, 'model_dirty' is set and we
+             * multiply them together again here.
              */
-            for(int j = 0; j < num_transform_sets; ++j)
-            {
-                glTranslatef(objects[i].transform_sets[j].translation[0],
-                             objects[i].transform_sets[j].translation[1],
-                             objects[i].transform_sets[j].translation[2]);
-                glRotatef(objects[i].transform_sets[j].rotation_angle,
-                          objects[i].transform_sets[j].rotation[0],
-                          objects[i].transform_sets[j].rotation[1],
-                          objects[i].transform_sets[j].rotation[2]);
-                glScalef(objects[i].transform_sets[j].scaling[0],
-                         objects[i].transform_sets[j].scaling[1],
-                         objects[i].transform_sets[j].scaling[2]);
-            }
+            if(objects[i].model_dirty)
+                composeTransforms(&objects[i]);
+            glMultMatrixf(objects[i].model_matrix);
 
             /* The 'glMaterialfv' and 'glMaterialf' functions tell OpenGL
              * the material properties of the surface we want to render.
@@ -685,8 +794,9 @@ void draw_objects()
              *  face6vertex1, face6vertex2, face6vertex3, face6vertex4]
              *
              * Obviously to us, some of the vertices in the array are repeats.
-             * However, the repeats cannot be avoided since OpenGL requires
-             * this explicit specification of the faces.
+             * We avoid the repeats by giving OpenGL each distinct vertex only
+             * once, and then listing the vertices of each face by their
+             * indices in the 'index_buffer' (see the 'Object' struct).
              *
              * The parameters to the 'glVertexPointer' function are as
              * follows:
@@ -714,32 +824,75 @@ void draw_objects()
              * - void* pointer_to_array: this parameter is the pointer to
              *                           our vertex array.
              */
-            glVertexPointer(3, GL_FLOAT, 0, &objects[i].vertex_buffer[0]);
-            /* The "normal array" is the equivalent array for normals.
-             * Each normal in the normal array corresponds to the vertex
-             * of the same index in the vertex array.
-             *
-             * The 'glNormalPointer' function has the following parameters:
-             *
-             * - enum type_of_normals: e.g. int, float, double, etc
-             * - sizei stride: same as the stride parameter in 'glVertexPointer'
-             * - void* pointer_to_array: the pointer to the normal array
-             */
-            glNormalPointer(GL_FLOAT, 0, &objects[i].normal_buffer[0]);
+            const GLuint *indices;
+            if(vbo_mode)
+            {
+                /* In "VBO mode", the arrays are already on the graphics card
+                 * unless they changed since they were last copied there (see
+                 * the 'upload_object' function).
+                 *
+                 * While a buffer object is bound to 'GL_ARRAY_BUFFER', the
+                 * last parameter of 'glVertexPointer' and 'glNormalPointer'
+                 * is an offset in bytes into the buffer object rather than
+                 * a pointer. The same goes for the index parameter of
+                 * 'glDrawElements' and 'GL_ELEMENT_ARRAY_BUFFER'. All of our
+                 * arrays start at the start of their buffer objects, so the
+                 * offsets are 0.
+                 */
+                if(objects[i].buffers_dirty || objects[i].vertex_vbo == 0)
+                    upload_object(&objects[i]);
+
+                glBindBuffer(GL_ARRAY_BUFFER, objects[i].vertex_vbo);
+                glVertexPointer(3, GL_FLOAT, 0, (const GLvoid *) 0);
+                glBindBuffer(GL_ARRAY_BUFFER, objects[i].normal_vbo);
+                glNormalPointer(GL_FLOAT, 0, (const GLvoid *) 0);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects[i].index_vbo);
+                indices = (const GLuint *) 0;
+            }
+            else
+            {
+                /* Binding buffer object 0 goes back to reading arrays from
+                 * our program's memory. Without buffer objects, there is
+                 * nothing to unbind, and no 'glBindBuffer' to call.
+                 */
+                if(vbo_supported)
+                {
+                    glBindBuffer(GL_ARRAY_BUFFER, 0);
+                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                }
+                glVertexPointer(3, GL_FLOAT, 0, &objects[i].vertex_buffer[0]);
+                /* The "normal array" is the equivalent array for normals.
+                 * Each normal in the normal array corresponds to the vertex
+                 * of the same index in the vertex array.
+                 *
+                 * The 'glNormalPointer' function has the following
+                 * parameters:
+                 *
+                 * - enum type_of_normals: e.g. int, float, double, etc
+                 * - sizei stride: same as the stride parameter in
+                 *                 'glVertexPointer'
+                 * - void* pointer_to_array: the pointer to the normal array
+                 */
+                glNormalPointer(GL_FLOAT, 0, &objects[i].normal_buffer[0]);
+                indices = objects[i].index_buffer.data();
+            }
 
-            int buffer_size = objects[i].vertex_buffer.size();
+            int buffer_size = objects[i].index_buffer.size();
 
             if(!wireframe_mode)
                 /* Finally, we tell OpenGL to render everything with the
-                 * 'glDrawArrays' function. The parameters are:
+                 * 'glDrawElements' function. The parameters are:
                  *
                  * - enum mode: in our case, we want to render triangles,
                  *              so we specify 'GL_TRIANGLES'. If we wanted
                  *              to render squares, then we would use
                  *              'GL_QUADS' (for quadrilaterals).
-                 * - int start_index: the index of the first vertex
-                 *                    we want to render in our array
-                 * - int num_vertices: number of vertices to render
+                 * - int num_indices: number of indices to render, each of
+                 *                    which is one corner of a face
+                 * - enum type_of_indices: our indices are unsigned ints,
+                 *                         hence 'GL_UNSIGNED_INT'
+                 * - void* pointer_to_indices: the first index we want to
+                 *                             render in our index array
                  *
                  * As OpenGL renders all the faces, it automatically takes
                  * into account all the specifications we have given it to
@@ -749,18 +902,47 @@ void draw_objects()
                  * using our Viewport specification. Everything is rendered
                  * onto the off-screen buffer.
                  */
-                glDrawArrays(GL_TRIANGLES, 0, buffer_size);
+                glDrawElements(GL_TRIANGLES, buffer_size, GL_UNSIGNED_INT,
+                               indices);
+            else if(polygon_wireframe)
+            {
+                /* 'glPolygonMode' tells OpenGL to draw the outlines of
+                 * faces ('GL_LINE') rather than fill them in ('GL_FILL'),
+                 * so we can draw a wireframe from the same indices as the
+                 * surface. Backface culling still applies, so only the
+                 * faces facing us are outlined.
+                 */
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+                glDrawElements(GL_TRIANGLES, buffer_size, GL_UNSIGNED_INT,
+                               indices);
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            }
             else
+            {
                 /* If we are in "wireframe mode" (see the 'key_pressed'
                  * function for more information), then we want to render
                  * lines instead of triangle surfaces. To render lines,
-                 * we use the 'GL_LINE_LOOP' enum for the mode parameter.
-                 * However, we need to draw each face frame one at a time
-                 * to render the wireframe correctly. We can do so with a
-                 * for loop:
+                 * we use the 'GL_LINES' enum for the mode parameter, which
+                 * draws a line between every 2 consecutive indices. Drawing
+                 * the outline of each face would draw every edge shared by
+                 * two faces twice, so we draw from 'edge_buffer' instead,
+                 * which holds each edge once (see the 'Object' struct).
+                 * Every line is drawn with this one call.
                  */
-                for(int j = 0; j < buffer_size; j += 3)
-                    glDrawArrays(GL_LINE_LOOP, j, 3);
+                const GLuint *edges;
+                if(vbo_mode)
+                {
+                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                                 objects[i].edge_vbo);
+                    edges = (const GLuint *) 0;
+                }
+                else
+                {
+                    edges = objects[i].edge_buffer.data();
+                }
+                glDrawElements(GL_LINES, objects[i].edge_buffer.size(),
+                               GL_UNSIGNED_INT, edges);
+            }
         }
         /* As discussed before, we use 'glPopMatrix' to get back the
          * version of the Modelview Matrix that we had before we specified
@@ -996,6 +1178,30 @@ void key_pressed(unsigned char key, int x, int y)
          */
         glutPostRedisplay();
     }
+    /* If 'v' is pressed, toggle our 'vbo_mode' boolean to switch between
+     * drawing from buffer objects and drawing from our program's memory,
+     * unless there are no buffer objects to switch to.
+     */
+    else if(key == 'v')
+    {
+        vbo_mode = vbo_supported && !vbo_mode;
+        glutPostRedisplay();
+    }
+    /* If 'p' is pressed, toggle our 'polygon_wireframe' boolean to switch
+     * how wireframes are drawn.
+     */
+    else if(key == 'p')
+    {
+        polygon_wireframe = !polygon_wireframe;
+        glutPostRedisplay();
+    }
+    /* If 'f' is pressed, toggle showing frame times in the window's title.
+     */
+    else if(key == 'f')
+    {
+        frame_timer.toggle();
+        glutPostRedisplay();
+    }
     else
     {
         /* These might look a bit complicated, but all we are really doing is
@@ -1055,8 +1261,11 @@ void key_pressed(unsigned char key, int x, int y)
  */
 int main(int argc, char* argv[])
 {
+    headlessOptions headless;
+    headless_mode = parseHeadlessOptions(&argc, argv, &headless);
     if (argc != 4) {
-        cout << "usage: ./shaded [file] [yres] [xres]" << endl;
+        cout << "usage: ./shaded [-headless frames prefix] [file] [yres] "
+             << "[xres]" << endl;
         return 1;
     }
     xres = atoi(argv[2]);
@@ -1065,6 +1274,22 @@ int main(int argc, char* argv[])
     map< string, Object* > originals;
     parseScene(argv[1], &cam, &lights, &originals, &objects);
 
+    /* With '-headless', we draw the frames into an image in memory rather
+     * than a window, write each to a file and quit, so we need neither GLUT
+     * nor a display. 'initHeadless' makes what we draw with in place of the
+     * window, sets the viewport as 'reshape' would, and looks up the buffer
+     * object functions as GLEW does below.
+     */
+    if(headless_mode)
+    {
+        if(initHeadless(xres, yres))
+            return 1;
+        init();
+        int status = runHeadless(headless, draw_headless_frame);
+        closeHeadless();
+        return status;
+    }
+
     /* 'glutInit' intializes the GLUT (Graphics Library Utility Toolkit) library.
      * This is necessary, since a lot of the functions we used above and below
      * are from the GLUT library.
@@ -1090,6 +1315,18 @@ int main(int argc, char* argv[])
      */
     glutCreateWindow("Test");
 
+#ifndef __APPLE__
+    /* Buffer objects are part of OpenGL 1.5, so their functions have to be
+     * looked up with GLEW once we have a window. Without them, we can only
+     * draw from our program's memory.
+     */
+    if(glewInit() != GLEW_OK || !GLEW_VERSION_1_5)
+    {
+        vbo_supported = false;
+        vbo_mode = false;
+    }
+#endif
+
     /* Call our 'init' function...
      */
     init();
@@ -113,6 +113,7 @@ struct Camera {
 };
 
 // Externally public functions
+void composeTransforms (Object*);
 int parseScene (char*, Camera*, std::vector<Point_Light>*, std::map<std::string, Object*>*, std::vector<Object>*);
 
 #endif // ifndef PARSESCENE
@@ -26,4 +26,10 @@ static const float default_cam_far = 20.0;
 static const int default_cam_x_res = 1000;
 static const int default_cam_y_res = 1000;
 
+/* profiler */
+static const int profiler_frame_history = 600;
+static const int profiler_query_latency = 3;
+static const int profiler_overlay_interval = 30;
+static const char profiler_csv_filename[] = "output/frame_times.csv";
+
 #endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "display.hpp"
 
 #include "view.hpp"
+#include "profiler.hpp"
 
 /******************* DISPLAY CLASS MEMBER FUNCTION DEFINITIONS ****************/
 
@@ -161,7 +162,10 @@ void Display::update(int usecs) {
     DEBUG_assert(this->view);
     DEBUG_assert(this->timer);
 
-    Display::display->view->update(usecs);
+    {
+        CPUTimerScope update_timer(PT_UPDATE);
+        Display::display->view->update(usecs);
+    }
 
     // display
     glutPostRedisplay();
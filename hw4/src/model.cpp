@@ -2,6 +2,9 @@
 #define DEBUG_ASSERT
 
 #include "model.hpp"
+#include "meshCache.h"
+#include "meshWeld.h"
+#include "meshOptimize.h"
 
 /********************************* Model Class ********************************/
 
@@ -59,133 +62,51 @@ const Material &Model::getMaterial() {
     return this->material;
 }
 
-// To keep things simple, this function assumes that there is one normal per
-// vertex. This is usually the case for simplistic surfaces with Euler
-// Characteristic of 2. Thankfully most meshes can be represented as polyhedrons
-// with no holes.
-// There are other assumptions made so make sure the input OBJ files follow the
-// strict requirements of this function.
+// The file is read by the OBJ loader shared by every assignment, which maps
+// a binary cache kept next to the file when there is one, preferring the
+// optimized one objcache -O writes. Face corners index positions, normals
+// and texture coordinates separately, so the corners are welded into one
+// vertex for every distinct combination of the three, which the indices then
+// refer to, and the triangles and vertices are reordered so the GPU's
+// post-transform cache gets reused.
 void Model::loadObjFile(const char *filename) {
     DEBUG_assert(this->vertices.empty());
     DEBUG_assert(this->indices.empty());
 
-    const int buffer_size = 256;
-    char buffer[buffer_size];
-    std::ifstream obj_file(filename);
-    if (obj_file.is_open()) {
-        int cursor = obj_file.tellg();
-
-        this->vertices.push_back(Vertex());
-
-        // parse vertices
-        while (obj_file.getline(buffer, buffer_size)) {
-            char *data_entry_type = strtok(buffer, " ");
-            if (strcmp(data_entry_type, "v") == 0) {
-                char *val0 = strtok(NULL, " ");
-                char *val1 = strtok(NULL, " ");
-                char *val2 = strtok(NULL, " ");
-                if (strtok(NULL, " ") != NULL) {
-                    fprintf(stderr, "invalid syntax. skipping file\n");
-                    this->vertices.clear();
-                    this->indices.clear();
-                    return;
-                }
-
-                this->vertices.push_back(Vertex());
-                this->vertices.rbegin()->coord[0] = atof(val0) / 3;
-                this->vertices.rbegin()->coord[1] = atof(val1) / 3;
-                this->vertices.rbegin()->coord[2] = atof(val2) / 3;
-            } else {
-                obj_file.seekg(cursor, std::ios_base::beg);
-                break;
-            }
-
-            cursor = obj_file.tellg();
-        }
-
-        // parse normals
-        size_t normal_cursor = 1;
-        while (obj_file.getline(buffer, buffer_size)) {
-            char *data_entry_type = strtok(buffer, " ");
-            if (strcmp(data_entry_type, "vn") == 0) {
-                char *val0 = strtok(NULL, " ");
-                char *val1 = strtok(NULL, " ");
-                char *val2 = strtok(NULL, " ");
-                if (strtok(NULL, " ") != NULL) {
-                    fprintf(stderr, "invalid syntax. skipping file\n");
-                    this->vertices.clear();
-                    this->indices.clear();
-                    return;
-                }
-
-                this->vertices[normal_cursor].normal[0] = atof(val0);
-                this->vertices[normal_cursor].normal[1] = atof(val1);
-                this->vertices[normal_cursor].normal[2] = atof(val2);
-            } else {
-                obj_file.seekg(cursor, std::ios_base::beg);
-                break;
-            }
-
-            cursor = obj_file.tellg();
-            normal_cursor++;
-        }
-        DEBUG_assert(normal_cursor == this->vertices.size());
-
-        // parse faces
-        while (obj_file.getline(buffer, buffer_size)) {
-            char *data_entry_type = strtok(buffer, " ");
-            if (strcmp(data_entry_type, "f") == 0) {
-                char *val0 = strtok(NULL, " ");
-                char *val1 = strtok(NULL, " ");
-                char *val2 = strtok(NULL, " ");
-                if (strtok(NULL, " ") != NULL) {
-                    fprintf(stderr, "invalid syntax. skipping file\n");
-                    this->vertices.clear();
-                    this->indices.clear();
-                    return;
-                }
-
-                // check for '/'
-                char *slash;
-                GLuint v_index;
-                GLuint vn_index;
-
-                slash = strtok(val0, "/");
-                DEBUG_assert(slash != NULL);
-                v_index = atoi(val0);
-                val0 = strtok(NULL, "/");
-                DEBUG_assert(val0 != NULL);
-                vn_index = atoi(val0);
-                DEBUG_assert(v_index == vn_index);
-                this->indices.push_back(v_index);
-
-                slash = strtok(val1, "/");
-                DEBUG_assert(slash != NULL);
-                v_index = atoi(val1);
-                val1 = strtok(NULL, "/");
-                DEBUG_assert(val1 != NULL);
-                vn_index = atoi(val1);
-                DEBUG_assert(v_index == vn_index);
-                this->indices.push_back(v_index);
-
-                slash = strtok(val2, "/");
-                DEBUG_assert(slash != NULL);
-                v_index = atoi(val2);
-                val2 = strtok(NULL, "/");
-                DEBUG_assert(val2 != NULL);
-                vn_index = atoi(val2);
-                DEBUG_assert(v_index == vn_index);
-                this->indices.push_back(v_index);
-            } else {
-                obj_file.seekg(cursor, std::ios_base::beg);
-                break;
-            }
+    objMeshView mesh;
+    if (mesh.openOptimized(filename)) {
+        fprintf(stderr, "can't load obj file: %s\n", filename);
+        return;
+    }
+    weldedMesh welded;
+    weldMesh(&mesh, &welded);
+
+    // reorder for the post-transform cache unless objcache -O already did
+    if (!mesh.isOptimized()) {
+        meshOptimizeStats stats;
+        optimizeMesh(&welded, &stats);
+        DEBUG_printf("%s: ACMR %.3f -> %.3f\n", filename, stats.acmrBefore,
+            stats.acmrAfter);
+    }
 
-            cursor = obj_file.tellg();
-        }
-    } else {
-        fprintf(stderr, "can't open obj file: %s\n", filename);
+    const size_t n_vertices = welded.numVertices();
+    this->vertices.resize(n_vertices, Vertex());
+    for (size_t i = 0; i < n_vertices; i++) {
+        Vertex &vertex = this->vertices[i];
+        const float *coord = &welded.positions[3 * i];
+        const float *normal = &welded.normals[3 * i];
+        const float *uv = &welded.texCoords[2 * i];
+        vertex.coord[0] = coord[0] / 3;
+        vertex.coord[1] = coord[1] / 3;
+        vertex.coord[2] = coord[2] / 3;
+        vertex.normal[0] = normal[0];
+        vertex.normal[1] = normal[1];
+        vertex.normal[2] = normal[2];
+        vertex.uv[0] = uv[0];
+        vertex.uv[1] = uv[1];
     }
+
+    this->indices.assign(welded.indices.begin(), welded.indices.end());
 }
 
 void Model::bind() {
@@ -0,0 +1,353 @@
+// #define DEBUG_PRINT
+#define DEBUG_ASSERT
+
+#include "profiler.hpp"
+
+static const char *profile_time_names[PT_COUNT] =
+    {"frame", "update", "render", "swap", "gpu"};
+
+// milliseconds between two points in time
+static double elapsedMs(
+    boost::chrono::steady_clock::time_point start,
+    boost::chrono::steady_clock::time_point end)
+{
+    return boost::chrono::duration<double, boost::milli>(end - start).count();
+}
+
+// clears a frame's times for it to be timed
+static void clearFrame(FrameStats &stats, int frame) {
+    stats.frame = frame;
+    stats.draw_count = 0;
+    for (int i = 0; i < PT_COUNT; i++) {
+        stats.ms[i] = 0.0;
+    }
+    stats.ms[PT_GPU] = -1.0;
+}
+
+/****************** PROFILER CLASS MEMBER FUNCTION DEFINITIONS ****************/
+
+Profiler *Profiler::profiler = NULL;
+
+Profiler::Profiler() :
+    history(profiler_frame_history),
+    frame_count(0),
+    current(),
+    last_frame_end(boost::chrono::steady_clock::now()),
+    gpu_timing(false),
+    query_active(false),
+    show_overlay(false),
+    overlay_lines()
+{
+    for (int i = 0; i < profiler_frame_history; i++) {
+        clearFrame(this->history[i], k_invalid_index);
+    }
+    clearFrame(this->current, 0);
+    for (int i = 0; i < profiler_query_latency; i++) {
+        this->queries_used[i] = 0;
+        this->query_frame[i] = k_invalid_index;
+    }
+}
+
+Profiler::~Profiler() {
+    //
+}
+
+Profiler *Profiler::instance() {
+    if (Profiler::profiler == NULL) {
+        Profiler::profiler = new Profiler();
+        atexit(Profiler::exitCallback);
+    }
+
+    return Profiler::profiler;
+}
+
+// writes the frames kept when the program exits (STATIC CALLBACK)
+// the context may be gone by now, so this must not touch OpenGL
+void Profiler::exitCallback() {
+    DEBUG_assert(Profiler::profiler);
+
+    const Profiler *prof = Profiler::profiler;
+    if (prof->frame_count == 0) {
+        return;
+    }
+
+    if (prof->writeCSV(profiler_csv_filename)) {
+        printf("wrote %d frame times to %s\n",
+            std::min(prof->frame_count, profiler_frame_history),
+            profiler_csv_filename);
+    }
+    for (int i = 0; i < PT_COUNT; i++) {
+        TimeSummary summary = prof->summarize((ProfileTime) i);
+        if (summary.count > 0) {
+            printf("%-7s min %7.2f  avg %7.2f  p99 %7.2f ms\n",
+                profile_time_names[i], summary.min, summary.avg, summary.p99);
+        }
+    }
+}
+
+// checks for timer queries once there is a context
+void Profiler::setupGL() {
+    this->gpu_timing = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (!this->gpu_timing) {
+        printf("WARNING: no timer queries, GPU times will not be kept\n");
+    }
+    this->last_frame_end = boost::chrono::steady_clock::now();
+}
+
+void Profiler::addTime(ProfileTime time, double ms) {
+    DEBUG_assert(time != PT_GPU);
+    this->current.ms[time] += ms;
+}
+
+void Profiler::beginDraw() {
+    this->current.draw_count++;
+    if (!this->gpu_timing) {
+        return;
+    }
+    DEBUG_assert(!this->query_active);
+
+    int slot = this->frame_count % profiler_query_latency;
+    std::vector<GLuint> &slot_queries = this->queries[slot];
+    if (this->queries_used[slot] == (int) slot_queries.size()) {
+        GLuint query;
+        glGenQueries(1, &query);
+        slot_queries.push_back(query);
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, slot_queries[this->queries_used[slot]]);
+    this->query_active = true;
+}
+
+void Profiler::endDraw() {
+    if (!this->query_active) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    this->queries_used[this->frame_count % profiler_query_latency]++;
+    this->query_active = false;
+}
+
+// reads the GPU time of the frame whose queries are in the slot
+// the frame was profiler_query_latency frames ago, so the results should be
+// ready, but reading them waits for the GPU if not
+void Profiler::resolveQueries(int slot) {
+    int frame = this->query_frame[slot];
+    if (frame == k_invalid_index) {
+        return;
+    }
+
+    GLuint64 total_ns = 0;
+    for (int i = 0; i < this->queries_used[slot]; i++) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(this->queries[slot][i], GL_QUERY_RESULT, &ns);
+        total_ns += ns;
+    }
+
+    FrameStats &stats = this->history[frame % profiler_frame_history];
+    if (stats.frame == frame) {
+        stats.ms[PT_GPU] = total_ns / 1.0e6;
+    }
+
+    this->queries_used[slot] = 0;
+    this->query_frame[slot] = k_invalid_index;
+}
+
+void Profiler::endFrame() {
+    boost::chrono::steady_clock::time_point now =
+        boost::chrono::steady_clock::now();
+    this->current.ms[PT_FRAME] = elapsedMs(this->last_frame_end, now);
+    this->last_frame_end = now;
+
+    // keep the frame, and note which queries to read its GPU time from
+    int slot = this->frame_count % profiler_query_latency;
+    this->history[this->frame_count % profiler_frame_history] = this->current;
+    this->query_frame[slot] = this->gpu_timing ?
+        this->frame_count : k_invalid_index;
+    this->frame_count++;
+
+    // the next frame reuses the oldest queries, so read them first
+    slot = this->frame_count % profiler_query_latency;
+    if (this->gpu_timing) {
+        this->resolveQueries(slot);
+    }
+    clearFrame(this->current, this->frame_count);
+
+    if (this->show_overlay &&
+        this->frame_count % profiler_overlay_interval == 0)
+    {
+        this->updateOverlay();
+    }
+}
+
+// summarizes one of the times over the frames kept, leaving out frames whose
+// GPU time has not been read yet
+TimeSummary Profiler::summarize(ProfileTime time) const {
+    std::vector<double> samples;
+    samples.reserve(profiler_frame_history);
+    for (const FrameStats &stats : this->history) {
+        if (stats.frame != k_invalid_index && stats.ms[time] >= 0.0) {
+            samples.push_back(stats.ms[time]);
+        }
+    }
+
+    TimeSummary summary = {(int) samples.size(), 0.0, 0.0, 0.0};
+    if (samples.empty()) {
+        return summary;
+    }
+
+    double total = 0.0;
+    summary.min = samples[0];
+    for (double ms : samples) {
+        total += ms;
+        summary.min = std::min(summary.min, ms);
+    }
+    summary.avg = total / samples.size();
+
+    // the 99th percentile is the sample 99% of the way up the sorted samples
+    size_t p99_index = (size_t) (0.99 * (samples.size() - 1) + 0.5);
+    std::nth_element(
+        samples.begin(),
+        samples.begin() + p99_index,
+        samples.end());
+    summary.p99 = samples[p99_index];
+
+    return summary;
+}
+
+void Profiler::toggleOverlay() {
+    this->show_overlay = !this->show_overlay;
+    if (this->show_overlay) {
+        this->updateOverlay();
+    }
+}
+
+// remakes the overlay's text, which is only done every few frames so the
+// numbers can be read
+void Profiler::updateOverlay() {
+    char line[128];
+    int frames = std::min(this->frame_count, profiler_frame_history);
+    int draws = 0;
+    for (const FrameStats &stats : this->history) {
+        if (stats.frame != k_invalid_index) {
+            draws += stats.draw_count;
+        }
+    }
+
+    this->overlay_lines.clear();
+    snprintf(line, sizeof(line), "%d frames, %.1f draws/frame (p: hide)",
+        frames, frames > 0 ? (double) draws / frames : 0.0);
+    this->overlay_lines.push_back(line);
+    snprintf(line, sizeof(line), "%-7s %8s %8s %8s", "ms", "min", "avg",
+        "p99");
+    this->overlay_lines.push_back(line);
+
+    for (int i = 0; i < PT_COUNT; i++) {
+        TimeSummary summary = this->summarize((ProfileTime) i);
+        if (summary.count > 0) {
+            snprintf(line, sizeof(line), "%-7s %8.2f %8.2f %8.2f",
+                profile_time_names[i], summary.min, summary.avg, summary.p99);
+        } else {
+            snprintf(line, sizeof(line), "%-7s %8s %8s %8s",
+                profile_time_names[i], "-", "-", "-");
+        }
+        this->overlay_lines.push_back(line);
+    }
+}
+
+// draws the overlay's text in the top left corner of the window, without
+// the scene's shader, lighting or depth test
+void Profiler::drawOverlay() {
+    if (!this->show_overlay) {
+        return;
+    }
+
+    GLint program;
+    GLint viewport[4];
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUseProgram(0);
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, viewport[2], 0, viewport[3]);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glColor3f(1.0, 1.0, 0.0);
+    for (size_t i = 0; i < this->overlay_lines.size(); i++) {
+        glRasterPos2i(10, viewport[3] - 20 - 15 * i);
+        for (char c : this->overlay_lines[i]) {
+            glutBitmapCharacter(GLUT_BITMAP_9_BY_15, c);
+        }
+    }
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    glPopAttrib();
+    glUseProgram(program);
+}
+
+// writes the frames kept, oldest first, one row per frame
+// GPU times that have not been read yet are left empty
+bool Profiler::writeCSV(const char *filename) const {
+    FILE *file = fopen(filename, "w");
+    if (file == NULL) {
+        fprintf(stderr, "couldn't open file %s\n", filename);
+        return false;
+    }
+
+    fprintf(file, "frame,draws");
+    for (int i = 0; i < PT_COUNT; i++) {
+        fprintf(file, ",%s_ms", profile_time_names[i]);
+    }
+    fprintf(file, "\n");
+
+    int first = std::max(0, this->frame_count - profiler_frame_history);
+    for (int frame = first; frame < this->frame_count; frame++) {
+        const FrameStats &stats =
+            this->history[frame % profiler_frame_history];
+        fprintf(file, "%d,%d", stats.frame, stats.draw_count);
+        for (int i = 0; i < PT_COUNT; i++) {
+            if (stats.ms[i] >= 0.0) {
+                fprintf(file, ",%.4f", stats.ms[i]);
+            } else {
+                fprintf(file, ",");
+            }
+        }
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+/**************** TIMER SCOPE CLASS MEMBER FUNCTION DEFINITIONS ***************/
+
+CPUTimerScope::CPUTimerScope(ProfileTime time) :
+    time(time),
+    start(boost::chrono::steady_clock::now())
+{
+    //
+}
+
+CPUTimerScope::~CPUTimerScope() {
+    Profiler::instance()->addTime(this->time,
+        elapsedMs(this->start, boost::chrono::steady_clock::now()));
+}
+
+GPUTimerScope::GPUTimerScope() {
+    Profiler::instance()->beginDraw();
+}
+
+GPUTimerScope::~GPUTimerScope() {
+    Profiler::instance()->endDraw();
+}
@@ -0,0 +1,103 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <string>
+#include <boost/chrono.hpp>
+
+#include "common.hpp"
+
+// times kept for each frame
+// PT_FRAME is from the end of one frame to the end of the next, PT_UPDATE,
+// PT_RENDER and PT_SWAP are CPU time spent in each stage of the frame, and
+// PT_GPU is GPU time spent on the frame's draws
+enum ProfileTime {PT_FRAME, PT_UPDATE, PT_RENDER, PT_SWAP, PT_GPU, PT_COUNT};
+
+// times for one frame, in milliseconds
+// ms[PT_GPU] is negative until the frame's GPU timer queries have been read
+struct FrameStats {
+    int frame;
+    int draw_count;
+    double ms[PT_COUNT];
+};
+
+// summary of one of the times over the frames kept
+struct TimeSummary {
+    int count;
+    double min;
+    double avg;
+    double p99;
+};
+
+/******************************** Profiler Class ******************************/
+
+// class for timing the frames of the Display loop
+// keeps the last profiler_frame_history frames in a ring buffer, draws a
+// summary of them over the scene when the overlay is toggled on, and writes
+// them to profiler_csv_filename when the program exits
+class Profiler {
+private:
+    static Profiler *profiler;
+
+    // ring buffer of finished frames, and the frame being timed
+    std::vector<FrameStats> history;
+    int frame_count;
+    FrameStats current;
+    boost::chrono::steady_clock::time_point last_frame_end;
+
+    // GL_TIME_ELAPSED queries, one set for each frame in flight so results
+    // are read a few frames late rather than stalling on the current frame
+    bool gpu_timing;
+    bool query_active;
+    std::vector<GLuint> queries[profiler_query_latency];
+    int queries_used[profiler_query_latency];
+    int query_frame[profiler_query_latency];
+
+    bool show_overlay;
+    std::vector<std::string> overlay_lines;
+
+    explicit Profiler();
+    ~Profiler();
+
+    void resolveQueries(int slot);
+    void updateOverlay();
+    static void exitCallback();
+
+public:
+    static Profiler *instance();
+
+    void setupGL();
+
+    void addTime(ProfileTime time, double ms);
+    void beginDraw();
+    void endDraw();
+    void endFrame();
+
+    TimeSummary summarize(ProfileTime time) const;
+    void toggleOverlay();
+    void drawOverlay();
+    bool writeCSV(const char *filename) const;
+};
+
+// class for timing the CPU work of a frame stage
+// adds the time from construction to destruction to the current frame
+class CPUTimerScope {
+private:
+    ProfileTime time;
+    boost::chrono::steady_clock::time_point start;
+
+    explicit CPUTimerScope();
+    // ^ disabled
+
+public:
+    explicit CPUTimerScope(ProfileTime time);
+    ~CPUTimerScope();
+};
+
+// class for timing the GPU work of the draws issued while it exists
+class GPUTimerScope {
+public:
+    explicit GPUTimerScope();
+    ~GPUTimerScope();
+};
+
+#endif
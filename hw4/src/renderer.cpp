@@ -4,6 +4,7 @@
 #include "renderer.hpp"
 
 #include "model.hpp"
+#include "profiler.hpp"
 
 void renderModel(Model &model) {
     glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, model.getMaterial().ambient);
@@ -37,11 +38,14 @@ void renderModel(Model &model) {
     glEnableClientState(GL_NORMAL_ARRAY);
     glEnableClientState(GL_INDEX_ARRAY);
 
-    glDrawElements(
-        GL_TRIANGLES,                   // type
-        model.getIndices().size(),     // size
-        GL_UNSIGNED_INT,                // type of index
-        (GLuint*) 0);                   // pointer
+    {
+        GPUTimerScope draw_timer;
+        glDrawElements(
+            GL_TRIANGLES,                   // type
+            model.getIndices().size(),      // size
+            GL_UNSIGNED_INT,                // type of index
+            (GLuint*) 0);                   // pointer
+    }
 
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_NORMAL_ARRAY);
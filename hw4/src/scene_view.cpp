@@ -11,6 +11,7 @@
 #include "light.hpp"
 #include "renderer.hpp"
 #include "model.hpp"
+#include "profiler.hpp"
 
 /******************************* SceneView Class ******************************/
 
@@ -52,6 +53,7 @@ void SceneView::updateCamLookat() {
 void SceneView::setupFunc() {
     // set fullscreen and setup camera
     View::setupFunc();
+    Profiler::instance()->setupGL();
 
     glutFullScreen();
     int screen_xres = glutGet(GLUT_WINDOW_WIDTH);
@@ -98,11 +100,20 @@ void SceneView::displayFunc() {
             this->cam.up[1],
             this->cam.up[2]);
 
-    // render and swap buffers
-    this->render();
-    glutSwapBuffers();
+    // render and swap buffers, timing each
+    {
+        CPUTimerScope render_timer(PT_RENDER);
+        this->render();
+    }
+    Profiler::instance()->drawOverlay();
+    {
+        CPUTimerScope swap_timer(PT_SWAP);
+        glutSwapBuffers();
+    }
 
     glPopMatrix();
+
+    Profiler::instance()->endFrame();
 }
 
 void SceneView::keyPressedFunc(unsigned char key, int x, int y) {
@@ -124,6 +135,9 @@ void SceneView::keyPressedFunc(unsigned char key, int x, int y) {
                 this->cam_angle_velocity = -0.2;
             }
             break;
+        case 'p':
+            Profiler::instance()->toggleOverlay();
+            break;
     }
 }
 
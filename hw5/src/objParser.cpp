@@ -3,7 +3,9 @@
  objParser.cpp
 
  Parses OBJ files and creates an object containing a vector of its
- vertices and normals.
+ vertices and normals.  The files themselves are read by the OBJ loader
+ shared by every assignment, which maps a binary cache kept next to each
+ file instead of parsing the file again on every run.
 
  Usage: ./objParser
 
@@ -104,12 +106,9 @@ void Object::fillNormals() {
 /*
  parseObjFile
 
- Opens the argued OBJ file and creates a vertex for every vertex and a facet
- for every face in the file.  This assumes that the OBJ file is such that
- every line either contains v <float> <float> <float> or f <int> <int> <int>.
- If this is not the case, the behavior is undefined.  It then writes the
- contents to the argued output file with the name of the input file ahead
- of it.
+ Loads the argued OBJ file with the shared OBJ loader and creates a vertex
+ for every vertex and a face for every face in the file.  It then builds the
+ halfedge structure of the object, its vertex normals and its buffers.
 
  Arguments: char *filename - The name of the OBJ file to read
             Object *obj - The output object
@@ -126,12 +125,12 @@ int parseObjFile
     // Set the filename
     string fn(filename);
     obj->name = fn.substr(0, fn.length()-FEXT_LEN);
-    // Open the file
-    ifstream inFile(fn);
-    if (!inFile.is_open()) {
-        cout << "unable to open " << fn << endl;
+
+    // Read the file.  The halfedge structure has its own mesh, so this one
+    // is only used to fill it.
+    objMeshView loaded;
+    if (loaded.open(fn))
         return 1;
-    }
 
     // Shorthand
     vector<Vertex*> *vertices = obj->mesh.vertices;
@@ -144,36 +143,20 @@ int parseObjFile
     vertices->clear();
     faces->clear();
 
+    int nVertices = loaded.numPositions();
+    int nFaces = loaded.numTriangles();
+    vertices->reserve(nVertices + 1);
+    faces->reserve(nFaces);
+
     // Filler because vertices are 1-indexed
     vertices->push_back(NULL);
 
-    // The string buffer that will be read
-    string line;
-    // Read each line and create an element
-    while (getline(inFile, line)) {
-        // Split the space-separated line into a vector of strings
-        vector<string> l;
-        string temp;
-        stringstream s(line);
-        while (s >> temp)
-            l.push_back(temp);
-
-        // Handle the line according to its identifier (vertex or facet)
-        if (l[0] == "v") {
-            // Is a vertex -- l contains 'v' then 3 floats
-            Vertex *v = new Vertex(stof(l[1]), stof(l[2]), stof(l[3]));
-            vertices->push_back(v);
-        } else if (l[0] == "f") {
-            // Is a facet -- l contains 'f' then 3 int values
-            Face *f = new Face(stoi(l[1]), stoi(l[2]), stoi(l[3]));
-            faces->push_back(f);
-        } else {
-            cout << "error parsing " << fn << endl;
-            inFile.close();
-            return 1;
-        }
-    }
-    inFile.close();
+    const float *p = loaded.positions;
+    for (int i = 0; i < nVertices; ++i, p += 3)
+        vertices->push_back(new Vertex(p[0], p[1], p[2]));
+    const int *cv = loaded.faceV;
+    for (int i = 0; i < nFaces; ++i, cv += 3)
+        faces->push_back(new Face(cv[0], cv[1], cv[2]));
 
     // Construct halfedge data structure for object
     build_HE(&(obj->mesh), obj->hevs, obj->hefs);
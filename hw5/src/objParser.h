@@ -18,6 +18,7 @@
 #include <assert.h>
 
 #include "utils.h"
+#include "meshCache.h"
 #include "structs.h"
 #include "halfedge.h"
 
@@ -118,6 +119,14 @@ struct Transforms
  * The 'normal_buffer' stores all the normals corresponding to the vertices
  * in the 'vertex_buffer'. With the cube example, since the "vertex array"
  * has "36" vertices, the "normal array" also has "36" normals.
+ *
+ * 'model_matrix' is all of the transformations in 'transform_sets'
+ * multiplied together, so the object can be placed with one matrix rather
+ * than by redoing every transformation each time it is drawn. The 16
+ * values are in the column-major order 'glMultMatrixf' takes. 'model_dirty'
+ * says 'transform_sets' has changed since the matrix was last made, and
+ * must be set whenever they are edited. See the 'composeTransforms'
+ * function for details.
  */
 struct Object
 {
@@ -145,7 +154,13 @@ struct Object
 
     float shininess;
 
-    Object() : mesh(Mesh_Data()) {}
+    float model_matrix[16];
+    bool model_dirty;
+
+    Object() : mesh(Mesh_Data()), model_dirty(true) {
+        for (int i = 0; i < 16; ++i)
+            model_matrix[i] = (i % 5 == 0) ? 1 : 0;
+    }
     ~Object() {}
 
     void fillNormals();
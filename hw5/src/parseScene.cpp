@@ -10,13 +10,42 @@
 ******************************************************************************/
 
 #include "parseScene.h"
+#include "modelMatrix.h"
 
 using namespace std;
 
+/*
+ composeTransforms
+
+ Multiplies an object's transformations together into its model matrix, the
+ same matrix that calling glTranslatef, glRotatef and glScalef for each of
+ them in order would make.
+
+ Arguments: Object *obj - The object whose transformations to compose
+
+ Returns:   Nothing.
+*/
+void composeTransforms
+(
+    Object              *obj
+)
+{
+    assert(obj);
+
+    identityMatrix(obj->model_matrix);
+    vector<Transforms>::const_iterator t = obj->transform_sets.begin();
+    for (; t != obj->transform_sets.end(); ++t)
+        multTransform(obj->model_matrix, t->translation, t->rotation,
+            t->rotation_angle, t->scaling);
+
+    obj->model_dirty = false;
+}
+
 /*
  getTransforms
 
- For each line, we will create a Transform for the argued object.
+ For each line, we will create a Transform for the argued object, and then
+ compose them all into the object's model matrix.
 
  Arguments: ifstream *openFile - The file being read
             Object *obj - The object to put transformations into
@@ -45,7 +74,7 @@ int getTransforms
         // Done when vals doesn't return with anything, as it is moving on
         // to the next copy
         if (vals.size() == 0)
-            return 0;
+            break;
 
         // Extract the values from the string
         float x = stof(vals[1]), y = stof(vals[2]), z = stof(vals[3]), mag;
@@ -84,6 +113,9 @@ int getTransforms
 
     }
 
+    // Multiply them together now rather than each time the object is drawn
+    composeTransforms(obj);
+
     return 0;
 }
 
@@ -20,6 +20,7 @@ void init_lights();
 // Relevant for displaying objects properly
 void set_lights();
 void draw_objects();
+void draw_headless_frame(int frame, int num_frames);
 
 // Callback functions we supply to OpenGL
 void reshape(int width, int height);
@@ -57,6 +58,13 @@ float x_view_angle = 0, y_view_angle = 0;
 bool is_pressed = false;
 bool wireframe_mode = false;
 
+// Times frames and shows the times in the window's title once 'f' turns it on
+frameTimer frame_timer("OpenGL");
+
+// Whether we are drawing frames without a window, as asked for with
+// -headless on the command line
+bool headless_mode = false;
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -160,6 +168,9 @@ void reshape(int width, int height)
  */
 void display(void)
 {
+    // Note when we start drawing to show how long the frame took
+    frame_timer.startFrame();
+
     /* The following line of code is typically the first line of code in any
      * 'display' function.
      */
@@ -205,7 +216,25 @@ void display(void)
      */
     draw_objects();
 
-    glutSwapBuffers();
+    // Time the frame before the swap, which could also wait for the screen to
+    // refresh.  Without a window, the frame is left where it was drawn for
+    // runHeadless to read
+    if(!headless_mode)
+    {
+        frame_timer.endFrame();
+        glutSwapBuffers();
+    }
+}
+
+/* 'draw_headless_frame' function:
+ *
+ * Draws one of the frames asked for with -headless, with the camera circling
+ * the scene once over all of the frames.
+ */
+void draw_headless_frame(int frame, int num_frames)
+{
+    x_view_angle = 360.0 * frame / num_frames;
+    display();
 }
 
 /* 'init_lights' function
@@ -270,24 +299,14 @@ void draw_objects()
         /* The following brace is not necessary, but it keeps things organized.
          */
         {
-            int num_transform_sets = objects[i].transform_sets.size();
-
-            /* The loop tells OpenGL to modify our modelview matrix with the
-             * desired geometric transformations for this object.
+            /* Modify our modelview matrix with the desired geometric
+             * transformations for this object. They were multiplied together
+             * into one matrix when the scene was parsed (see the
+             * 'composeTransforms' function), so one call applies them all.
              */
-            for(int j = 0; j < num_transform_sets; ++j)
-            {
-                glTranslatef(objects[i].transform_sets[j].translation[0],
-                             objects[i].transform_sets[j].translation[1],
-                             objects[i].transform_sets[j].translation[2]);
-                glRotatef(objects[i].transform_sets[j].rotation_angle,
-                          objects[i].transform_sets[j].rotation[0],
-                          objects[i].transform_sets[j].rotation[1],
-                          objects[i].transform_sets[j].rotation[2]);
-                glScalef(objects[i].transform_sets[j].scaling[0],
-                         objects[i].transform_sets[j].scaling[1],
-                         objects[i].transform_sets[j].scaling[2]);
-            }
+            if(objects[i].model_dirty)
+                composeTransforms(&objects[i]);
+            glMultMatrixf(objects[i].model_matrix);
 
             /* The 'glMaterialfv' and 'glMaterialf' functions tell OpenGL
              * the material properties of the surface we want to render.
@@ -494,6 +513,12 @@ void key_pressed(unsigned char key, int x, int y)
 
         glutPostRedisplay();
     }
+    else if(key == 'f')
+    {
+        // Toggle frame times in the title
+        frame_timer.toggle();
+        glutPostRedisplay();
+    }
     else
     {
         float x_view_rad = deg2rad(x_view_angle);
@@ -539,8 +564,13 @@ void key_pressed(unsigned char key, int x, int y)
  */
 int main(int argc, char* argv[])
 {
+    headlessOptions headless;
+    headless_mode = parseHeadlessOptions(&argc, argv, &headless);
     if (argc != 5) {
-        cout << "usage: ./smooth [scene_desc_file.txt] [xres] [yres] [h]"
+        cout << "usage: ./smooth [-headless frames prefix] "
+             << "[scene_desc_file.txt] [xres] [yres] [h]"
+             << endl << "    -headless: draw frames to prefix0000.ppm, ... "
+             << "without a window (prefix - to not write them)"
              << endl << "    scene_desc_file.txt: describes the scene"
              << endl << "    xres: x resolution"
              << endl << "    yres: y resolution"
@@ -557,6 +587,17 @@ int main(int argc, char* argv[])
         // If returns nonzero, there was an error
         return 1;
 
+    // Without a window, draw the frames, write them out and quit.  There is
+    // no need for reshape, since initHeadless sets the viewport
+    if (headless_mode) {
+        if (initHeadless(xres, yres))
+            return 1;
+        init();
+        int status = runHeadless(headless, draw_headless_frame);
+        closeHeadless();
+        return status;
+    }
+
     /* 'glutInit' intializes the GLUT (Graphics Library Utility Toolkit) library.
      * This is necessary, since a lot of the functions we used above and below
      * are from the GLUT library.
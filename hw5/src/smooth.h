@@ -25,5 +25,7 @@
 
 #include "parseScene.h"
 #include "laplace.h"
+#include "headless.h"
+#include "frameTimer.h"
 
 #endif // ifndef SMOOTH
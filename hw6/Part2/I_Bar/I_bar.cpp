@@ -17,7 +17,9 @@ using namespace Eigen;
 void init(void);
 
 // Relevant for displaying objects properly
+void composeModelMatrix();
 void drawIBar();
+void drawHeadlessFrame(int frame, int numFrames);
 void init_lights();
 void set_lights();
 
@@ -47,6 +49,17 @@ double h;
 
 // Current transform of the object on screen
 Transforms t;
+// The current transform as one column-major matrix, which must be made again
+// whenever the transform changes
+float modelMatrix[16];
+bool modelDirty = true;
+
+// Times frames and shows the times in the window's title once 'f' turns it on
+frameTimer timer("I-Bar");
+
+// Whether we are drawing frames without a window, as asked for with
+// -headless on the command line
+bool headlessMode = false;
 
 // Rotation matrices used for the ability to rotate the view
 MatrixXd currentRotation(4, 4);
@@ -140,6 +153,9 @@ void init(void)
  */
 void display(void)
 {
+    // Note when we start drawing to show how long the frame took
+    timer.startFrame();
+
     /* The following line of code is typically the first line of code in any
      * 'display' function.
      */
@@ -185,7 +201,28 @@ void display(void)
      */
     drawIBar();
 
-    glutSwapBuffers();
+    // Time the frame before the swap, which could also wait for the screen to
+    // refresh.  Without a window, the frame is left where it was drawn for
+    // runHeadless to read
+    if (!headlessMode) {
+        timer.endFrame();
+        glutSwapBuffers();
+    }
+}
+
+/* 'drawHeadlessFrame' function:
+ *
+ * Draws one of the frames asked for with -headless.  The frames play the
+ * movie from its first frame, as if 'n' were pressed before each but the
+ * first.
+ */
+void drawHeadlessFrame(int frame, int numFrames)
+{
+    if (frame > 0) {
+        movie->nextTransform(&t);
+        modelDirty = true;
+    }
+    display();
 }
 
 /* 'init_lights' function
@@ -236,26 +273,41 @@ void set_lights()
     }
 }
 
+/* 'composeModelMatrix' function:
+ *
+ * Multiplies the current transform's translation, scaling and rotation
+ * together into 'modelMatrix', the same matrix that glTranslatef, glScalef
+ * and glRotatef would make of them, so that drawing a frame applies the
+ * transform with one call and only a new transform is converted from its
+ * quaternion.
+ */
+void composeModelMatrix()
+{
+    const float zeros[3] = { 0, 0, 0 }, ones[3] = { 1, 1, 1 };
+
+    // The quaternion's rotation is (theta, x, y, z) with theta in radians
+    float rotation[4];
+    quaternionToRotation(t.rotation, rotation);
+    float degrees = rotation[0] * 180 / PI;
+
+    identityMatrix(modelMatrix);
+    multTransform(modelMatrix, t.translation, zeros, 0, t.scaling);
+    multTransform(modelMatrix, zeros, &rotation[1], degrees, ones);
+
+    modelDirty = false;
+}
+
 /* 'drawIBar' function:
  *
  * This function has OpenGL render our objects to the display screen. It
  */
  void drawIBar()
  {
-     glTranslatef(t.translation[0],
-                  t.translation[1],
-                  t.translation[2]);
-     glScalef(t.scaling[0],
-              t.scaling[1],
-              t.scaling[2]);
-
-    // Use quaternions to compute rotation
-    float rotation[4];
-    quaternionToRotation(t.rotation, rotation);
-    glRotatef(rotation[0] * 180 / PI,
-              rotation[1],
-              rotation[2],
-              rotation[3]);
+    // The whole transform is applied at once, and is only multiplied
+    // together again when it changes
+    if (modelDirty)
+        composeModelMatrix();
+    glMultMatrixf(modelMatrix);
 
     /* Parameters for drawing the cylinders */
     float cyRad = 0.2, cyHeight = 1.0;
@@ -368,6 +420,13 @@ void key_pressed(unsigned char key, int x, int y)
     else if(key == 'n')
     {
         movie->nextTransform(&t);
+        modelDirty = true;
+        glutPostRedisplay();
+    }
+    else if(key == 'f')
+    {
+        // Toggle frame times in the title
+        timer.toggle();
         glutPostRedisplay();
     }
 }
@@ -378,8 +437,13 @@ void key_pressed(unsigned char key, int x, int y)
  */
 int main(int argc, char* argv[])
 {
+    headlessOptions headless;
+    headlessMode = parseHeadlessOptions(&argc, argv, &headless);
     if (argc != 4) {
-        cout << "usage: ./keyframe [frames.script] [xres] [yres]"
+        cout << "usage: ./keyframe [-headless frames prefix] [frames.script] "
+             << "[xres] [yres]"
+             << endl << "    -headless: draw frames to prefix0000.ppm, ... "
+             << "without a window (prefix - to not write them)"
              << endl << "    frames.script: the frames in the movie"
              << endl << "    xres: x resolution"
              << endl << "    yres: y resolution"
@@ -401,6 +465,16 @@ int main(int argc, char* argv[])
     // Use the first frame as the current transformation.
     t = *(movie->firstFrame->t);
 
+    // Without a window, play the movie, write out its frames and quit
+    if (headlessMode) {
+        if (initHeadless(xres, yres))
+            return 1;
+        init();
+        int status = runHeadless(headless, drawHeadlessFrame);
+        closeHeadless();
+        return status;
+    }
+
     /* 'glutInit' intializes the GLUT (Graphics Library Utility Toolkit) library.
      * This is necessary, since a lot of the functions we used above and below
      * are from the GLUT library.
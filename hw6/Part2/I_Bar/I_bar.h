@@ -15,6 +15,9 @@
 
 #include "movie.h"
 #include "utils.h"
+#include "headless.h"
+#include "modelMatrix.h"
+#include "frameTimer.h"
 
 #ifdef __APPLE__
     #include <OpenGL/gl.h>
@@ -473,8 +473,36 @@ void Renderer::transform(const Transformation& trans) {
     }
 }
 
-/* Renders the scene in its current state. */
+/* Renders the scene to the window, then reads the next command. */
 void Renderer::display() {
+    drawScene();
+
+    // Display the current scene
+    glutSwapBuffers();
+
+    if (CommandLine::active()) {
+        printf("> ");
+        CommandLine::readLine(cin);
+        Renderer::getSingleton()->scene->update();
+        glutPostRedisplay();
+    }
+}
+
+/*
+ * Renders one of the frames asked for with -headless, turning the scene about
+ * the y axis so the camera circles it once over all of the frames.
+ */
+void Renderer::drawHeadlessFrame(int frame, int num_frames) {
+    UI *ui = Renderer::getSingleton()->ui;
+
+    float angle = 2 * M_PI * frame / num_frames;
+    makeRotateMat(ui->arcball_object_mat.data(), 0.0, 1.0, 0.0, angle);
+    ui->arcball_light_mat = ui->arcball_object_mat;
+    drawScene();
+}
+
+/* Renders the scene in its current state. */
+void Renderer::drawScene() {
     Renderer *renderer = Renderer::getSingleton();
     UI *ui = renderer->ui;
     Scene *scene = renderer->scene;
@@ -564,16 +592,6 @@ void Renderer::display() {
     // Pop the arcball and scaling matrices
     glPopMatrix();
     glPopMatrix();
-
-    // Display the current scene
-    glutSwapBuffers();
-
-    if (CommandLine::active()) {
-        printf("> ");
-        CommandLine::readLine(cin);
-        scene->update();
-        glutPostRedisplay();
-    }
 }
 
 /* Reshapes the window. */
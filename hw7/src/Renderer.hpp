@@ -30,6 +30,7 @@ class Renderer {
 
         void init();
         void start();
+        static void drawHeadlessFrame(int frame, int num_frames);
         
         // static void addPrimitive(float e, float n, float *scale, float *rotate,
         //     float theta, float *translate);
@@ -38,6 +39,7 @@ class Renderer {
 
     private:
         static void display();
+        static void drawScene();
         static void reshape(int xres, int yres);
 
         GLuint display_list;
@@ -1,4 +1,5 @@
 #include "Renderer.hpp"
+#include "headless.h"
 
 #include <cstdio>
 
@@ -10,15 +11,36 @@
 using namespace std;
 
 int main(int argc, char *argv[]) {
+    headlessOptions headless;
+    bool headless_mode = parseHeadlessOptions(&argc, argv, &headless);
     if (argc != 3) {
-        printf("Usage: ./modeler xres yres\n");
+        printf("Usage: ./modeler [-headless frames prefix] xres yres\n");
         return 1;
     }
 
+    int xres = atoi(argv[1]), yres = atoi(argv[2]);
+
+    // Without a window, read the whole scene from the command line, then
+    // circle it, writing out the frames, and quit
+    if (headless_mode) {
+        if (initHeadless(xres, yres))
+            return 1;
+        CommandLine::init();
+
+        Renderer *renderer = Renderer::getSingleton(xres, yres);
+        renderer->init();
+        while (CommandLine::active() && cin.peek() != EOF)
+            CommandLine::readLine(cin);
+        renderer->updateScene();
+
+        int status = runHeadless(headless, Renderer::drawHeadlessFrame);
+        closeHeadless();
+        return status;
+    }
+
     // Initialize GLUT and its window
     glutInit(&argc, argv);
 
-    int xres = atoi(argv[1]), yres = atoi(argv[2]);
     glutInitWindowSize(xres, yres);
     glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
     glutCreateWindow("Phong Renderer");
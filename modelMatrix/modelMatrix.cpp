@@ -0,0 +1,104 @@
+/******************************************************************************
+
+ modelMatrix.cpp
+
+ Builds model matrices in the column-major order glMultMatrixf takes, so
+ m[4 * c + r] is row r of column c.  Each transformation is multiplied onto
+ the right of the matrix, as OpenGL does, one column at a time.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <cmath>
+#include <assert.h>
+
+#include "modelMatrix.h"
+
+using namespace std;
+
+#define MODEL_PI    3.1415926   // The PI the assignments' utils.h define
+
+/*
+ identityMatrix
+
+ Sets a matrix to the identity, as glLoadIdentity would.
+
+ Arguments: float *m - The sixteen entries of the matrix
+
+ Returns:   Nothing.
+*/
+void identityMatrix
+(
+    float               *m
+)
+{
+    assert(m);
+    for (int i = 0; i < 16; ++i)
+        m[i] = (i % 5 == 0) ? 1 : 0;
+}
+
+/*
+ multTransform
+
+ Multiplies a translation, a rotation and a scaling onto a matrix, making
+ the same matrix that calling glTranslatef, glRotatef and glScalef with them
+ in that order would.  A rotation by no angle or about a zero axis is
+ skipped.
+
+ Arguments: float *m - The sixteen entries of the matrix
+            const float *translation - Distance to move along x, y and z
+            const float *rotation - Axis to rotate about, of any length
+            float angle - Angle to rotate by, in degrees
+            const float *scaling - Factor to scale x, y and z by
+
+ Returns:   Nothing.
+*/
+void multTransform
+(
+    float               *m,
+    const float         *translation,
+    const float         *rotation,
+    float               angle,
+    const float         *scaling
+)
+{
+    assert(m);
+    assert(translation);
+    assert(rotation);
+    assert(scaling);
+
+    // Translating moves the last column along the first three
+    for (int r = 0; r < 4; ++r)
+        m[12 + r] += translation[0] * m[r] +
+                     translation[1] * m[4 + r] +
+                     translation[2] * m[8 + r];
+
+    // Rotating mixes the first three columns, with the rotation matrix
+    // glRotatef makes for a unit axis
+    float x = rotation[0], y = rotation[1], z = rotation[2];
+    float mag = sqrt(x*x + y*y + z*z);
+    if (angle != 0 && mag > 0) {
+        x /= mag;
+        y /= mag;
+        z /= mag;
+        float c = cos(angle * MODEL_PI / 180);
+        float s = sin(angle * MODEL_PI / 180);
+        float rot[3][3] = {
+            { x*x*(1-c) + c,   x*y*(1-c) - z*s, x*z*(1-c) + y*s },
+            { y*x*(1-c) + z*s, y*y*(1-c) + c,   y*z*(1-c) - x*s },
+            { z*x*(1-c) - y*s, z*y*(1-c) + x*s, z*z*(1-c) + c   } };
+        float cols[12];
+        for (int col = 0; col < 3; ++col)
+            for (int r = 0; r < 4; ++r)
+                cols[4 * col + r] = rot[0][col] * m[r] +
+                                    rot[1][col] * m[4 + r] +
+                                    rot[2][col] * m[8 + r];
+        for (int i = 0; i < 12; ++i)
+            m[i] = cols[i];
+    }
+
+    // Scaling stretches each of the first three columns
+    for (int col = 0; col < 3; ++col)
+        for (int r = 0; r < 4; ++r)
+            m[4 * col + r] *= scaling[col];
+}
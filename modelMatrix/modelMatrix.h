@@ -0,0 +1,20 @@
+/******************************************************************************
+
+ modelMatrix.h
+
+ Contains public functions from modelMatrix.cpp, which build a model matrix
+ on the CPU the way glTranslatef, glRotatef and glScalef would build it on
+ the matrix stack, so the OpenGL assignments can compose an object's
+ transformations once and hand OpenGL a single matrix.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef MODELMATRIX
+#define MODELMATRIX
+
+// Externally public functions
+void identityMatrix (float*);
+void multTransform (float*, const float*, const float*, float, const float*);
+
+#endif // ifndef MODELMATRIX
@@ -0,0 +1,560 @@
+/******************************************************************************
+
+ meshCache.cpp
+
+ Keeps a binary copy of an OBJ file next to it, named by appending
+ MESH_CACHE_EXT to the OBJ file's name, so the mesh can be mapped straight
+ into memory rather than parsed on every run.  A cache is a header followed
+ by the mesh's positions, texture coordinates, normals and three arrays of
+ face indices, each laid out as in an objMesh and padded to a multiple of
+ eight bytes, all little endian.  The header records the size and
+ modification time the OBJ file had when the cache was made and a checksum
+ of the arrays, and a cache is only used while all three still match.
+ A mesh changed from what the OBJ file holds, such as by reordering its
+ triangles, is kept apart from the plain cache by appending MESH_OPT_EXT
+ instead, so that only code asking for the changed mesh gets it.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "meshCache.h"
+
+using namespace std;
+
+#define MESH_CACHE_MAGIC    "OBJC"      // First four bytes of every cache
+#define MESH_CACHE_VERSION  2           // Changes whenever the layout does
+#define MESH_CACHE_ARRAYS   6           // Arrays following the header
+
+// Odd 64 bit constant the checksum multiplies by
+#define CHECKSUM_PRIME      0x9E3779B97F4A7C15ULL
+
+/*
+ meshCacheHeader
+
+ The start of every cache file.  flags holds MESH_CACHE_* flags saying how
+ the mesh was stored.  sourceSize, sourceSec and sourceNsec are the size
+ and modification time of the OBJ file the cache was made from, counts
+ holds the number of positions, texture coordinates, normals and
+ triangles, and checksum is taken over the arrays that follow.
+*/
+typedef struct _meshCacheHeader {
+    char                magic[4];
+    uint32_t            version;
+    uint32_t            flags;
+    uint32_t            reserved;
+    uint64_t            sourceSize;
+    int64_t             sourceSec;
+    int64_t             sourceNsec;
+    uint64_t            counts[4];
+    uint64_t            checksum;
+} meshCacheHeader;
+
+/*
+ isLittleEndian
+
+ Finds whether this machine stores numbers little endian, as caches do.
+ Caches are neither read nor written on machines that do not.
+
+ Arguments: None.
+
+ Returns:   (bool) - True if numbers are stored little endian
+*/
+static bool isLittleEndian()
+{
+    uint32_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+/*
+ paddedSize
+
+ Rounds a number of bytes up to a multiple of eight, so every array in a
+ cache starts eight byte aligned.
+
+ Arguments: size_t size - The number of bytes
+
+ Returns:   (size_t) - The padded number of bytes
+*/
+static inline size_t paddedSize
+(
+    size_t              size
+)
+{
+    return (size + 7) & ~(size_t) 7;
+}
+
+/*
+ arraySizes
+
+ Finds the size in bytes, before padding, of every array in a cache.
+
+ Arguments: const uint64_t *counts - The number of positions, texture
+                coordinates, normals and triangles
+            size_t *sizes - Filled with the size of each of the
+                MESH_CACHE_ARRAYS arrays, in the order they are stored
+
+ Returns:   (size_t) - The size of the whole cache, header and padding
+                included
+*/
+static size_t arraySizes
+(
+    const uint64_t      *counts,
+    size_t              *sizes
+)
+{
+    sizes[0] = 3 * counts[0] * sizeof(float);
+    sizes[1] = 2 * counts[1] * sizeof(float);
+    sizes[2] = 3 * counts[2] * sizeof(float);
+    sizes[3] = 3 * counts[3] * sizeof(int);
+    sizes[4] = sizes[3];
+    sizes[5] = sizes[3];
+
+    size_t total = sizeof(meshCacheHeader);
+    for (int i = 0; i < MESH_CACHE_ARRAYS; ++i)
+        total += paddedSize(sizes[i]);
+    return total;
+}
+
+/*
+ mixWord
+
+ Folds one word into a running checksum.
+
+ Arguments: uint64_t h - The checksum so far
+            uint64_t w - The word to fold in
+
+ Returns:   (uint64_t) - The new checksum
+*/
+static inline uint64_t mixWord
+(
+    uint64_t            h,
+    uint64_t            w
+)
+{
+    h = (h ^ w) * CHECKSUM_PRIME;
+    return h ^ (h >> 32);
+}
+
+/*
+ checksum
+
+ Finds a checksum of an array, as if it were padded with zeros to a whole
+ number of words.  Words are spread over four independent sums so the
+ multiplies of neighboring words overlap, which lets a cache be checked
+ about as fast as it can be read.
+
+ Arguments: const void *data - The first byte of the array
+            size_t size - The number of bytes in the array
+
+ Returns:   (uint64_t) - The checksum
+*/
+static uint64_t checksum
+(
+    const void          *data,
+    size_t              size
+)
+{
+    const char *p = (const char *) data;
+    size_t nWords = size / sizeof(uint64_t);
+    uint64_t h[4] = { 1, 2, 3, 4 };
+
+    size_t i = 0;
+    for (; i + 4 <= nWords; i += 4) {
+        for (int j = 0; j < 4; ++j) {
+            uint64_t w;
+            memcpy(&w, p + (i + j) * sizeof(w), sizeof(w));
+            h[j] = mixWord(h[j], w);
+        }
+    }
+    for (; i < nWords; ++i) {
+        uint64_t w;
+        memcpy(&w, p + i * sizeof(w), sizeof(w));
+        h[0] = mixWord(h[0], w);
+    }
+    if (size % sizeof(uint64_t)) {
+        uint64_t w = 0;
+        memcpy(&w, p + nWords * sizeof(w), size % sizeof(w));
+        h[0] = mixWord(h[0], w);
+    }
+
+    uint64_t sum = size;
+    for (int j = 0; j < 4; ++j)
+        sum = mixWord(sum, h[j]);
+    return sum;
+}
+
+/*
+ mapCache
+
+ Maps a cache file into memory and, if it was made from the OBJ file as it
+ is now, with the expected flags, and its arrays are intact, points a view
+ into it.
+
+ Arguments: const char *cacheFile - The name of the cache file
+            const struct stat *source - The OBJ file's status
+            unsigned int flags - The MESH_CACHE_* flags the cache must have
+            objMeshView *view - An empty view, pointed into the cache if it
+                is used
+
+ Returns:   (int) - 0 if the cache was used, nonzero otherwise
+*/
+static int mapCache
+(
+    const char          *cacheFile,
+    const struct stat   *source,
+    unsigned int        flags,
+    objMeshView         *view
+)
+{
+    int fd = open(cacheFile, O_RDONLY);
+    if (fd < 0)
+        return 1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(meshCacheHeader)) {
+        close(fd);
+        return 1;
+    }
+
+    size_t size = st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return 1;
+    madvise(map, size, MADV_WILLNEED);
+
+    const meshCacheHeader *header = (const meshCacheHeader *) map;
+    bool valid = memcmp(header->magic, MESH_CACHE_MAGIC, 4) == 0 &&
+        header->version == MESH_CACHE_VERSION &&
+        header->flags == flags &&
+        header->sourceSize == (uint64_t) source->st_size &&
+        header->sourceSec == (int64_t) source->st_mtim.tv_sec &&
+        header->sourceNsec == (int64_t) source->st_mtim.tv_nsec;
+
+    // Every count has to fit an int, and the arrays have to fill the file
+    const char *arrays[MESH_CACHE_ARRAYS];
+    size_t sizes[MESH_CACHE_ARRAYS];
+    for (int i = 0; valid && i < 4; ++i)
+        valid = header->counts[i] <= INT_MAX / 3;
+    if (valid)
+        valid = arraySizes(header->counts, sizes) == size;
+
+    if (valid) {
+        uint64_t sum = 0;
+        const char *p = (const char *) map + sizeof(meshCacheHeader);
+        for (int i = 0; i < MESH_CACHE_ARRAYS; ++i) {
+            arrays[i] = sizes[i] ? p : NULL;
+            sum = mixWord(sum, checksum(p, sizes[i]));
+            p += paddedSize(sizes[i]);
+        }
+        valid = sum == header->checksum;
+    }
+
+    if (!valid) {
+        munmap(map, size);
+        return 1;
+    }
+
+    view->map = map;
+    view->mapSize = size;
+    view->flags = header->flags;
+    view->positions = (const float *) arrays[0];
+    view->texCoords = (const float *) arrays[1];
+    view->normals = (const float *) arrays[2];
+    view->faceV = (const int *) arrays[3];
+    view->faceT = (const int *) arrays[4];
+    view->faceN = (const int *) arrays[5];
+    view->nPositions = header->counts[0];
+    view->nTexCoords = header->counts[1];
+    view->nNormals = header->counts[2];
+    view->nTriangles = header->counts[3];
+    return 0;
+}
+
+/*
+ cacheName
+
+ Names the cache file of an OBJ file for a mesh stored with the given flags.
+
+ Arguments: const char *filename - The name of the OBJ file
+            unsigned int flags - MESH_CACHE_* flags saying how the mesh
+                differs from the file, or 0 if it does not
+
+ Returns:   (string) - The name of the cache file
+*/
+static string cacheName
+(
+    const char          *filename,
+    unsigned int        flags
+)
+{
+    return string(filename) + (flags ? MESH_OPT_EXT : MESH_CACHE_EXT);
+}
+
+/*
+ writeCache
+
+ Writes a mesh to a cache file.  The cache is written under a temporary
+ name and then renamed, so a process reading the cache never sees it half
+ written.
+
+ Arguments: const char *cacheFile - The name of the cache file
+            const struct stat *source - The status of the OBJ file the mesh
+                was read from, taken before it was read
+            const objMesh *mesh - The mesh to write
+            unsigned int flags - MESH_CACHE_* flags saying how the mesh was
+                stored
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+static int writeCache
+(
+    const char          *cacheFile,
+    const struct stat   *source,
+    const objMesh       *mesh,
+    unsigned int        flags
+)
+{
+    if (!isLittleEndian())
+        return 1;
+
+    meshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+    header.version = MESH_CACHE_VERSION;
+    header.flags = flags;
+    header.sourceSize = source->st_size;
+    header.sourceSec = source->st_mtim.tv_sec;
+    header.sourceNsec = source->st_mtim.tv_nsec;
+    header.counts[0] = mesh->numPositions();
+    header.counts[1] = mesh->numTexCoords();
+    header.counts[2] = mesh->numNormals();
+    header.counts[3] = mesh->numTriangles();
+
+    const void *arrays[MESH_CACHE_ARRAYS] = {
+        mesh->positions.data(), mesh->texCoords.data(),
+        mesh->normals.data(), mesh->faceV.data(), mesh->faceT.data(),
+        mesh->faceN.data()
+    };
+    size_t sizes[MESH_CACHE_ARRAYS];
+    arraySizes(header.counts, sizes);
+    for (int i = 0; i < MESH_CACHE_ARRAYS; ++i)
+        header.checksum = mixWord(header.checksum,
+            checksum(arrays[i], sizes[i]));
+
+    char tmpFile[1024];
+    snprintf(tmpFile, sizeof(tmpFile), "%s.%d.tmp", cacheFile, (int) getpid());
+    FILE *out = fopen(tmpFile, "wb");
+    if (!out)
+        return 1;
+
+    const char zeros[8] = { 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (int i = 0; ok && i < MESH_CACHE_ARRAYS; ++i) {
+        // Empty arrays take no space, and their data may be NULL
+        if (sizes[i] == 0)
+            continue;
+        size_t pad = paddedSize(sizes[i]) - sizes[i];
+        ok = fwrite(arrays[i], 1, sizes[i], out) == sizes[i] &&
+            fwrite(zeros, 1, pad, out) == pad;
+    }
+    ok = (fclose(out) == 0) && ok;
+
+    if (!ok || rename(tmpFile, cacheFile) != 0) {
+        remove(tmpFile);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ writeMeshCache
+
+ Writes the cache for an OBJ file from a mesh already read from it, or from
+ the file itself if no mesh is given.  A mesh that has been changed from
+ what was read, such as by reordering its triangles, is flagged as such and
+ written to the optimized cache rather than the plain one.
+
+ Arguments: const char *filename - The name of the OBJ file
+            const objMesh *mesh - The contents of the file
+            unsigned int flags - MESH_CACHE_* flags saying how the mesh
+                differs from the file, or 0 if it does not
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int writeMeshCache
+(
+    const char          *filename,
+    const objMesh       *mesh,
+    unsigned int        flags
+)
+{
+    assert(filename);
+    assert(mesh);
+
+    struct stat source;
+    if (stat(filename, &source) != 0)
+        return 1;
+    string cacheFile = cacheName(filename, flags);
+    return writeCache(cacheFile.c_str(), &source, mesh, flags);
+}
+int writeMeshCache
+(
+    const char          *filename,
+    const objMesh       *mesh
+)
+{
+    return writeMeshCache(filename, mesh, 0);
+}
+int writeMeshCache
+(
+    const char          *filename
+)
+{
+    assert(filename);
+
+    struct stat source;
+    if (stat(filename, &source) != 0) {
+        cout << "unable to open " << filename << endl;
+        return 1;
+    }
+    objMesh mesh;
+    if (loadObjMesh(filename, &mesh))
+        return 1;
+    string cacheFile = cacheName(filename, 0);
+    return writeCache(cacheFile.c_str(), &source, &mesh, 0);
+}
+
+/*
+ objMeshView::open
+
+ Opens a view of an OBJ file.  The file's cache is mapped if it is up to
+ date.  Otherwise the file is parsed and a new cache is written, and the
+ view points into the parsed mesh.  Failing to write the cache, for
+ instance because the directory is read only, is not an error.
+
+ Arguments: const char *filename - The name of the OBJ file to view
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int objMeshView::open
+(
+    const char          *filename
+)
+{
+    assert(filename);
+    close();
+
+    // The OBJ file's status is taken before it is read, so a cache written
+    // from it never claims to match a later version of the file
+    struct stat source;
+    if (stat(filename, &source) != 0) {
+        cout << "unable to open " << filename << endl;
+        return 1;
+    }
+
+    string cacheFile = cacheName(filename, 0);
+    if (isLittleEndian() &&
+        mapCache(cacheFile.c_str(), &source, 0, this) == 0)
+        return 0;
+
+    if (loadObjMesh(filename, &parsed))
+        return 1;
+    writeCache(cacheFile.c_str(), &source, &parsed, 0);
+
+    nPositions = parsed.numPositions();
+    nTexCoords = parsed.numTexCoords();
+    nNormals = parsed.numNormals();
+    nTriangles = parsed.numTriangles();
+    positions = nPositions ? parsed.positions.data() : NULL;
+    texCoords = nTexCoords ? parsed.texCoords.data() : NULL;
+    normals = nNormals ? parsed.normals.data() : NULL;
+    faceV = nTriangles ? parsed.faceV.data() : NULL;
+    faceT = nTriangles ? parsed.faceT.data() : NULL;
+    faceN = nTriangles ? parsed.faceN.data() : NULL;
+    return 0;
+}
+// Different definition for string input instead of char*
+int objMeshView::open
+(
+    const string        &filename
+)
+{
+    return open(filename.c_str());
+}
+
+/*
+ objMeshView::openOptimized
+
+ Opens a view of an OBJ file's optimized cache if it is up to date, and of
+ the file as written otherwise, as open would.  The optimized cache is
+ only ever written by objcache -O, never here.  isOptimized says which was
+ opened.
+
+ Arguments: const char *filename - The name of the OBJ file to view
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int objMeshView::openOptimized
+(
+    const char          *filename
+)
+{
+    assert(filename);
+    close();
+
+    struct stat source;
+    if (stat(filename, &source) != 0) {
+        cout << "unable to open " << filename << endl;
+        return 1;
+    }
+
+    string cacheFile = cacheName(filename, MESH_CACHE_OPTIMIZED);
+    if (isLittleEndian() && mapCache(cacheFile.c_str(), &source,
+        MESH_CACHE_OPTIMIZED, this) == 0)
+        return 0;
+    return open(filename);
+}
+// Different definition for string input instead of char*
+int objMeshView::openOptimized
+(
+    const string        &filename
+)
+{
+    return openOptimized(filename.c_str());
+}
+
+/*
+ objMeshView::close
+
+ Unmaps the view's cache or frees its parsed mesh, and empties the view.
+
+ Arguments: None.
+
+ Returns:   Nothing.
+*/
+void objMeshView::close()
+{
+    if (map)
+        munmap(map, mapSize);
+    map = NULL;
+    mapSize = 0;
+    flags = 0;
+    parsed = objMesh();
+
+    positions = texCoords = normals = NULL;
+    faceV = faceT = faceN = NULL;
+    nPositions = nTexCoords = nNormals = nTriangles = 0;
+}
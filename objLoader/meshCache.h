@@ -0,0 +1,86 @@
+/******************************************************************************
+
+ meshCache.h
+
+ Contains the objMeshView struct and public functions from meshCache.cpp,
+ which keep a binary copy of each OBJ file next to it so later runs can map
+ the mesh instead of parsing it.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef MESHCACHE
+#define MESHCACHE
+
+#include <cstddef>
+#include <string>
+
+#include "objLoader.h"
+
+#define MESH_CACHE_EXT      ".cache"    // Appended to the OBJ file's name
+#define MESH_OPT_EXT        ".opt.cache"    // Same, for optimized meshes
+
+// Flags saying how a cached mesh differs from its OBJ file.  Only caches
+// without flags are exact copies, and only those are kept in MESH_CACHE_EXT.
+#define MESH_CACHE_OPTIMIZED    0x1     // Triangles reordered for drawing
+
+// Structs
+/*
+ objMeshView
+
+ A read only view of everything in an OBJ file, laid out the same way as an
+ objMesh but through pointers rather than vectors.  When the OBJ file has an
+ up to date cache, the pointers point straight into the mapped cache and
+ nothing is copied.  Otherwise the OBJ file is parsed into parsed, which the
+ pointers point into, and a cache is written for next time.  Pointers to
+ empty arrays are NULL.  open always views the OBJ file as written, while
+ openOptimized views the optimized cache written by objcache -O if there is
+ an up to date one, in which the triangles and vertices are reordered.
+ flags holds the MESH_CACHE_* flags of the cache the view was mapped from.
+ The view is valid until it is closed.  It owns the mapping, so it cannot
+ be copied.
+*/
+typedef struct _objMeshView {
+    const float         *positions;
+    const float         *texCoords;
+    const float         *normals;
+    const int           *faceV;
+    const int           *faceT;
+    const int           *faceN;
+    int                 nPositions;
+    int                 nTexCoords;
+    int                 nNormals;
+    int                 nTriangles;
+    void                *map;
+    size_t              mapSize;
+    unsigned int        flags;
+    objMesh             parsed;
+
+    _objMeshView() : positions (NULL), texCoords (NULL), normals (NULL),
+        faceV (NULL), faceT (NULL), faceN (NULL), nPositions (0),
+        nTexCoords (0), nNormals (0), nTriangles (0), map (NULL),
+        mapSize (0), flags (0), parsed () {}
+    ~_objMeshView() { close(); }
+    _objMeshView(const _objMeshView&) = delete;
+    _objMeshView& operator=(const _objMeshView&) = delete;
+
+    int numPositions() const { return nPositions; }
+    int numTexCoords() const { return nTexCoords; }
+    int numNormals() const { return nNormals; }
+    int numTriangles() const { return nTriangles; }
+    bool isMapped() const { return map != NULL; }
+    bool isOptimized() const { return flags & MESH_CACHE_OPTIMIZED; }
+
+    int open (const char*);
+    int open (const std::string&);
+    int openOptimized (const char*);
+    int openOptimized (const std::string&);
+    void close ();
+} objMeshView;
+
+// Externally public functions
+int writeMeshCache (const char*, const objMesh*, unsigned int);
+int writeMeshCache (const char*, const objMesh*);
+int writeMeshCache (const char*);
+
+#endif // ifndef MESHCACHE
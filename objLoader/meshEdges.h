@@ -0,0 +1,84 @@
+/******************************************************************************
+
+ meshEdges.h
+
+ Contains findUniqueEdges, which finds every edge of a set of triangles
+ once.  It is a template so that each assignment can hand it triangles and
+ take edges in whatever form it keeps them.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef MESHEDGES
+#define MESHEDGES
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+/*
+ findUniqueEdges
+
+ Finds every edge of a set of triangles once, however many triangles share
+ it.  Each edge is filed under its smaller vertex, so an edge can only
+ repeat among the few edges filed with it, and nothing needs to be sorted
+ or hashed.  Edges between a vertex and itself are skipped.
+
+ Arguments: size_t nTriangles - The number of triangles
+            int nVertices - The number of vertices the triangles index
+            Corner corner - Called as corner(t, j) for the jth vertex, 0
+                through 2, of triangle t
+            AddEdge addEdge - Called as addEdge(a, b) once for every edge,
+                with a < b, in order of a
+
+ Returns:   Nothing.
+*/
+template <typename Corner, typename AddEdge>
+void findUniqueEdges
+(
+    size_t              nTriangles,
+    int                 nVertices,
+    Corner              corner,
+    AddEdge             addEdge
+)
+{
+    // start[v] through start[v + 1] will hold the larger vertex of every
+    // edge whose smaller vertex is v
+    std::vector<unsigned int> start(nVertices + 1, 0);
+    for (size_t t = 0; t < nTriangles; ++t) {
+        for (int j = 0; j < 3; ++j) {
+            unsigned int a = corner(t, j), b = corner(t, (j + 1) % 3);
+            assert(a < (unsigned int) nVertices);
+            assert(b < (unsigned int) nVertices);
+            if (a != b)
+                start[std::min(a, b) + 1]++;
+        }
+    }
+    for (int v = 0; v < nVertices; ++v)
+        start[v + 1] += start[v];
+
+    std::vector<unsigned int> other(start[nVertices]);
+    std::vector<unsigned int> fill(start.begin(), start.end() - 1);
+    for (size_t t = 0; t < nTriangles; ++t) {
+        for (int j = 0; j < 3; ++j) {
+            unsigned int a = corner(t, j), b = corner(t, (j + 1) % 3);
+            if (a != b)
+                other[fill[std::min(a, b)]++] = std::max(a, b);
+        }
+    }
+
+    // An edge repeats within its smaller vertex's list, and seen[v] marks
+    // one more than the vertex whose list v was last found in
+    std::vector<unsigned int> seen(nVertices, 0);
+    for (int v = 0; v < nVertices; ++v) {
+        for (unsigned int i = start[v]; i < start[v + 1]; ++i) {
+            if (seen[other[i]] != (unsigned int) v + 1) {
+                seen[other[i]] = v + 1;
+                addEdge((unsigned int) v, other[i]);
+            }
+        }
+    }
+}
+
+#endif // ifndef MESHEDGES
@@ -0,0 +1,725 @@
+/******************************************************************************
+
+ meshOptimize.cpp
+
+ Reorders the triangles and vertices of a welded mesh for drawing, in three
+ passes:
+    1. Triangles are ordered for vertex cache locality with Forsyth's
+       algorithm, which greedily draws next the triangle whose vertices
+       score best, scoring a vertex by how recently it entered a simulated
+       cache and how few of its triangles are left to draw.
+    2. The result is split into clusters that each use the cache about as
+       well as the whole, and the clusters are sorted so those facing out
+       from the middle of the mesh draw first and hide what is behind them.
+    3. Vertices are renumbered in the order the triangles first use them,
+       so they are fetched from memory in order.
+ Large meshes are first sorted along a Morton curve through their
+ triangles' centroids and cut into chunks of nearby triangles, which are
+ ordered by separate threads in the first pass.  The chunks depend only on
+ the mesh, so the order found does not depend on the number of threads.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+#include <assert.h>
+
+#include "meshOptimize.h"
+
+using namespace std;
+
+#define FORSYTH_CACHE_SIZE  32      // Vertices in the cache Forsyth scores
+#define FORSYTH_MAX_VALENCE 32      // Valences past this score the same
+#define CACHE_DECAY_POWER   1.5f    // How fast a cached vertex's score falls
+#define LAST_TRI_SCORE      0.75f   // Score of the last triangle's vertices
+#define VALENCE_BOOST_SCALE 2.0f    // Score of a vertex with one triangle left
+#define VALENCE_BOOST_POWER 0.5f    // How fast that falls with more left
+#define OVERDRAW_THRESHOLD  1.05f   // Most a cluster may raise its ACMR by
+#define MIN_OPTIMIZE_CHUNK  (1 << 18)   // Fewest triangles in a chunk
+#define MORTON_BITS         10      // Bits of each axis in a Morton code
+
+/*
+ forsythScores
+
+ The score a vertex gets for its position in the cache and for the number
+ of its triangles that have not been drawn.
+*/
+typedef struct _forsythScores {
+    float               cache[FORSYTH_CACHE_SIZE];
+    float               valence[FORSYTH_MAX_VALENCE + 1];
+
+    _forsythScores() {
+        for (int i = 0; i < FORSYTH_CACHE_SIZE; ++i) {
+            // The last triangle's vertices score the same, so the next
+            // triangle does not favor any one edge of it
+            if (i < 3) {
+                cache[i] = LAST_TRI_SCORE;
+            } else {
+                float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                cache[i] = powf(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+            }
+        }
+        valence[0] = 0;
+        for (int i = 1; i <= FORSYTH_MAX_VALENCE; ++i)
+            valence[i] = VALENCE_BOOST_SCALE * powf(i, -VALENCE_BOOST_POWER);
+    }
+    ~_forsythScores() {}
+
+    float score(int cachePos, int live) const {
+        if (live == 0)
+            return -1.0f;
+        float s = cachePos >= 0 ? cache[cachePos] : 0;
+        return s + valence[min(live, FORSYTH_MAX_VALENCE)];
+    }
+} forsythScores;
+
+/*
+ cacheMissRatio
+
+ Simulates drawing triangles through a FIFO vertex cache and finds the
+ average number of vertices missed per triangle.
+
+ Arguments: const vector<unsigned int> &indices - Three vertices for every
+                triangle, in the order they are drawn
+            int nVertices - The number of vertices indexed
+            int cacheSize - The number of vertices the cache holds
+
+ Returns:   (float) - The average cache miss ratio, or 0 if there are no
+                triangles
+*/
+float cacheMissRatio
+(
+    const vector<unsigned int>  &indices,
+    int                         nVertices,
+    int                         cacheSize
+)
+{
+    if (indices.empty())
+        return 0;
+
+    // A vertex is in the cache if it was added in the last cacheSize misses
+    vector<unsigned int> added(nVertices, 0);
+    unsigned int time = cacheSize + 1;
+    size_t misses = 0;
+    vector<unsigned int>::const_iterator i = indices.begin();
+    for (; i != indices.end(); ++i) {
+        if (time - added[*i] > (unsigned int) cacheSize) {
+            added[*i] = time++;
+            misses++;
+        }
+    }
+    return (float) misses / (indices.size() / 3);
+}
+
+/*
+ orderForCache
+
+ Orders a chunk of triangles for vertex cache locality with Forsyth's
+ algorithm.  The triangle drawn next is the best scoring one that uses a
+ vertex in the cache, or if there is none, the first not yet drawn.
+
+ Arguments: const unsigned int *indices - Three vertices for every triangle
+                in the mesh
+            int nVertices - The number of vertices in the mesh
+            const int *chunk - The triangles of the chunk
+            int count - The number of triangles in the chunk
+            int *out - Filled with the count triangles of the chunk, in the
+                order to draw them
+
+ Returns:   Nothing.
+*/
+static void orderForCache
+(
+    const unsigned int  *indices,
+    int                 nVertices,
+    const int           *chunk,
+    int                 count,
+    int                 *out
+)
+{
+    forsythScores scores;
+
+    // Number the chunk's vertices from 0 so everything below is sized by
+    // the chunk rather than the mesh
+    vector<int> tri(3 * count);
+    int nLocal = 0;
+    {
+        vector<int> localOf(nVertices, -1);
+        for (int i = 0; i < 3 * count; ++i) {
+            unsigned int v = indices[3 * (size_t) chunk[i / 3] + i % 3];
+            if (localOf[v] < 0)
+                localOf[v] = nLocal++;
+            tri[i] = localOf[v];
+        }
+    }
+
+    // Every vertex's triangles, with the ones not yet drawn first.  live
+    // holds how many of them there are.
+    vector<int> live(nLocal, 0);
+    for (int i = 0; i < 3 * count; ++i)
+        live[tri[i]]++;
+    vector<int> adjStart(nLocal + 1, 0);
+    for (int v = 0; v < nLocal; ++v)
+        adjStart[v + 1] = adjStart[v] + live[v];
+    vector<int> adj(3 * count);
+    {
+        vector<int> fill(adjStart.begin(), adjStart.end() - 1);
+        for (int i = 0; i < 3 * count; ++i)
+            adj[fill[tri[i]]++] = i / 3;
+    }
+
+    vector<int> cachePos(nLocal, -1);
+    vector<float> vScore(nLocal);
+    for (int v = 0; v < nLocal; ++v)
+        vScore[v] = scores.score(-1, live[v]);
+    vector<char> drawn(count, 0);
+
+    int cache[FORSYTH_CACHE_SIZE + 3];
+    int cacheSize = 0;
+    int best = -1;
+    int next = 0;
+    for (int k = 0; k < count; ++k) {
+        if (best < 0) {
+            while (drawn[next])
+                next++;
+            best = next;
+        }
+        out[k] = chunk[best];
+        drawn[best] = 1;
+        const int *tv = &tri[3 * best];
+
+        // The triangle is no longer left to draw for any of its vertices
+        for (int j = 0; j < 3; ++j) {
+            int *a = &adj[adjStart[tv[j]]];
+            int n = live[tv[j]];
+            for (int m = 0; m < n; ++m) {
+                if (a[m] == best) {
+                    swap(a[m], a[n - 1]);
+                    break;
+                }
+            }
+            live[tv[j]]--;
+        }
+
+        // Move the triangle's vertices to the front of the cache
+        int newCache[FORSYTH_CACHE_SIZE + 3];
+        int n = 0;
+        for (int j = 0; j < 3; ++j) {
+            if (find(newCache, newCache + n, tv[j]) == newCache + n)
+                newCache[n++] = tv[j];
+        }
+        for (int i = 0; i < cacheSize; ++i) {
+            int v = cache[i];
+            if (v != tv[0] && v != tv[1] && v != tv[2])
+                newCache[n++] = v;
+        }
+        for (int i = FORSYTH_CACHE_SIZE; i < n; ++i) {
+            cachePos[newCache[i]] = -1;
+            vScore[newCache[i]] = scores.score(-1, live[newCache[i]]);
+        }
+        cacheSize = min(n, FORSYTH_CACHE_SIZE);
+        for (int i = 0; i < cacheSize; ++i) {
+            cache[i] = newCache[i];
+            cachePos[cache[i]] = i;
+            vScore[cache[i]] = scores.score(i, live[cache[i]]);
+        }
+
+        // Only triangles of cached vertices changed score enough to matter
+        best = -1;
+        float bestScore = -1;
+        for (int i = 0; i < cacheSize; ++i) {
+            int v = cache[i];
+            const int *a = &adj[adjStart[v]];
+            for (int m = 0; m < live[v]; ++m) {
+                const int *t = &tri[3 * a[m]];
+                float s = vScore[t[0]] + vScore[t[1]] + vScore[t[2]];
+                if (s > bestScore) {
+                    best = a[m];
+                    bestScore = s;
+                }
+            }
+        }
+    }
+}
+
+/*
+ orderChunks
+
+ Orders every nThreads-th chunk of triangles for the cache, starting with
+ one, so that nThreads calls share the chunks between them.
+
+ Arguments: const unsigned int *indices - Three vertices for every triangle
+                in the mesh
+            int nVertices - The number of vertices in the mesh
+            const vector<int> *chunks - The triangles of every chunk, one
+                after another
+            int nChunks - The number of chunks, each about the same size
+            int first - The first chunk to order
+            int nThreads - The number of chunks to skip to the next one
+            vector<int> *tris - Filled with the triangles of each chunk
+                ordered, where the chunk was in chunks
+
+ Returns:   Nothing.
+*/
+static void orderChunks
+(
+    const unsigned int  *indices,
+    int                 nVertices,
+    const vector<int>   *chunks,
+    int                 nChunks,
+    int                 first,
+    int                 nThreads,
+    vector<int>         *tris
+)
+{
+    long nTriangles = chunks->size();
+    for (int c = first; c < nChunks; c += nThreads) {
+        int start = nTriangles * c / nChunks;
+        int end = nTriangles * (c + 1) / nChunks;
+        orderForCache(indices, nVertices, &(*chunks)[start], end - start,
+            &(*tris)[start]);
+    }
+}
+
+/*
+ spreadBits
+
+ Spreads the low MORTON_BITS bits of a number out to every third bit, so
+ that three of them can be interleaved into a Morton code.
+
+ Arguments: unsigned int x - The number to spread
+
+ Returns:   (unsigned int) - The spread bits
+*/
+static unsigned int spreadBits
+(
+    unsigned int        x
+)
+{
+    x &= (1 << MORTON_BITS) - 1;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+/*
+ sortSpatially
+
+ Sorts a mesh's triangles along a Morton curve through their centroids, so
+ that triangles near each other in the list are near each other in space
+ and any run of them makes a compact patch of the mesh.  Triangles with
+ the same code keep their order.
+
+ Arguments: const weldedMesh *mesh - The mesh
+            vector<int> *tris - Filled with every triangle of the mesh in
+                sorted order
+
+ Returns:   Nothing.
+*/
+static void sortSpatially
+(
+    const weldedMesh    *mesh,
+    vector<int>         *tris
+)
+{
+    int nTriangles = mesh->numTriangles();
+
+    // Three times each centroid, and the box around them
+    vector<float> centroids(3 * (size_t) nTriangles);
+    float lo[3] = { INFINITY, INFINITY, INFINITY };
+    float hi[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (int t = 0; t < nTriangles; ++t) {
+        const unsigned int *idx = &mesh->indices[3 * (size_t) t];
+        for (int j = 0; j < 3; ++j) {
+            float c = mesh->positions[3 * idx[0] + j] +
+                mesh->positions[3 * idx[1] + j] +
+                mesh->positions[3 * idx[2] + j];
+            centroids[3 * (size_t) t + j] = c;
+            lo[j] = min(lo[j], c);
+            hi[j] = max(hi[j], c);
+        }
+    }
+
+    float scale[3];
+    for (int j = 0; j < 3; ++j)
+        scale[j] = hi[j] > lo[j] ? ((1 << MORTON_BITS) - 1) / (hi[j] - lo[j])
+            : 0;
+
+    vector<pair<unsigned int, int> > keys(nTriangles);
+    for (int t = 0; t < nTriangles; ++t) {
+        unsigned int code = 0;
+        for (int j = 0; j < 3; ++j) {
+            float c = (centroids[3 * (size_t) t + j] - lo[j]) * scale[j];
+            code |= spreadBits((unsigned int) c) << j;
+        }
+        keys[t].first = code;
+        keys[t].second = t;
+    }
+    sort(keys.begin(), keys.end());
+
+    tris->resize(nTriangles);
+    for (int t = 0; t < nTriangles; ++t)
+        (*tris)[t] = keys[t].second;
+}
+
+/*
+ clusterKey
+
+ Finds how much a run of triangles faces away from the middle of the mesh,
+ as the distance of its centroid from the mesh's centroid along its
+ average normal.  Both are weighted by the area of each triangle.
+
+ Arguments: const weldedMesh *mesh - The mesh
+            const int *tris - The triangles of the run
+            int count - The number of triangles in the run
+            const float *center - The centroid of the mesh
+
+ Returns:   (float) - The key, larger for clusters that should draw first
+*/
+static float clusterKey
+(
+    const weldedMesh    *mesh,
+    const int           *tris,
+    int                 count,
+    const float         *center
+)
+{
+    double centroid[3] = { 0, 0, 0 };
+    double normal[3] = { 0, 0, 0 };
+    double area = 0;
+    for (int i = 0; i < count; ++i) {
+        const unsigned int *idx = &mesh->indices[3 * tris[i]];
+        const float *a = &mesh->positions[3 * idx[0]];
+        const float *b = &mesh->positions[3 * idx[1]];
+        const float *c = &mesh->positions[3 * idx[2]];
+        double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        double n[3] = { e1[1] * e2[2] - e1[2] * e2[1],
+                        e1[2] * e2[0] - e1[0] * e2[2],
+                        e1[0] * e2[1] - e1[1] * e2[0] };
+        double w = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int j = 0; j < 3; ++j) {
+            centroid[j] += w * (a[j] + b[j] + c[j]) / 3;
+            normal[j] += n[j];
+        }
+        area += w;
+    }
+
+    double len = sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+        normal[2] * normal[2]);
+    if (area == 0 || len == 0)
+        return 0;
+    double key = 0;
+    for (int j = 0; j < 3; ++j)
+        key += (centroid[j] / area - center[j]) * normal[j] / len;
+    return key;
+}
+
+/*
+ orderForOverdraw
+
+ Splits triangles already ordered for the cache into clusters and sorts
+ the clusters so those facing out from the middle of the mesh draw first.
+ A cluster starts wherever the cache order had to start afresh, and is
+ split further wherever the part so far misses the cache at most
+ OVERDRAW_THRESHOLD times as often as the whole cluster does, so
+ reordering the clusters costs little cache locality.
+
+ Arguments: const weldedMesh *mesh - The mesh
+            vector<int> *tris - The triangles in the order they draw, which
+                is changed to the sorted clusters'
+
+ Returns:   Nothing.
+*/
+static void orderForOverdraw
+(
+    const weldedMesh    *mesh,
+    vector<int>         *tris
+)
+{
+    int nTriangles = tris->size();
+    int nVertices = mesh->numVertices();
+    if (nTriangles == 0)
+        return;
+
+    // Misses for every triangle, through the cache ACMR is taken with
+    vector<unsigned int> added(nVertices, 0);
+    unsigned int time = ACMR_CACHE_SIZE + 1;
+    vector<char> misses(nTriangles);
+    for (int i = 0; i < nTriangles; ++i) {
+        const unsigned int *idx = &mesh->indices[3 * (*tris)[i]];
+        misses[i] = 0;
+        for (int j = 0; j < 3; ++j) {
+            if (time - added[idx[j]] > ACMR_CACHE_SIZE) {
+                added[idx[j]] = time++;
+                misses[i]++;
+            }
+        }
+    }
+
+    // The first triangle of every cluster, with one past the last at the end
+    vector<int> starts;
+    int hard = 0;
+    while (hard < nTriangles) {
+        int end = hard + 1;
+        int total = misses[hard];
+        while (end < nTriangles && misses[end] < 3)
+            total += misses[end++];
+        float threshold = OVERDRAW_THRESHOLD * total / (end - hard);
+
+        // Each new cluster starts with an empty cache
+        starts.push_back(hard);
+        time += ACMR_CACHE_SIZE + 1;
+        int start = hard, missed = 0;
+        for (int i = hard; i < end; ++i) {
+            const unsigned int *idx = &mesh->indices[3 * (*tris)[i]];
+            for (int j = 0; j < 3; ++j) {
+                if (time - added[idx[j]] > ACMR_CACHE_SIZE) {
+                    added[idx[j]] = time++;
+                    missed++;
+                }
+            }
+            if (i + 1 < end && missed <= threshold * (i + 1 - start)) {
+                starts.push_back(i + 1);
+                time += ACMR_CACHE_SIZE + 1;
+                start = i + 1;
+                missed = 0;
+            }
+        }
+        hard = end;
+    }
+    starts.push_back(nTriangles);
+
+    // The centroid of the mesh's vertices
+    float center[3] = { 0, 0, 0 };
+    for (int v = 0; v < nVertices; ++v) {
+        for (int j = 0; j < 3; ++j)
+            center[j] += mesh->positions[3 * v + j] / nVertices;
+    }
+
+    int nClusters = starts.size() - 1;
+    vector<pair<float, int> > keys(nClusters);
+    for (int c = 0; c < nClusters; ++c) {
+        keys[c].first = -clusterKey(mesh, &(*tris)[starts[c]],
+            starts[c + 1] - starts[c], center);
+        keys[c].second = c;
+    }
+    stable_sort(keys.begin(), keys.end());
+
+    vector<int> sorted;
+    sorted.reserve(nTriangles);
+    for (int c = 0; c < nClusters; ++c) {
+        int k = keys[c].second;
+        sorted.insert(sorted.end(), tris->begin() + starts[k],
+            tris->begin() + starts[k + 1]);
+    }
+    tris->swap(sorted);
+}
+
+/*
+ orderForFetch
+
+ Renumbers a mesh's vertices in the order its triangles first use them, and
+ moves the vertices to match.  Vertices no triangle uses are dropped.
+
+ Arguments: weldedMesh *mesh - The mesh to renumber
+
+ Returns:   Nothing.
+*/
+static void orderForFetch
+(
+    weldedMesh          *mesh
+)
+{
+    int nVertices = mesh->numVertices();
+    vector<int> newIndex(nVertices, -1);
+    int n = 0;
+    vector<unsigned int>::iterator i = mesh->indices.begin();
+    for (; i != mesh->indices.end(); ++i) {
+        if (newIndex[*i] < 0)
+            newIndex[*i] = n++;
+        *i = newIndex[*i];
+    }
+
+    vector<float> positions(3 * n), texCoords(2 * n), normals(3 * n);
+    for (int v = 0; v < nVertices; ++v) {
+        int w = newIndex[v];
+        if (w < 0)
+            continue;
+        memcpy(&positions[3 * w], &mesh->positions[3 * v], 3 * sizeof(float));
+        memcpy(&texCoords[2 * w], &mesh->texCoords[2 * v], 2 * sizeof(float));
+        memcpy(&normals[3 * w], &mesh->normals[3 * v], 3 * sizeof(float));
+    }
+    mesh->positions.swap(positions);
+    mesh->texCoords.swap(texCoords);
+    mesh->normals.swap(normals);
+}
+
+/*
+ optimizeMesh
+
+ Reorders a mesh's triangles for vertex cache locality and then overdraw,
+ and its vertices for fetch locality.  Meshes of more than one chunk are
+ sorted spatially and cut into chunks of MIN_OPTIMIZE_CHUNK or more nearby
+ triangles, which are ordered for the cache by separate threads.  The
+ result is the same however many threads there are.
+
+ Arguments: weldedMesh *mesh - The mesh to reorder
+            int nThreads - Number of threads to order with, or 0 to use one
+                per core.  Meshes with fewer chunks use fewer.
+            meshOptimizeStats *stats - If not NULL, filled with the ACMR
+                before and after
+            vector<int> *order - If not NULL, filled with the index each
+                triangle had before it was reordered
+
+ Returns:   Nothing.
+*/
+void optimizeMesh
+(
+    weldedMesh          *mesh,
+    int                 nThreads,
+    meshOptimizeStats   *stats,
+    vector<int>         *order
+)
+{
+    assert(mesh);
+
+    int nTriangles = mesh->numTriangles();
+    int nVertices = mesh->numVertices();
+    if (stats)
+        stats->acmrBefore = cacheMissRatio(mesh->indices, nVertices,
+            ACMR_CACHE_SIZE);
+
+    // A mesh of one chunk is ordered whole, from the order it was in
+    int nChunks = max(nTriangles / MIN_OPTIMIZE_CHUNK, 1);
+    vector<int> chunks(nTriangles);
+    if (nChunks > 1) {
+        sortSpatially(mesh, &chunks);
+    } else {
+        for (int t = 0; t < nTriangles; ++t)
+            chunks[t] = t;
+    }
+
+    if (nThreads <= 0)
+        nThreads = max((int) thread::hardware_concurrency(), 1);
+    nThreads = min(nThreads, nChunks);
+
+    // The calling thread is one of the workers
+    vector<int> tris(nTriangles);
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; ++t)
+        workers.push_back(thread(orderChunks, mesh->indices.data(),
+            nVertices, &chunks, nChunks, t, nThreads, &tris));
+    orderChunks(mesh->indices.data(), nVertices, &chunks, nChunks, 0,
+        nThreads, &tris);
+    vector<thread>::iterator w = workers.begin();
+    for (; w != workers.end(); ++w)
+        w->join();
+
+    orderForOverdraw(mesh, &tris);
+
+    vector<unsigned int> indices(3 * nTriangles);
+    for (int i = 0; i < nTriangles; ++i)
+        memcpy(&indices[3 * i], &mesh->indices[3 * tris[i]],
+            3 * sizeof(unsigned int));
+    mesh->indices.swap(indices);
+    orderForFetch(mesh);
+
+    if (stats)
+        stats->acmrAfter = cacheMissRatio(mesh->indices,
+            mesh->numVertices(), ACMR_CACHE_SIZE);
+    if (order)
+        order->swap(tris);
+}
+void optimizeMesh
+(
+    weldedMesh          *mesh,
+    meshOptimizeStats   *stats
+)
+{
+    optimizeMesh(mesh, 0, stats, NULL);
+}
+
+/*
+ renumberByUse
+
+ Renumbers one kind of element of a mesh read from an OBJ file in the order
+ its faces first use them, and moves the elements to match.  Elements no
+ face uses keep their order after all the rest.
+
+ Arguments: vector<float> *elements - The elements, n floats each
+            int n - Floats in each element
+            vector<int> *corners - The one-indexed element of every face
+                corner, or 0 for none, which are renumbered
+
+ Returns:   Nothing.
+*/
+static void renumberByUse
+(
+    vector<float>       *elements,
+    int                 n,
+    vector<int>         *corners
+)
+{
+    int count = elements->size() / n;
+    vector<int> newIndex(count + 1, 0);
+    int next = 1;
+    vector<int>::iterator c = corners->begin();
+    for (; c != corners->end(); ++c) {
+        if (*c > 0 && newIndex[*c] == 0)
+            newIndex[*c] = next++;
+        *c = newIndex[*c];
+    }
+    for (int i = 1; i <= count; ++i) {
+        if (newIndex[i] == 0)
+            newIndex[i] = next++;
+    }
+
+    vector<float> moved(elements->size());
+    for (int i = 1; i <= count; ++i)
+        memcpy(&moved[n * (newIndex[i] - 1)], &(*elements)[n * (i - 1)],
+            n * sizeof(float));
+    elements->swap(moved);
+}
+
+/*
+ reorderTriangles
+
+ Puts the triangles of a mesh read from an OBJ file in a new order, such as
+ one found by optimizeMesh for the mesh welded from it.  Positions, texture
+ coordinates and normals are then renumbered in the order the triangles
+ first use them, so they are fetched in order too.
+
+ Arguments: objMesh *mesh - The mesh to reorder
+            const vector<int> &order - The index each triangle had before
+                it was reordered
+
+ Returns:   Nothing.
+*/
+void reorderTriangles
+(
+    objMesh             *mesh,
+    const vector<int>   &order
+)
+{
+    assert(mesh);
+    assert((int) order.size() == mesh->numTriangles());
+
+    vector<int> *faces[3] = { &mesh->faceV, &mesh->faceT, &mesh->faceN };
+    for (int f = 0; f < 3; ++f) {
+        vector<int> reordered(faces[f]->size());
+        for (size_t i = 0; i < order.size(); ++i)
+            memcpy(&reordered[3 * i], &(*faces[f])[3 * order[i]],
+                3 * sizeof(int));
+        faces[f]->swap(reordered);
+    }
+
+    renumberByUse(&mesh->positions, 3, &mesh->faceV);
+    renumberByUse(&mesh->texCoords, 2, &mesh->faceT);
+    renumberByUse(&mesh->normals, 3, &mesh->faceN);
+}
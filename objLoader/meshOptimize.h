@@ -0,0 +1,45 @@
+/******************************************************************************
+
+ meshOptimize.h
+
+ Contains the meshOptimizeStats struct and public functions from
+ meshOptimize.cpp, which reorder a welded mesh's triangles and vertices so
+ it draws with fewer vertex cache misses and less overdraw.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef MESHOPTIMIZE
+#define MESHOPTIMIZE
+
+#include <vector>
+
+#include "objLoader.h"
+#include "meshWeld.h"
+
+#define ACMR_CACHE_SIZE     16      // Vertices in the FIFO ACMR is taken on
+
+// Structs
+/*
+ meshOptimizeStats
+
+ How well a mesh's triangle order uses a vertex cache before and after it
+ is optimized, as the average cache miss ratio, the number of vertices
+ transformed per triangle with a FIFO cache of ACMR_CACHE_SIZE vertices.
+ It is 3 at worst and approaches 0.5 for large, regular meshes.
+*/
+typedef struct _meshOptimizeStats {
+    float               acmrBefore;
+    float               acmrAfter;
+
+    _meshOptimizeStats() : acmrBefore (0), acmrAfter (0) {}
+    ~_meshOptimizeStats() {}
+} meshOptimizeStats;
+
+// Externally public functions
+float cacheMissRatio (const std::vector<unsigned int>&, int, int);
+void optimizeMesh (weldedMesh*, int, meshOptimizeStats*, std::vector<int>*);
+void optimizeMesh (weldedMesh*, meshOptimizeStats*);
+void reorderTriangles (objMesh*, const std::vector<int>&);
+
+#endif // ifndef MESHOPTIMIZE
@@ -0,0 +1,344 @@
+/******************************************************************************
+
+ meshWeld.cpp
+
+ Welds the corners of an OBJ file's faces into shared vertices.  An OBJ
+ file indexes positions, texture coordinates and normals separately, but
+ OpenGL indexes whole vertices, so every corner is looked up by the values
+ it combines and given the index of the first vertex with the same values.
+ Corners are compared by value rather than by index, so files that repeat a
+ position or normal under several indices are welded too.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+#include <assert.h>
+
+#include "meshWeld.h"
+#include "meshEdges.h"
+
+using namespace std;
+
+#define WELD_KEY_WORDS      8       // Floats in a weldKey
+#define MIN_TABLE_BITS      6       // Fewest bits in a weldTable slot index
+
+// Odd 64 bit constant hashes are multiplied by to spread them over a table
+#define HASH_SPREAD         0x9E3779B97F4A7C15ULL
+
+/*
+ weldKey
+
+ Everything that makes one vertex different from another.
+*/
+typedef struct _weldKey {
+    float               position[3];
+    float               texCoord[2];
+    float               normal[3];
+} weldKey;
+
+/*
+ weldKeyHasher
+
+ Hashes a weldKey word by word, the same way the CustomHasher of hw4 does.
+ Keys are hashed and compared by their bits, so -0 and 0 are different
+ values and a NaN equals itself.
+*/
+typedef struct _weldKeyHasher {
+    size_t operator() (const weldKey &k) const {
+        uint32_t words[WELD_KEY_WORDS];
+        memcpy(words, &k, sizeof(words));
+        size_t h = 0;
+        for (int i = 0; i < WELD_KEY_WORDS; ++i)
+            h ^= hash<uint32_t>()(words[i]) + 0x9e3779b9 + (h << 6) +
+                (h >> 2);
+        return h;
+    }
+} weldKeyHasher;
+
+/*
+ weldTable
+
+ An open addressed hash table of the vertices welded so far.  keys holds
+ every distinct key in the order it was first seen, which is the order of
+ the welded vertices, and each slot of slots is 0 if empty or one more than
+ the index in keys of the key hashed there.  Collisions are resolved by
+ trying the following slots in turn, and the table doubles whenever it is
+ half full, so a lookup rarely tries more than a few.  Unlike a map of
+ nodes, nothing is allocated per vertex.
+*/
+typedef struct _weldTable {
+    std::vector<weldKey>        keys;
+    std::vector<unsigned int>   slots;
+    int                         shift;
+
+    _weldTable() : keys (), slots (), shift (64) {}
+    ~_weldTable() {}
+
+    void reserve (size_t);
+    unsigned int find (const weldKey&);
+} weldTable;
+
+/*
+ slotOf
+
+ Finds the first slot a hash tries in a table whose slot indices have
+ 64 - shift bits.  The hash is spread by a multiply first, since
+ weldKeyHasher leaves its low bits depending mostly on the last few floats.
+
+ Arguments: size_t h - The hash
+            int shift - 64 less the number of bits in a slot index
+
+ Returns:   (size_t) - The first slot to try
+*/
+static inline size_t slotOf
+(
+    size_t              h,
+    int                 shift
+)
+{
+    return (size_t) (((uint64_t) h * HASH_SPREAD) >> shift);
+}
+
+/*
+ weldTable::reserve
+
+ Sizes the table to hold a number of keys while at most half full, moving
+ any keys already in it.
+
+ Arguments: size_t n - The number of keys to make room for
+
+ Returns:   Nothing.
+*/
+void weldTable::reserve
+(
+    size_t              n
+)
+{
+    int bits = MIN_TABLE_BITS;
+    while (((size_t) 1 << bits) < 2 * n)
+        bits++;
+    size_t size = (size_t) 1 << bits;
+    if (size <= slots.size())
+        return;
+
+    keys.reserve(n);
+    slots.assign(size, 0);
+    shift = 64 - bits;
+
+    weldKeyHasher hasher;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        size_t s = slotOf(hasher(keys[i]), shift);
+        while (slots[s])
+            s = (s + 1) & (size - 1);
+        slots[s] = i + 1;
+    }
+}
+
+/*
+ weldTable::find
+
+ Finds the vertex with a key, adding one if there is none yet.
+
+ Arguments: const weldKey &key - The key to find
+
+ Returns:   (unsigned int) - The index of the vertex with the key
+*/
+unsigned int weldTable::find
+(
+    const weldKey       &key
+)
+{
+    if (2 * (keys.size() + 1) > slots.size())
+        reserve(2 * (keys.size() + 1));
+
+    size_t mask = slots.size() - 1;
+    size_t s = slotOf(weldKeyHasher()(key), shift);
+    for (; slots[s]; s = (s + 1) & mask) {
+        unsigned int v = slots[s] - 1;
+        if (memcmp(&keys[v], &key, sizeof(weldKey)) == 0)
+            return v;
+    }
+
+    keys.push_back(key);
+    slots[s] = keys.size();
+    return keys.size() - 1;
+}
+
+/*
+ copyOrZero
+
+ Copies one element of an OBJ array, or zeros if the corner has none.
+
+ Arguments: const float *array - The array the element is in
+            int index - One-indexed element, or 0 for none
+            int n - Floats in each element
+            float *out - Filled with the element
+
+ Returns:   Nothing.
+*/
+static inline void copyOrZero
+(
+    const float         *array,
+    int                 index,
+    int                 n,
+    float               *out
+)
+{
+    if (index > 0)
+        memcpy(out, &array[n * (index - 1)], n * sizeof(float));
+    else
+        memset(out, 0, n * sizeof(float));
+}
+
+/*
+ weldCorners
+
+ Gives every distinct combination of position, texture coordinate and
+ normal among the corners of a mesh's faces its own vertex, and indexes the
+ corners of each triangle by those vertices.
+
+ Arguments: const float *positions - Three floats for every position
+            const float *texCoords - Two floats for every texture coordinate
+            const float *normals - Three floats for every normal
+            const int *faceV - The position of every corner, one-indexed
+            const int *faceT - The texture coordinate of every corner,
+                one-indexed, or 0 for none
+            const int *faceN - The normal of every corner, one-indexed, or 0
+                for none
+            int nPositions - The number of positions
+            int nTriangles - The number of triangles
+            weldedMesh *welded - Filled with the vertices and indices
+
+ Returns:   Nothing.
+*/
+static void weldCorners
+(
+    const float         *positions,
+    const float         *texCoords,
+    const float         *normals,
+    const int           *faceV,
+    const int           *faceT,
+    const int           *faceN,
+    int                 nPositions,
+    int                 nTriangles,
+    weldedMesh          *welded
+)
+{
+    int nCorners = 3 * nTriangles;
+    welded->indices.clear();
+    welded->indices.reserve(nCorners);
+
+    // Most meshes have about one vertex per position
+    weldTable table;
+    table.reserve(nPositions);
+
+    // The vertex last welded from each position index, and the texture
+    // coordinate and normal indices it was welded from.  A corner with the
+    // same three indices has the same values, so it is given that vertex
+    // without being hashed, which is most corners of most meshes.
+    vector<int> lastVertex(nPositions + 1, -1);
+    vector<int> lastT(nPositions + 1, 0);
+    vector<int> lastN(nPositions + 1, 0);
+
+    for (int i = 0; i < nCorners; ++i) {
+        int v = faceV[i];
+        int t = faceT[i];
+        int n = faceN[i];
+        if (lastVertex[v] < 0 || lastT[v] != t || lastN[v] != n) {
+            weldKey key;
+            copyOrZero(positions, v, 3, key.position);
+            copyOrZero(texCoords, t, 2, key.texCoord);
+            copyOrZero(normals, n, 3, key.normal);
+            lastVertex[v] = table.find(key);
+            lastT[v] = t;
+            lastN[v] = n;
+        }
+        welded->indices.push_back(lastVertex[v]);
+    }
+
+    // Split the keys into an array for each part of a vertex
+    int nVertices = table.keys.size();
+    welded->positions.resize(3 * nVertices);
+    welded->texCoords.resize(2 * nVertices);
+    welded->normals.resize(3 * nVertices);
+    for (int i = 0; i < nVertices; ++i) {
+        const weldKey *k = &table.keys[i];
+        memcpy(&welded->positions[3 * i], k->position, 3 * sizeof(float));
+        memcpy(&welded->texCoords[2 * i], k->texCoord, 2 * sizeof(float));
+        memcpy(&welded->normals[3 * i], k->normal, 3 * sizeof(float));
+    }
+}
+
+/*
+ weldMesh
+
+ Welds the corners of a mesh read from an OBJ file into vertices.
+
+ Arguments: const objMeshView *mesh - The mesh read from the OBJ file
+            weldedMesh *welded - Filled with the vertices and indices
+
+ Returns:   Nothing.
+*/
+void weldMesh
+(
+    const objMeshView   *mesh,
+    weldedMesh          *welded
+)
+{
+    assert(mesh);
+    assert(welded);
+    weldCorners(mesh->positions, mesh->texCoords, mesh->normals, mesh->faceV,
+        mesh->faceT, mesh->faceN, mesh->numPositions(), mesh->numTriangles(),
+        welded);
+}
+// Different definition for an objMesh instead of a view of one
+void weldMesh
+(
+    const objMesh       *mesh,
+    weldedMesh          *welded
+)
+{
+    assert(mesh);
+    assert(welded);
+    weldCorners(mesh->positions.data(), mesh->texCoords.data(),
+        mesh->normals.data(), mesh->faceV.data(), mesh->faceT.data(),
+        mesh->faceN.data(), mesh->numPositions(), mesh->numTriangles(),
+        welded);
+}
+
+/*
+ findEdges
+
+ Finds every edge of a set of indexed triangles once, however many
+ triangles share it, as drawn by glDrawElements with GL_LINES.
+
+ Arguments: const vector<unsigned int> &indices - Three vertices for every
+                triangle
+            int nVertices - The number of vertices indexed
+            vector<unsigned int> *edges - Filled with two vertices for every
+                edge, the smaller first, ordered by their smaller vertex
+
+ Returns:   Nothing.
+*/
+void findEdges
+(
+    const vector<unsigned int>  &indices,
+    int                         nVertices,
+    vector<unsigned int>        *edges
+)
+{
+    assert(edges);
+    edges->clear();
+
+    const unsigned int *tri = indices.data();
+    findUniqueEdges(indices.size() / 3, nVertices,
+        [tri](size_t t, int j) { return tri[3 * t + j]; },
+        [edges](unsigned int a, unsigned int b) {
+            edges->push_back(a);
+            edges->push_back(b);
+        });
+}
@@ -0,0 +1,51 @@
+/******************************************************************************
+
+ meshWeld.h
+
+ Contains the weldedMesh struct and public functions from meshWeld.cpp,
+ which turn the separately indexed positions, texture coordinates and
+ normals of an OBJ file into one indexed array of vertices, as drawn by
+ glDrawElements, and find the edges between those vertices with
+ findUniqueEdges from meshEdges.h.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef MESHWELD
+#define MESHWELD
+
+#include <vector>
+
+#include "meshCache.h"
+
+// Structs
+/*
+ weldedMesh
+
+ A mesh in which every vertex is a distinct combination of a position,
+ texture coordinate and normal.  positions and normals hold three floats
+ for every vertex and texCoords two, with zeros where the corners a vertex
+ came from had no texture coordinate or normal.  indices holds three
+ zero-indexed vertices for every triangle, in the order the triangles were
+ in the file.
+*/
+typedef struct _weldedMesh {
+    std::vector<float>          positions;
+    std::vector<float>          texCoords;
+    std::vector<float>          normals;
+    std::vector<unsigned int>   indices;
+
+    _weldedMesh() : positions (), texCoords (), normals (), indices () {}
+    ~_weldedMesh() {}
+
+    int numVertices() const { return positions.size() / 3; }
+    int numTriangles() const { return indices.size() / 3; }
+} weldedMesh;
+
+// Externally public functions
+void weldMesh (const objMeshView*, weldedMesh*);
+void weldMesh (const objMesh*, weldedMesh*);
+void findEdges (const std::vector<unsigned int>&, int,
+    std::vector<unsigned int>*);
+
+#endif // ifndef MESHWELD
@@ -0,0 +1,859 @@
+/******************************************************************************
+
+ objLoader.cpp
+
+ Loads OBJ files into an objMesh.  The file is mapped into memory rather
+ than read line by line, and numbers are scanned in place, so no strings are
+ allocated while loading.  The file is split at line boundaries into chunks
+ that are parsed in parallel.  A first pass counts each kind of element in
+ every chunk, so the mesh's arrays are sized once and every chunk knows
+ where its elements go before the second pass fills them.
+
+ Supports v, vt, vn and f lines, with face corners given as v, v/t, v//n or
+ v/t/n.  Faces with more than three corners are split into a fan of
+ triangles.  Every other kind of line is skipped.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <iostream>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "objLoader.h"
+
+using namespace std;
+
+
+#define MAX_FAST_DIGITS     19      // Significant digits that fit a uint64_t
+#define MAX_FAST_EXPONENT   22      // Largest power of ten exact in a double
+#define MAX_SLOW_LEN        63      // Longest number handed to strtof
+#define MIN_CHUNK_SIZE      (1 << 20)   // Fewest bytes worth a thread
+
+// Every power of ten that a double holds exactly
+static const double POW10[MAX_FAST_EXPONENT + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// The kinds of lines the loader reads
+typedef enum _objStatement {
+    ObjOther,
+    ObjPosition,
+    ObjTexCoord,
+    ObjNormal,
+    ObjFace
+} objStatement;
+
+/*
+ objChunk
+
+ A piece of a mapped OBJ file, starting and ending at line boundaries, that
+ is parsed by one thread.  counts holds how many of each kind of element the
+ chunk has, with faces counted in triangles, and offsets how many of each
+ kind come before the chunk in the file.  status is nonzero if the chunk
+ could not be parsed.
+*/
+typedef struct _objChunk {
+    const char          *begin;
+    const char          *end;
+    size_t              counts[ObjFace + 1];
+    size_t              offsets[ObjFace + 1];
+    int                 status;
+} objChunk;
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/*
+ mapFile
+
+ Maps the whole of a file into memory, read only.
+
+ Arguments: const char *filename - The name of the file to map
+            const char **data - Set to the first byte of the file, or NULL if
+                the file is empty
+            size_t *size - Set to the number of bytes in the file
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+static int mapFile
+(
+    const char          *filename,
+    const char          **data,
+    size_t              *size
+)
+{
+    *data = NULL;
+    *size = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return 1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 1;
+    }
+
+    // An empty file cannot be mapped, but is a valid (empty) mesh
+    *size = st.st_size;
+    if (*size > 0) {
+        void *p = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return 1;
+        }
+        madvise(p, *size, MADV_SEQUENTIAL);
+        *data = (const char *) p;
+    }
+
+    // The mapping stays valid after the file is closed
+    close(fd);
+    return 0;
+}
+
+/*
+ nextLine
+
+ Finds the start of the line after the one containing a character.
+
+ Arguments: const char *p - A character in the line
+            const char *end - One past the last character in the file
+
+ Returns:   (const char*) - The start of the next line, or end if none
+*/
+static inline const char *nextLine
+(
+    const char          *p,
+    const char          *end
+)
+{
+    const char *nl = (const char *) memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+/*
+ skipBlanks
+
+ Skips past spaces and tabs, stopping at the end of the line.
+
+ Arguments: const char *p - Where to start
+            const char *end - One past the last character in the file
+
+ Returns:   (const char*) - The first character that is not blank
+*/
+static inline const char *skipBlanks
+(
+    const char          *p,
+    const char          *end
+)
+{
+    while (p < end && isBlank(*p))
+        ++p;
+    return p;
+}
+
+/*
+ readStatement
+
+ Reads the keyword that starts a line.
+
+ Arguments: const char **pp - The start of the line, moved past the keyword
+                if it is one the loader reads
+            const char *end - One past the last character in the file
+
+ Returns:   (objStatement) - The kind of line, or ObjOther if it is skipped
+*/
+static objStatement readStatement
+(
+    const char          **pp,
+    const char          *end
+)
+{
+    const char *p = skipBlanks(*pp, end);
+    objStatement s = ObjOther;
+    int len = 0;
+
+    if (end - p >= 2 && p[0] == 'v' && isBlank(p[1])) {
+        s = ObjPosition;
+        len = 1;
+    } else if (end - p >= 2 && p[0] == 'f' && isBlank(p[1])) {
+        s = ObjFace;
+        len = 1;
+    } else if (end - p >= 3 && p[0] == 'v' && isBlank(p[2])) {
+        if (p[1] == 't')
+            s = ObjTexCoord;
+        else if (p[1] == 'n')
+            s = ObjNormal;
+        len = 2;
+    }
+
+    if (s != ObjOther)
+        *pp = p + len;
+    return s;
+}
+
+/*
+ slowFloat
+
+ Scans a float with strtof, for the numbers scanFloat cannot scan exactly.
+ The number is copied out first, because the mapped file is not terminated.
+
+ Arguments: const char **pp - The start of the number, moved past it
+            const char *end - One past the last character in the file
+            float *out - Set to the number
+
+ Returns:   (bool) - True if a number was scanned
+*/
+static bool slowFloat
+(
+    const char          **pp,
+    const char          *end,
+    float               *out
+)
+{
+    char buf[MAX_SLOW_LEN + 1];
+    int len = 0;
+    const char *p = *pp;
+    while (p < end && !isBlank(*p) && *p != '\n' && *p != '/' &&
+            len < MAX_SLOW_LEN)
+        buf[len++] = *(p++);
+    buf[len] = '\0';
+
+    char *stop;
+    *out = strtof(buf, &stop);
+    if (stop == buf)
+        return false;
+    *pp += stop - buf;
+    return true;
+}
+
+/*
+ scanFloat
+
+ Scans a decimal number in place, giving the same float strtof would.  The
+ digits are gathered into an integer, which is scaled by an exact power of
+ ten in double precision.  That double is the one nearest the number, and so
+ rounds to the float nearest the number, unless it lies exactly halfway
+ between two floats.  That case, and numbers with too many digits or too
+ large an exponent, are left to strtof.
+
+ Arguments: const char **pp - The start of the number, moved past it
+            const char *end - One past the last character in the file
+            float *out - Set to the number
+
+ Returns:   (bool) - True if a number was scanned
+*/
+static bool scanFloat
+(
+    const char          **pp,
+    const char          *end,
+    float               *out
+)
+{
+    const char *p = *pp;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *(p++) == '-';
+
+    // The digits, without the decimal point, and the power of ten they are
+    // scaled by.  Leading zeros are not significant.
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p, any = true) {
+        if (digits == MAX_FAST_DIGITS)
+            return slowFloat(pp, end, out);
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p, any = true) {
+            if (digits == MAX_FAST_DIGITS)
+                return slowFloat(pp, end, out);
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+            exponent--;
+        }
+    }
+
+    // Words like inf and nan
+    if (!any)
+        return slowFloat(pp, end, out);
+
+    // An e not followed by digits is not part of the number
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negExp = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            negExp = *(q++) == '-';
+        if (q < end && isDigit(*q)) {
+            int e = 0;
+            for (; q < end && isDigit(*q); ++q) {
+                if (e < 10000)
+                    e = e * 10 + (*q - '0');
+            }
+            exponent += negExp ? -e : e;
+            p = q;
+        }
+    }
+
+    if (mantissa == 0) {
+        *out = negative ? -0.0f : 0.0f;
+        *pp = p;
+        return true;
+    }
+    if (mantissa >= (1ULL << 53) || exponent < -MAX_FAST_EXPONENT ||
+            exponent > MAX_FAST_EXPONENT)
+        return slowFloat(pp, end, out);
+
+    double d = (double) mantissa;
+    d = exponent < 0 ? d / POW10[-exponent] : d * POW10[exponent];
+
+    // A double has 29 more bits of mantissa than a float, and is halfway
+    // between two floats when those bits are a one followed by zeros.
+    // Subnormal and overflowing floats are rounded differently.
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    if ((bits & 0x1FFFFFFF) == 0x10000000 || d < FLT_MIN || d > FLT_MAX)
+        return slowFloat(pp, end, out);
+
+    *out = negative ? (float) -d : (float) d;
+    *pp = p;
+    return true;
+}
+
+/*
+ scanInt
+
+ Scans a decimal integer in place.
+
+ Arguments: const char **pp - The start of the integer, moved past it
+            const char *end - One past the last character in the file
+            int *out - Set to the integer
+
+ Returns:   (bool) - True if an integer was scanned
+*/
+static bool scanInt
+(
+    const char          **pp,
+    const char          *end,
+    int                 *out
+)
+{
+    const char *p = *pp;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *(p++) == '-';
+    if (p == end || !isDigit(*p))
+        return false;
+
+    int n = 0;
+    for (; p < end && isDigit(*p); ++p)
+        n = n * 10 + (*p - '0');
+
+    *out = negative ? -n : n;
+    *pp = p;
+    return true;
+}
+
+/*
+ scanFloats
+
+ Scans a number of blank separated floats from a line.
+
+ Arguments: const char **pp - Where the floats start, moved past them
+            const char *end - One past the last character in the chunk
+            int count - How many floats to scan
+            float *out - Room for the floats
+
+ Returns:   (bool) - True if every float was scanned
+*/
+static bool scanFloats
+(
+    const char          **pp,
+    const char          *end,
+    int                 count,
+    float               *out
+)
+{
+    for (int i = 0; i < count; ++i) {
+        *pp = skipBlanks(*pp, end);
+        if (!scanFloat(pp, end, &out[i]))
+            return false;
+    }
+    return true;
+}
+
+/*
+ resolveIndex
+
+ Turns an index from a face corner into a one-indexed index.  Negative
+ indices count back from the last element read so far.
+
+ Arguments: int idx - The index as it appears in the file
+            int count - How many of the element come before the face in the
+                file
+
+ Returns:   (int) - The index, or -1 if it does not refer to an element
+*/
+static inline int resolveIndex
+(
+    int                 idx,
+    int                 count
+)
+{
+    if (idx < 0)
+        idx += count + 1;
+    return (idx > 0 && idx <= count) ? idx : -1;
+}
+
+/*
+ byteMask
+
+ Finds the bytes of a word that equal a character.
+
+ Arguments: uint64_t w - Eight bytes of the file
+            char c - The character to look for
+
+ Returns:   (uint64_t) - The high bit of every byte that equals c
+*/
+static inline uint64_t byteMask
+(
+    uint64_t            w,
+    char                c
+)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+
+    // Bytes that equal c become zero, and only a zero byte keeps its high
+    // bit clear when its low bits are incremented past 0x7F
+    uint64_t x = w ^ (ones * (unsigned char) c);
+    return ~(((x & low7) + low7) | x) & ~low7;
+}
+
+/*
+ countTriangles
+
+ Counts the triangles a face will be split into, from the number of corners
+ it lists.  The corners themselves are not checked until the face is
+ scanned.  Face lines are most of a typical file, so the corners are counted
+ eight bytes at a time.
+
+ Arguments: const char *p - Where the corners start, just after the keyword
+            const char *eol - The start of the line after the face
+
+ Returns:   (size_t) - The number of triangles
+*/
+static size_t countTriangles
+(
+    const char          *p,
+    const char          *eol
+)
+{
+    // Every corner starts where a blank is followed by anything else.  The
+    // keyword is followed by a blank, so the first corner is found too.
+    size_t corners = 0;
+    uint64_t prevBlank = 0x80;
+    const char *q = p;
+    for (; eol - q >= 8; q += 8) {
+        uint64_t w;
+        memcpy(&w, q, sizeof(w));
+        if (byteMask(w, '#'))
+            break;
+        uint64_t blank = byteMask(w, ' ') | byteMask(w, '\t') |
+            byteMask(w, '\r') | byteMask(w, '\n');
+        uint64_t starts = ~blank & ((blank << 8) | prevBlank) &
+            0x8080808080808080ULL;
+        corners += __builtin_popcountll(starts);
+        prevBlank = blank >> 56;
+    }
+
+    // The rest of the line, and anything after a comment, a byte at a time
+    bool blank = prevBlank != 0;
+    for (; q < eol && *q != '#'; ++q) {
+        bool b = isBlank(*q) || *q == '\n';
+        corners += blank && !b;
+        blank = b;
+    }
+    return corners >= 3 ? corners - 2 : 0;
+}
+
+/*
+ scanFace
+
+ Scans the corners of a face, writing a triangle for every corner after the
+ second, fanned out from the first.
+
+ Arguments: const char **pp - Where the corners start, moved past them
+            const char *end - One past the last character in the chunk
+            const int *counts - How many positions, texture coordinates and
+                normals come before the face in the file, for resolving
+                relative indices
+            int **out - The next position, texture coordinate and normal
+                index to write, each moved past what was written
+            const int *limit - One past the last position index there is
+                room for
+
+ Returns:   (bool) - True if the face was scanned
+*/
+static bool scanFace
+(
+    const char          **pp,
+    const char          *end,
+    const int           *counts,
+    int                 **out,
+    const int           *limit
+)
+{
+    const char *p = *pp;
+    int first[3] = { 0, 0, 0 }, prev[3] = { 0, 0, 0 };
+    int corners = 0;
+    while (true) {
+        p = skipBlanks(p, end);
+        if (p == end || *p == '\n' || *p == '#')
+            break;
+
+        // Position, texture coordinate and normal, the last two optional
+        int c[3] = { 0, 0, 0 };
+        if (!scanInt(&p, end, &c[0]))
+            return false;
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/' && !scanInt(&p, end, &c[1]))
+                return false;
+            if (p < end && *p == '/') {
+                ++p;
+                if (!scanInt(&p, end, &c[2]))
+                    return false;
+            }
+        }
+        if (p < end && !isBlank(*p) && *p != '\n' && *p != '#')
+            return false;
+
+        c[0] = resolveIndex(c[0], counts[0]);
+        c[1] = c[1] ? resolveIndex(c[1], counts[1]) : 0;
+        c[2] = c[2] ? resolveIndex(c[2], counts[2]) : 0;
+        if (c[0] < 0 || c[1] < 0 || c[2] < 0)
+            return false;
+
+        if (corners == 0) {
+            memcpy(first, c, sizeof(c));
+        } else if (corners >= 2) {
+            if (out[0] == limit)
+                return false;
+            for (int i = 0; i < 3; ++i) {
+                out[i][0] = first[i];
+                out[i][1] = prev[i];
+                out[i][2] = c[i];
+                out[i] += 3;
+            }
+        }
+        memcpy(prev, c, sizeof(c));
+        corners++;
+    }
+
+    *pp = p;
+    return corners >= 3;
+}
+
+/*
+ countChunk
+
+ Counts every kind of element in a chunk of an OBJ file, with faces counted
+ by the triangles they will be split into.
+
+ Arguments: objChunk *chunk - The chunk to count, whose counts are set
+
+ Returns:   Nothing.
+*/
+static void countChunk
+(
+    objChunk            *chunk
+)
+{
+    memset(chunk->counts, 0, sizeof(chunk->counts));
+    const char *p = chunk->begin;
+    while (p < chunk->end) {
+        const char *eol = nextLine(p, chunk->end);
+        objStatement s = readStatement(&p, eol);
+        if (s == ObjFace)
+            chunk->counts[ObjFace] += countTriangles(p, eol);
+        else
+            chunk->counts[s]++;
+        p = eol;
+    }
+}
+
+/*
+ fillChunk
+
+ Reads every element in a chunk of an OBJ file into a mesh whose arrays
+ already have room for the whole file.  Each element is written at the
+ chunk's offset for its kind plus the number of its kind read before it in
+ the chunk, so chunks can be filled in any order.
+
+ Arguments: objChunk *chunk - The chunk to read, whose status is set
+            objMesh *mesh - The mesh being loaded
+
+ Returns:   Nothing.
+*/
+static void fillChunk
+(
+    objChunk            *chunk,
+    objMesh             *mesh
+)
+{
+    const size_t *off = chunk->offsets;
+    float *pos = mesh->positions.data() + 3 * off[ObjPosition];
+    float *tex = mesh->texCoords.data() + 2 * off[ObjTexCoord];
+    float *norm = mesh->normals.data() + 3 * off[ObjNormal];
+    int *face[3] = {
+        mesh->faceV.data() + 3 * off[ObjFace],
+        mesh->faceT.data() + 3 * off[ObjFace],
+        mesh->faceN.data() + 3 * off[ObjFace]
+    };
+    int *faceEnd = face[0] + 3 * chunk->counts[ObjFace];
+
+    // How many positions, texture coordinates and normals have been read
+    // from the whole file so far
+    int counts[3] = { (int) off[ObjPosition], (int) off[ObjTexCoord],
+        (int) off[ObjNormal] };
+
+    chunk->status = 0;
+    const char *end = chunk->end;
+    for (const char *p = chunk->begin; p < end; p = nextLine(p, end)) {
+        bool ok = true;
+        switch (readStatement(&p, end)) {
+            case ObjPosition:
+                ok = scanFloats(&p, end, 3, pos);
+                pos += 3;
+                counts[0]++;
+                break;
+            case ObjTexCoord:
+                // The second coordinate is optional and a third is ignored
+                ok = scanFloats(&p, end, 1, tex);
+                if (ok && !scanFloats(&p, end, 1, tex + 1))
+                    tex[1] = 0;
+                tex += 2;
+                counts[1]++;
+                break;
+            case ObjNormal:
+                ok = scanFloats(&p, end, 3, norm);
+                norm += 3;
+                counts[2]++;
+                break;
+            case ObjFace:
+                ok = scanFace(&p, end, counts, face, faceEnd);
+                break;
+            default:
+                break;
+        }
+        if (!ok) {
+            chunk->status = 1;
+            return;
+        }
+    }
+
+    // Faces that were not what they were counted as
+    if (face[0] != faceEnd)
+        chunk->status = 1;
+}
+
+/*
+ splitChunks
+
+ Splits a mapped OBJ file into chunks of about equal size, each ending at the
+ end of a line.
+
+ Arguments: const char *data - The first character of the file
+            const char *end - One past the last character in the file
+            int nChunks - How many chunks to split the file into
+            vector<objChunk> *chunks - Filled with the chunks, in order
+
+ Returns:   Nothing.
+*/
+static void splitChunks
+(
+    const char          *data,
+    const char          *end,
+    int                 nChunks,
+    vector<objChunk>    *chunks
+)
+{
+    size_t size = end - data;
+    const char *begin = data;
+    for (int i = 1; i <= nChunks; ++i) {
+        const char *stop = end;
+        if (i < nChunks) {
+            stop = data + size / nChunks * i;
+            stop = stop > begin ? nextLine(stop - 1, end) : begin;
+        }
+
+        objChunk chunk;
+        chunk.begin = begin;
+        chunk.end = stop;
+        chunk.status = 0;
+        chunks->push_back(chunk);
+        begin = stop;
+    }
+}
+
+/*
+ parseObjData
+
+ Reads every element of an OBJ file that has been mapped into memory.  The
+ file is split into one chunk per thread at line boundaries.  Each thread
+ counts the elements of its chunk, the counts are summed into the offset at
+ which each chunk's elements start, the mesh's arrays are sized once for the
+ whole file, and each thread then fills in its own chunk's elements.
+
+ Arguments: const char *data - The first character of the file
+            const char *end - One past the last character in the file
+            int nThreads - Number of threads to parse with, or 0 to use one
+                per core.  Small files are parsed with fewer.
+            objMesh *mesh - Filled with the elements of the file
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+static int parseObjData
+(
+    const char          *data,
+    const char          *end,
+    int                 nThreads,
+    objMesh             *mesh
+)
+{
+    if (nThreads <= 0)
+        nThreads = max((int) thread::hardware_concurrency(), 1);
+    size_t maxChunks = max((size_t) (end - data) / MIN_CHUNK_SIZE, (size_t) 1);
+    nThreads = min((size_t) nThreads, maxChunks);
+
+    vector<objChunk> chunks;
+    splitChunks(data, end, nThreads, &chunks);
+
+    // The calling thread takes the first chunk itself
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; ++t)
+        workers.push_back(thread(countChunk, &chunks[t]));
+    countChunk(&chunks[0]);
+    vector<thread>::iterator w = workers.begin();
+    for (; w != workers.end(); ++w)
+        w->join();
+
+    size_t totals[ObjFace + 1] = { 0 };
+    vector<objChunk>::iterator c = chunks.begin();
+    for (; c != chunks.end(); ++c) {
+        for (int s = 0; s <= ObjFace; ++s) {
+            c->offsets[s] = totals[s];
+            totals[s] += c->counts[s];
+        }
+    }
+
+    mesh->positions.resize(3 * totals[ObjPosition]);
+    mesh->texCoords.resize(2 * totals[ObjTexCoord]);
+    mesh->normals.resize(3 * totals[ObjNormal]);
+    mesh->faceV.resize(3 * totals[ObjFace]);
+    mesh->faceT.resize(3 * totals[ObjFace]);
+    mesh->faceN.resize(3 * totals[ObjFace]);
+
+    workers.clear();
+    for (int t = 1; t < nThreads; ++t)
+        workers.push_back(thread(fillChunk, &chunks[t], mesh));
+    fillChunk(&chunks[0], mesh);
+    for (w = workers.begin(); w != workers.end(); ++w)
+        w->join();
+
+    for (c = chunks.begin(); c != chunks.end(); ++c) {
+        if (c->status)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ loadObjMesh
+
+ Loads every position, texture coordinate, normal and face from an OBJ file
+ into a mesh.
+
+ Arguments: const char *filename - The name of the OBJ file to read
+            objMesh *mesh - Filled with the contents of the file
+            int nThreads - Number of threads to parse with, or 0 (the
+                default) to use one per core
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+int loadObjMesh
+(
+    const char          *filename,
+    objMesh             *mesh,
+    int                 nThreads
+)
+{
+    assert(filename);
+    assert(mesh);
+
+    mesh->clear();
+
+    const char *data;
+    size_t size;
+    if (mapFile(filename, &data, &size)) {
+        cout << "unable to open " << filename << endl;
+        return 1;
+    }
+
+    int status = parseObjData(data, data + size, nThreads, mesh);
+    if (data)
+        munmap((void *) data, size);
+
+    if (status) {
+        cout << "error parsing " << filename << endl;
+        mesh->clear();
+    }
+    return status;
+}
+int loadObjMesh
+(
+    const char          *filename,
+    objMesh             *mesh
+)
+{
+    return loadObjMesh(filename, mesh, 0);
+}
+// Different definitions for string input instead of char*
+int loadObjMesh
+(
+    const string        &filename,
+    objMesh             *mesh,
+    int                 nThreads
+)
+{
+    return loadObjMesh(filename.c_str(), mesh, nThreads);
+}
+int loadObjMesh
+(
+    const string        &filename,
+    objMesh             *mesh
+)
+{
+    return loadObjMesh(filename.c_str(), mesh, 0);
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+
+ objLoader.h
+
+ Contains the objMesh struct and public functions from objLoader.cpp.  The
+ loader is shared by every assignment that reads OBJ files, each of which
+ converts an objMesh to its own structs.
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#ifndef OBJLOADER
+#define OBJLOADER
+
+#include <string>
+#include <vector>
+
+
+// Structs
+/*
+ objMesh
+
+ Everything read from an OBJ file, as flat arrays.  positions and normals
+ hold three floats for every v and vn line, and texCoords two for every vt
+ line, in the order they appear in the file.  Faces are split into
+ triangles, and each triangle corner has a position, texture coordinate and
+ normal index in faceV, faceT and faceN.  Indices are one-indexed, as in the
+ file, with relative (negative) indices already resolved, and are 0 where a
+ corner has no texture coordinate or normal.
+*/
+typedef struct _objMesh {
+    std::vector<float>  positions;
+    std::vector<float>  texCoords;
+    std::vector<float>  normals;
+    std::vector<int>    faceV;
+    std::vector<int>    faceT;
+    std::vector<int>    faceN;
+
+    _objMesh() : positions (), texCoords (), normals (), faceV (), faceT (),
+        faceN () {}
+    ~_objMesh() {}
+
+    int numPositions() const { return positions.size() / 3; }
+    int numTexCoords() const { return texCoords.size() / 2; }
+    int numNormals() const { return normals.size() / 3; }
+    int numTriangles() const { return faceV.size() / 3; }
+
+    void clear() {
+        positions.clear();
+        texCoords.clear();
+        normals.clear();
+        faceV.clear();
+        faceT.clear();
+        faceN.clear();
+    }
+} objMesh;
+
+
+// Externally public functions
+int loadObjMesh (const char*, objMesh*, int);
+int loadObjMesh (const char*, objMesh*);
+int loadObjMesh (const std::string&, objMesh*, int);
+int loadObjMesh (const std::string&, objMesh*);
+
+#endif // ifndef OBJLOADER
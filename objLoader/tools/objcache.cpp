@@ -0,0 +1,78 @@
+/******************************************************************************
+
+ objcache.cpp
+
+ Converts OBJ files to the binary caches the assignments map instead of
+ parsing OBJ files.  Each cache is written next to its OBJ file, so running
+ this ahead of time saves the first run of an assignment from parsing.
+
+ Options:
+    -O          Reorder each mesh's triangles for the vertex cache and
+                overdraw, and its vertices to match, and cache the result
+                apart from the plain cache, where only the assignments that
+                draw welded meshes look for it.  Prints each mesh's ACMR
+                before and after
+
+ Author: Tim Menninger
+
+******************************************************************************/
+#include <iostream>
+#include <cstring>
+
+#include "meshCache.h"
+#include "meshWeld.h"
+#include "meshOptimize.h"
+
+using namespace std;
+
+/*
+ writeOptimizedCache
+
+ Reads an OBJ file, reorders its triangles as optimizeMesh would for the
+ mesh welded from it, and writes the reordered mesh to the file's
+ optimized cache.  The plain cache is left as it is.
+
+ Arguments: const char *filename - The name of the OBJ file
+
+ Returns:   (int) - 0 if successful, nonzero otherwise
+*/
+static int writeOptimizedCache
+(
+    const char          *filename
+)
+{
+    objMesh mesh;
+    if (loadObjMesh(filename, &mesh))
+        return 1;
+
+    weldedMesh welded;
+    weldMesh(&mesh, &welded);
+    meshOptimizeStats stats;
+    vector<int> order;
+    optimizeMesh(&welded, 0, &stats, &order);
+    reorderTriangles(&mesh, order);
+
+    cout << filename << ": ACMR " << stats.acmrBefore << " -> "
+         << stats.acmrAfter << endl;
+    return writeMeshCache(filename, &mesh, MESH_CACHE_OPTIMIZED);
+}
+
+int main(int argc, char **argv) {
+    bool optimize = argc > 1 && strcmp(argv[1], "-O") == 0;
+    int first = optimize ? 2 : 1;
+    if (argc <= first) {
+        cout << "usage: ./objcache [-O] [file.obj] ..." << endl;
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = first; i < argc; ++i) {
+        int failed = optimize ? writeOptimizedCache(argv[i]) :
+            writeMeshCache(argv[i]);
+        if (failed) {
+            cout << "unable to write cache for " << argv[i] << endl;
+            status = 1;
+        }
+    }
+    return status;
+}